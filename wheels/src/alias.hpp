@@ -0,0 +1,77 @@
+/* * *
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Hao Yang (yangh2007@gmail.com)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * */
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+
+#include "tensor_base.hpp"
+
+namespace wheels {
+
+namespace detail {
+// _memory_overlaps: whether [a, a + an) and [b, b + bn) share memory
+template <class AT, class BT>
+bool _memory_overlaps(const AT *a, size_t an, const BT *b, size_t bn) {
+  return an != 0 && bn != 0 &&
+         static_cast<const void *>(a) < static_cast<const void *>(b + bn) &&
+         static_cast<const void *>(b) < static_cast<const void *>(a + an);
+}
+
+// _may_read_from: whether reading from may touch [p, p + n)
+// - a from without continuous data may be any view of that memory
+template <class FromT, class ET>
+bool _may_read_from(yes, const FromT &from, const ET *p, size_t n) {
+  return _memory_overlaps(from.ptr(), numel_of(from), p, n);
+}
+template <class FromT, class ET>
+bool _may_read_from(no, const FromT &, const ET *, size_t) {
+  return true;
+}
+
+// _assign_continuous: reshapes to to shape and lets write(ptr) fill it
+// - when aliased the elements are written to a temporary first, so that
+//   write may keep reading the old elements of to, e.g. in a = a.t()
+template <class ET, class ShapeT, class T, class ResultShapeT, class WriteT>
+void _assign_continuous(tensor_continuous_data_base<ET, ShapeT, T> &to,
+                        const ResultShapeT &shape, bool aliased,
+                        WriteT &&write) {
+  if (aliased) {
+    const size_t n = shape.magnitude();
+    std::unique_ptr<ET[]> result(new ET[n]);
+    write(result.get());
+    if (to.shape() != shape) {
+      reserve_shape(to.derived(), shape);
+    }
+    std::copy_n(result.get(), n, to.ptr());
+    return;
+  }
+  if (to.shape() != shape) {
+    reserve_shape(to.derived(), shape);
+  }
+  write(to.ptr());
+}
+}
+}
@@ -0,0 +1,203 @@
+/* * *
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Hao Yang (yangh2007@gmail.com)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "macros.hpp"
+
+#include "arena_fwd.hpp"
+
+namespace wheels {
+
+namespace detail {
+// _arena_block
+// - a chunk of memory allocations are bumped out of, released when its arena
+//   has moved on and its last allocation is gone
+struct _arena_block {
+  std::atomic<size_t> refs; // live allocations, +1 while its arena bumps it
+  size_t size;
+  size_t used;
+
+  char *data() { return reinterpret_cast<char *>(this + 1); }
+  void release() noexcept {
+    if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      this->~_arena_block();
+      std::free(this);
+    }
+  }
+};
+
+// every allocation is preceded by a header whose last word points to its
+// _arena_block, or is null for heap allocations
+constexpr size_t _allocation_header(size_t align) {
+  return align < sizeof(void *) ? sizeof(void *) : align;
+}
+inline _arena_block *&_block_of(void *p) {
+  return reinterpret_cast<_arena_block **>(p)[-1];
+}
+
+inline void *_heap_allocate(size_t bytes, size_t align) {
+  const size_t header = _allocation_header(align);
+  if (bytes > size_t(-1) - header) {
+    wheels_throw(std::bad_alloc());
+  }
+  void *base = nullptr;
+#if defined(_WIN32)
+  base = _aligned_malloc(bytes + header, align);
+#else
+  if (posix_memalign(&base, align < sizeof(void *) ? sizeof(void *) : align,
+                     bytes + header) != 0) {
+    base = nullptr;
+  }
+#endif
+  if (!base) {
+    wheels_throw(std::bad_alloc());
+  }
+  void *p = static_cast<char *>(base) + header;
+  _block_of(p) = nullptr;
+  return p;
+}
+inline void _heap_deallocate(void *p, size_t align) noexcept {
+  void *base = static_cast<char *>(p) - _allocation_header(align);
+#if defined(_WIN32)
+  _aligned_free(base);
+#else
+  free(base);
+#endif
+}
+
+inline scoped_arena *&_current_arena() {
+  static thread_local scoped_arena *arena = nullptr;
+  return arena;
+}
+}
+
+// scoped_arena
+// - while alive, aligned_allocator on the constructing thread takes memory
+//   from it: allocations are bumped out of blocks of block_bytes() and go back
+//   to the heap a block at a time, so temporaries of a loop body cost no
+//   malloc/free once the arena is warm
+// - arenas nest, the innermost one on a thread is used
+// - memory that outlives the scope stays valid (and may be freed from any
+//   thread), it only keeps its block alive
+// - requests larger than half a block go to the heap
+class scoped_arena {
+public:
+  explicit scoped_arena(size_t block_bytes = size_t(1) << 16)
+      : _block_bytes(block_bytes), _block(nullptr),
+        _previous(detail::_current_arena()) {
+    detail::_current_arena() = this;
+  }
+  ~scoped_arena() {
+    assert(detail::_current_arena() == this &&
+           "scoped_arenas must be destroyed in reverse order");
+    detail::_current_arena() = _previous;
+    if (_block) {
+      _block->release();
+    }
+  }
+  scoped_arena(const scoped_arena &) = delete;
+  scoped_arena &operator=(const scoped_arena &) = delete;
+
+  // the innermost arena alive on this thread, or nullptr
+  static scoped_arena *current() { return detail::_current_arena(); }
+
+  size_t block_bytes() const { return _block_bytes; }
+
+  // allocate: aligned to align (a power of 2), preceded by a block header
+  void *allocate(size_t bytes, size_t align) {
+    const size_t header = detail::_allocation_header(align);
+    if (bytes > _block_bytes / 2 || header > _block_bytes / 2) {
+      return detail::_heap_allocate(bytes, align);
+    }
+    if (_block && _block->refs.load(std::memory_order_acquire) == 1) {
+      _block->used = 0; // everything bumped so far is gone, rewind
+    }
+    void *p = _block ? _bump(bytes, header, align) : nullptr;
+    if (!p) {
+      _renew(header + align);
+      p = _bump(bytes, header, align);
+      assert(p);
+    }
+    _block->refs.fetch_add(1, std::memory_order_relaxed);
+    detail::_block_of(p) = _block;
+    return p;
+  }
+
+private:
+  void *_bump(size_t bytes, size_t header, size_t align) {
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(_block->data());
+    const uintptr_t p =
+        (begin + _block->used + header + align - 1) & ~uintptr_t(align - 1);
+    if (p + bytes > begin + _block->size) {
+      return nullptr;
+    }
+    _block->used = p + bytes - begin;
+    return reinterpret_cast<void *>(p);
+  }
+  void _renew(size_t slack) {
+    const size_t size = _block_bytes + slack;
+    void *mem = std::malloc(sizeof(detail::_arena_block) + size);
+    if (!mem) {
+      wheels_throw(std::bad_alloc());
+    }
+    auto *block = new (mem) detail::_arena_block;
+    block->refs.store(1, std::memory_order_relaxed);
+    block->size = size;
+    block->used = 0;
+    if (_block) {
+      _block->release();
+    }
+    _block = block;
+  }
+
+private:
+  size_t _block_bytes;
+  detail::_arena_block *_block;
+  scoped_arena *_previous;
+};
+
+namespace detail {
+// _allocate_aligned: from the current scoped_arena if any, else the heap
+inline void *_allocate_aligned(size_t bytes, size_t align) {
+  if (scoped_arena *arena = _current_arena()) {
+    return arena->allocate(bytes, align);
+  }
+  return _heap_allocate(bytes, align);
+}
+inline void _deallocate_aligned(void *p, size_t align) noexcept {
+  if (_arena_block *block = _block_of(p)) {
+    block->release();
+  } else {
+    _heap_deallocate(p, align);
+  }
+}
+}
+}
@@ -0,0 +1,36 @@
+#include <benchmark/benchmark.h>
+
+#include "block.hpp"
+#include "iota.hpp"
+#include "tensor.hpp"
+
+using namespace wheels;
+using namespace wheels::tags;
+
+static void image_sides(benchmark::internal::Benchmark *b) {
+  b->RangeMultiplier(4)->Range(4, 8192);
+}
+
+// contiguous sub-rectangle
+static void block_range(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx_<float> a(make_shape(n, n), 1.0f), r(make_shape(n / 2, n / 2));
+  for (auto _ : state) {
+    r = a.block(range(n / 4, n / 4 + n / 2 - 1), range(n / 4, n / 4 + n / 2 - 1));
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * (n / 2) * (n / 2));
+}
+BENCHMARK(block_range)->Apply(image_sides);
+
+// every other row and column
+static void block_strided(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx_<float> a(make_shape(n, n), 1.0f), r(make_shape(n / 2, n / 2));
+  for (auto _ : state) {
+    r = a.block(range(0, 2, n - 1), range(0, 2, n - 1));
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * (n / 2) * (n / 2));
+}
+BENCHMARK(block_strided)->Apply(image_sides);
@@ -24,9 +24,15 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <vector>
+
 #include "block_fwd.hpp"
 #include "ewise_fwd.hpp"
 
+#include "alias.hpp"
+#include "gather.hpp"
 #include "tensor_view_base.hpp"
 
 namespace wheels {
@@ -116,4 +122,238 @@ constexpr auto _at_block(const tensor_base<InET, InShapeT, InT> &, InTT &&in,
       std::forward<InTT>(in), std::forward<SubsTensorTs>(sts)...);
 }
 }
+// assign_elements
+// - blocks of continuous inputs are planned once: every subscript tensor
+//   becomes a table of element offsets into the input, and tables forming an
+//   arithmetic progression (iota, range) are marked as such
+// - rows along the last axis are then copied in bulk when the offsets are
+//   consecutive, with a strided loop when they are a progression, and with
+//   gathers / scatters otherwise
+namespace detail {
+struct _block_axis {
+  std::vector<int64_t> offsets;
+  int64_t step;
+  bool progression;
+};
+template <class SubT>
+_block_axis _make_block_axis(const SubT &sub, int64_t stride) {
+  const size_t n = numel_of(sub);
+  _block_axis a;
+  a.offsets.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    a.offsets[i] = int64_t(element_at_index(sub, i)) * stride;
+  }
+  a.step = n > 1 ? a.offsets[1] - a.offsets[0] : 1;
+  a.progression = true;
+  for (size_t i = 2; i < n && a.progression; i++) {
+    a.progression = a.offsets[i] == a.offsets[0] + int64_t(i) * a.step;
+  }
+  return a;
+}
+
+template <class BlockT, size_t... Is>
+std::array<_block_axis, sizeof...(Is)>
+_make_block_plan(const BlockT &b, const const_ints<size_t, Is...> &) {
+  constexpr size_t rank = sizeof...(Is);
+  const std::array<int64_t, rank> in_shape = {
+      {int64_t(b.input_tensor.shape().at(const_index<Is>()))...}};
+  std::array<int64_t, rank> strides;
+  strides[rank - 1] = 1;
+  for (size_t k = rank - 1; k > 0; k--) {
+    strides[k - 1] = strides[k] * in_shape[k];
+  }
+  return {{_make_block_axis(std::get<Is>(b.subs_tensors), strides[Is])...}};
+}
+
+// calls fun(row, base) for rows [first, last) of the block, a row runs
+// along the last axis and base is the input offset of its subscripts on the
+// other axes
+template <size_t Rank, class FunT>
+void _for_each_block_row(const std::array<_block_axis, Rank> &axes,
+                         size_t first, size_t last, FunT &&fun) {
+  std::array<size_t, Rank> sub;
+  int64_t base = 0;
+  size_t r = first;
+  for (size_t k = Rank - 1; k-- > 0;) {
+    sub[k] = r % axes[k].offsets.size();
+    r /= axes[k].offsets.size();
+    base += axes[k].offsets[sub[k]];
+  }
+  for (size_t row = first; row < last; row++) {
+    fun(row, base);
+    for (size_t k = Rank - 1; k-- > 0;) {
+      base -= axes[k].offsets[sub[k]];
+      if (++sub[k] < axes[k].offsets.size()) {
+        base += axes[k].offsets[sub[k]];
+        break;
+      }
+      sub[k] = 0;
+      base += axes[k].offsets[0];
+    }
+  }
+}
+
+template <class ToET, class FromET>
+void _read_block_row(const _block_axis &inner, const FromET *src, ToET *dst) {
+  const size_t n = inner.offsets.size();
+  if (inner.progression && inner.step == 1) {
+    _copy_converted_n(src + inner.offsets[0], n, dst);
+  } else if (inner.progression) {
+    _gather_strided_n(src + inner.offsets[0], inner.step, n, dst);
+  } else {
+    _gather_n(src, inner.offsets.data(), n, dst);
+  }
+}
+template <class ToET, class FromET>
+void _write_block_row(const _block_axis &inner, const FromET *src, ToET *dst) {
+  const size_t n = inner.offsets.size();
+  if (inner.progression && inner.step == 1) {
+    _copy_converted_n(src, n, dst + inner.offsets[0]);
+  } else if (inner.progression) {
+    _scatter_strided_n(src, n, dst + inner.offsets[0], inner.step);
+  } else {
+    _scatter_n(src, n, dst, inner.offsets.data());
+  }
+}
+
+// runs rows [first, last) through task(first, last), on the default thread
+// pool when there are enough elements
+template <class TaskT>
+void _run_block_rows(size_t rows, size_t n, TaskT &&task) {
+  auto &pool = default_thread_pool();
+  if (n < parallel_threshold() || rows < 2) {
+    task(size_t(0), rows);
+    return;
+  }
+  const size_t chunk_num = std::min(rows, (pool.worker_num() + 1) * 4);
+  const size_t chunk_size = (rows + chunk_num - 1) / chunk_num;
+  pool.run((rows + chunk_size - 1) / chunk_size, [&](size_t c) {
+    task(c * chunk_size, std::min(rows, (c + 1) * chunk_size));
+  });
+}
+
+template <class ToET, class BlockT>
+void _read_block_elements(ToET *dst, const BlockT &from) {
+  constexpr size_t rank = std::decay_t<decltype(from.shape())>::rank;
+  const size_t n = numel_of(from);
+  if (n == 0) {
+    return;
+  }
+  const auto axes =
+      _make_block_plan(from, make_const_sequence(const_size<rank>()));
+  const auto &inner = axes[rank - 1];
+  const size_t cols = inner.offsets.size();
+  const auto *src = from.input_tensor.ptr();
+  _run_block_rows(n / cols, n, [&](size_t first, size_t last) {
+    _for_each_block_row(axes, first, last, [&](size_t row, int64_t base) {
+      _read_block_row(inner, src + base, dst + row * cols);
+    });
+  });
+}
+
+template <class ET, class ShapeT, class T, class BlockT>
+void _assign_block_view(no, tensor_continuous_data_base<ET, ShapeT, T> &to,
+                        const BlockT &from) {
+  assign_elements(static_cast<tensor_core<T> &>(to),
+                  static_cast<const tensor_core<BlockT> &>(from));
+}
+template <class ET, class ShapeT, class T, class BlockT>
+void _assign_block_view(yes, tensor_continuous_data_base<ET, ShapeT, T> &to,
+                        const BlockT &from) {
+  // aliased, e.g. a = a.block(...)
+  const bool aliased =
+      numel_of(from) != 0 &&
+      _may_read_from(yes(), from.input_tensor, to.ptr(), numel_of(to));
+  _assign_continuous(to, from.shape(), aliased,
+                     [&from](ET *dst) { _read_block_elements(dst, from); });
+}
+
+// source of the elements [first, first + n) of from
+template <class FromT, class BufferT>
+const auto *_block_row_source(yes, const FromT &from, size_t first, size_t,
+                              BufferT &) {
+  return from.ptr() + first;
+}
+template <class FromT, class BufferT>
+const auto *_block_row_source(no, const FromT &from, size_t first, size_t n,
+                              BufferT &buffer) {
+  for (size_t j = 0; j < n; j++) {
+    buffer[j] = element_at_index(from, first + j);
+  }
+  return buffer.data();
+}
+
+template <class BlockT, class FromT>
+void _write_block_view(no, no, BlockT &to, const FromT &from) {
+  assign_elements(static_cast<tensor_core<BlockT> &>(to),
+                  static_cast<const tensor_core<FromT> &>(from));
+}
+template <class BlockT, class FromT>
+void _write_block_view(no, yes, BlockT &to, const FromT &from) {
+  _write_block_view(no(), no(), to, from);
+}
+template <class FromContinuous, class BlockT, class FromT>
+void _write_block_view(yes, FromContinuous from_continuous, BlockT &to,
+                       const FromT &from) {
+  constexpr size_t rank = std::decay_t<decltype(to.shape())>::rank;
+  using to_ele_t = std::decay_t<decltype(*to.input_tensor.ptr())>;
+  assert(to.shape() == from.shape());
+  const size_t n = numel_of(from);
+  if (n == 0) {
+    return;
+  }
+  const auto axes =
+      _make_block_plan(to, make_const_sequence(const_size<rank>()));
+  const auto &inner = axes[rank - 1];
+  const size_t cols = inner.offsets.size();
+  auto *dst = to.input_tensor.ptr();
+  // rows may only be written concurrently when they can not overlap each
+  // other or the source
+  bool disjoint_rows = !_may_read_from(from_continuous, from, dst,
+                                      numel_of(to.input_tensor));
+  for (size_t k = 0; k + 1 < rank; k++) {
+    disjoint_rows = disjoint_rows && axes[k].progression &&
+                    (axes[k].step != 0 || axes[k].offsets.size() == 1);
+  }
+  auto task = [&](size_t first, size_t last) {
+    std::vector<to_ele_t> buffer(FromContinuous::value ? 0 : cols);
+    _for_each_block_row(axes, first, last, [&](size_t row, int64_t base) {
+      _write_block_row(inner, _block_row_source(from_continuous, from,
+                                                row * cols, cols, buffer),
+                       dst + base);
+    });
+  };
+  if (disjoint_rows) {
+    _run_block_rows(n / cols, n, task);
+  } else {
+    task(size_t(0), n / cols);
+  }
+}
+}
+template <class ToET, class ToShapeT, class ToT, class ET, class ShapeT,
+          class InputTensorT, class... SubscriptTensorTs>
+void assign_elements(
+    tensor_continuous_data_base<ToET, ToShapeT, ToT> &to,
+    const block_view<ET, ShapeT, InputTensorT, SubscriptTensorTs...> &from) {
+  static_assert(ToShapeT::rank == ShapeT::rank, "shape ranks mismatch!");
+  detail::_assign_block_view(
+      decltype(detail::_is_continuous_data(from.input_tensor))(), to, from);
+}
+template <class ET, class ShapeT, class InputTensorT,
+          class... SubscriptTensorTs, class FromT>
+void assign_elements(
+    block_view<ET, ShapeT, InputTensorT, SubscriptTensorTs...> &to,
+    const tensor_core<FromT> &from) {
+  detail::_write_block_view(
+      decltype(detail::_is_continuous_data(to.input_tensor))(),
+      decltype(detail::_is_continuous_data(from.derived()))(), to,
+      from.derived());
+}
+template <class ET, class ShapeT, class InputTensorT,
+          class... SubscriptTensorTs, class CET, class CShapeT, class CT>
+void assign_elements(
+    block_view<ET, ShapeT, InputTensorT, SubscriptTensorTs...> &to,
+    const cached_result<CET, CShapeT, CT> &from) {
+  assign_elements(to, from.data());
+}
 }
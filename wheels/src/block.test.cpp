@@ -4,6 +4,8 @@
 #include "block.hpp"
 #include "constants.hpp"
 #include "iota.hpp"
+#include "matrix.hpp"
+#include "permute.hpp"
 #include "reshape.hpp"
 #include "tensor.hpp"
 
@@ -43,4 +45,62 @@ TEST(tensor, block) {
   a.block(range(0, 3, last), range(last, -2, 0)) += 5.0;
   ASSERT_TRUE(a.block(range(0, 3, last), range(last, -2, 0)) ==
               matx(make_shape(2, 3), with_elements, 5, 3, 1, 20, 18, 16) + 5.0);
-}
\ No newline at end of file
+}
+TEST(tensor, block_planned) {
+  tensor<int, tensor_shape<size_t, size_t, size_t, size_t>> a(
+      make_shape(6, 7, 9));
+  for (size_t i = 0; i < a.numel(); i++) {
+    a[i] = int(i);
+  }
+  // unit stride rows, strided rows, gathered rows
+  vecx_<int> perm({4, 0, 8, 8, 3});
+  auto b1 = a.block(range(1, 4), range(0, 2, last), range(2, 7));
+  auto b2 = a.block(range(last, -1, 0), 3, range(0, 3, last));
+  auto b3 = a.block(vecx_<int>({5, 0, 2}), range(1, 3), perm);
+  tensor<double, tensor_shape<size_t, size_t, size_t, size_t>> r1(b1);
+  ASSERT_TRUE(r1 == b1);
+  ASSERT_EQ(r1(1, 1, 0), double(a(2, 2, 2)));
+  tensor<int, tensor_shape<size_t, size_t, size_t, size_t>> r2(b2), r3(b3),
+      z(b1);
+  ASSERT_TRUE(r2 == b2);
+  ASSERT_TRUE(r3 == b3);
+  ASSERT_EQ(r3(0, 1, 0), a(5, 2, 4));
+
+  // writes
+  auto c = a.eval();
+  c.block(range(1, 4), range(0, 2, last), range(2, 7)) = z.ewised() * 0;
+  c.block(vecx_<int>({5, 0, 2}), range(1, 3), perm) = r3.ewised() + 1;
+  for (size_t i = 0; i < 6; i++) {
+    for (size_t j = 0; j < 7; j++) {
+      for (size_t k = 0; k < 9; k++) {
+        const bool in1 = i >= 1 && i <= 4 && j % 2 == 0 && k >= 2 && k <= 7;
+        const bool in3 = (i == 5 || i == 0 || i == 2) && j >= 1 && j <= 3 &&
+                         (k == 4 || k == 0 || k == 8 || k == 3);
+        ASSERT_EQ(c(i, j, k), in3 ? a(i, j, k) + 1 : in1 ? 0 : a(i, j, k));
+      }
+    }
+  }
+
+  // a view of the written tensor on the right is written row by row
+  matx m(make_shape(300, 300));
+  for (size_t i = 0; i < m.numel(); i++) {
+    m[i] = double(i);
+  }
+  matx expected = m;
+  std::vector<double> row(300);
+  for (size_t i = 0; i < 300; i++) {
+    for (size_t j = 0; j < 300; j++) {
+      row[j] = expected(j, i);
+    }
+    for (size_t j = 0; j < 300; j++) {
+      expected(i, j) = row[j];
+    }
+  }
+  m.block(range(0, last), range(0, last)) = m.t();
+  ASSERT_TRUE(m == expected);
+
+  // aliased
+  a = a.block(range(0, 2, last), range(0, 3), range(last, -1, 0));
+  ASSERT_TRUE(a.shape() == make_shape(3, 4, 9));
+  ASSERT_EQ(a(1, 2, 0), int((2 * 7 + 2) * 9 + 8));
+}
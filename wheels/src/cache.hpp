@@ -0,0 +1,116 @@
+/* * *
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Hao Yang (yangh2007@gmail.com)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+#include "tensor.hpp"
+#include "tensor_base.hpp"
+
+#include "cache_fwd.hpp"
+
+namespace wheels {
+
+// cached_result
+// - the input is evaluated into a buffer on first access, copies of the node
+//   share the same buffer
+template <class ET, class ShapeT, class T>
+class cached_result
+    : public tensor_base<ET, ShapeT, cached_result<ET, ShapeT, T>> {
+  struct _cache_t {
+    std::once_flag evaluated;
+    tensor<ET, ShapeT> data;
+  };
+
+public:
+  using value_type = ET;
+  using shape_type = ShapeT;
+  constexpr explicit cached_result(T &&in)
+      : _input(std::forward<T>(in)), _cache(std::make_shared<_cache_t>()) {}
+  constexpr decltype(auto) shape() const { return shape_of(_input); }
+  constexpr const T &input() const & { return _input; }
+  T &&input() && { return static_cast<T &&>(_input); }
+
+  const tensor<ET, ShapeT> &data() const {
+    std::call_once(_cache->evaluated, [this]() { _cache->data = _input; });
+    return _cache->data;
+  }
+
+private:
+  T _input;
+  std::shared_ptr<_cache_t> _cache;
+};
+
+// shape_of
+template <class ET, class ShapeT, class T>
+constexpr decltype(auto) shape_of(const cached_result<ET, ShapeT, T> &t) {
+  return t.shape();
+}
+
+// element_at
+template <class ET, class ShapeT, class T, class... SubTs>
+constexpr decltype(auto) element_at(const cached_result<ET, ShapeT, T> &t,
+                                    const SubTs &... subs) {
+  return element_at(t.data(), subs...);
+}
+
+// element_at_index
+template <class ET, class ShapeT, class T, class IndexT>
+constexpr decltype(auto) element_at_index(const cached_result<ET, ShapeT, T> &t,
+                                          const IndexT &ind) {
+  return element_at_index(t.data(), ind);
+}
+
+// assign_elements
+template <class ToT, class ET, class ShapeT, class T>
+void assign_elements(tensor_core<ToT> &to,
+                     const cached_result<ET, ShapeT, T> &from) {
+  assign_elements(to, static_cast<const tensor_core<tensor<ET, ShapeT>> &>(
+                          from.data()));
+}
+
+// cached
+namespace detail {
+template <class ET, class ShapeT, class T, class TT>
+constexpr auto _cached(const tensor_base<ET, ShapeT, T> &, TT &&t) {
+  return cached_result<ET, ShapeT, TT>(std::forward<TT>(t));
+}
+}
+
+// materialize
+// - tensors with continuous data are passed through, others are evaluated
+namespace detail {
+template <class ET, class ShapeT, class T, class TT>
+constexpr auto _materialize(const tensor_base<ET, ShapeT, T> &, TT &&t) {
+  return tensor<ET, ShapeT>(std::forward<TT>(t));
+}
+template <class ET, class ShapeT, class T, class TT>
+constexpr TT _materialize(const tensor_continuous_data_base<ET, ShapeT, T> &,
+                          TT &&t) {
+  return std::forward<TT>(t);
+}
+}
+}
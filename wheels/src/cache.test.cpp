@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "cache.hpp"
+#include "ewise.hpp"
+#include "matrix.hpp"
+#include "tensor.hpp"
+
+using namespace wheels;
+
+TEST(tensor, cached) {
+  vecx a = {1.0, 2.0, 3.0, 4.0, 5.0};
+  int calls = 0;
+  auto sq = a.ewised().transform([&calls](double e) {
+    calls++;
+    return e * e;
+  });
+  auto c = sq.cached();
+  ASSERT_EQ(calls, 0);
+  for (int k = 0; k < 3; k++) {
+    for (size_t i = 0; i < a.numel(); i++) {
+      ASSERT_EQ(c(i), a(i) * a(i));
+    }
+  }
+  ASSERT_EQ(calls, 5);
+
+  auto c2 = c;
+  vecx d = c2 + c;
+  ASSERT_EQ(calls, 5);
+  ASSERT_TRUE(d == (a.ewised() * a * 2.0).eval());
+
+  vecx e = materialize(c);
+  ASSERT_TRUE(e == c.data());
+  ASSERT_EQ(&materialize(a), &a);
+}
+
+TEST(matrix, cache_super_linear) {
+  std::default_random_engine rng;
+  auto a = rand(make_shape(40, 30), rng);
+  auto b = rand(make_shape(30, 50), rng);
+  auto c = rand(make_shape(50, 20), rng);
+  matx ab = a * b;
+
+  // products inside ewise expressions
+  matx s = (a * b).ewised() * 2.0 + ab;
+  ASSERT_LE((s - ab * 3.0).norm(), 1e-9);
+  matx t = (a * b).ewised() - (a * b);
+  ASSERT_LE(t.norm(), 1e-9);
+
+  // products of products
+  matx abc = (a * b) * c;
+  matx expected = ab * c;
+  ASSERT_LE((abc - expected).norm(), 1e-9);
+  matx abc2 = a * (b * c);
+  ASSERT_LE((abc2 - expected).norm(), 1e-9);
+}
@@ -0,0 +1,77 @@
+/* * *
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Hao Yang (yangh2007@gmail.com)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * */
+
+#pragma once
+
+#include "const_ints.hpp"
+
+#include "tensor_base_fwd.hpp"
+
+namespace wheels {
+
+// cached_result
+template <class ET, class ShapeT, class T> class cached_result;
+
+// cached
+namespace detail {
+template <class ET, class ShapeT, class T, class TT>
+constexpr auto _cached(const tensor_base<ET, ShapeT, T> &, TT &&t);
+}
+template <class T>
+constexpr auto cached(T &&t)
+    -> decltype(detail::_cached(t, std::forward<T>(t))) {
+  return detail::_cached(t, std::forward<T>(t));
+}
+
+// materialize
+namespace detail {
+template <class ET, class ShapeT, class T, class TT>
+constexpr auto _materialize(const tensor_base<ET, ShapeT, T> &, TT &&t);
+template <class ET, class ShapeT, class T, class TT>
+constexpr TT _materialize(const tensor_continuous_data_base<ET, ShapeT, T> &,
+                          TT &&t);
+}
+template <class T>
+constexpr auto materialize(T &&t)
+    -> decltype(detail::_materialize(t, std::forward<T>(t))) {
+  return detail::_materialize(t, std::forward<T>(t));
+}
+
+// super linear nodes
+// - nodes whose elements cost more than O(1) each declare themselves by
+//   overloading _is_super_linear and _cache_super_linear, expressions that
+//   visit every element of such a node once (e.g. ewise ops) evaluate it into
+//   a temporary before the element loop
+namespace detail {
+struct _cache_tag {};
+template <class T>
+constexpr no _is_super_linear(_cache_tag, const tensor_core<T> &) {
+  return no();
+}
+template <class T>
+constexpr const T &_cache_super_linear(_cache_tag, const tensor_core<T> &t) {
+  return t.derived();
+}
+}
+}
@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+
+#include "cat.hpp"
+#include "tensor.hpp"
+
+using namespace wheels;
+
+static void image_sides(benchmark::internal::Benchmark *b) {
+  b->RangeMultiplier(4)->Range(4, 8192);
+}
+
+// cat_at
+static void cat_at_rows(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx_<float> a(make_shape(n / 2, n), 1.0f), b(make_shape(n - n / 2, n), 2.0f),
+      r(make_shape(n, n));
+  for (auto _ : state) {
+    r = cat_at(const_index<0>(), a, b);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * n * n * sizeof(float) * 2);
+}
+BENCHMARK(cat_at_rows)->Apply(image_sides);
+
+static void cat_at_cols(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx_<float> a(make_shape(n, n / 2), 1.0f), b(make_shape(n, n - n / 2), 2.0f),
+      r(make_shape(n, n));
+  for (auto _ : state) {
+    r = cat_at(const_index<1>(), a, b);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * n * n * sizeof(float) * 2);
+}
+BENCHMARK(cat_at_cols)->Apply(image_sides);
+
+static void cat_at_rows_nary(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx_<float> a(make_shape(n / 4, n), 1.0f),
+      b(make_shape(n - n / 4 * 3, n), 2.0f), r(make_shape(n, n));
+  for (auto _ : state) {
+    r = cat_at(const_index<0>(), a, a, a, b);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * n * n * sizeof(float) * 2);
+}
+BENCHMARK(cat_at_rows_nary)->Apply(image_sides);
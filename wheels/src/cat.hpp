@@ -24,6 +24,11 @@
 
 #pragma once
 
+#include <algorithm>
+#include <tuple>
+
+#include "alias.hpp"
+#include "gather.hpp"
 #include "tensor_base.hpp"
 
 #include "cat_fwd.hpp"
@@ -45,29 +50,55 @@ constexpr auto _make_cat_shape_seq(const ShapeT1 &s1, const ShapeT2 &s2,
                   s1.at(const_index<Is>()) + s2.at(const_index<Is>()),
                   s1.at(const_index<Is>()))...);
 }
+
+// _make_cat_shape
+template <size_t Axis, class ShapeT>
+constexpr auto _make_cat_shape(const const_index<Axis> &, const ShapeT &s) {
+  return s;
+}
+template <size_t Axis, class ShapeT1, class ShapeT2, class... ShapeTs>
+constexpr auto _make_cat_shape(const const_index<Axis> &axis,
+                               const ShapeT1 &s1, const ShapeT2 &s2,
+                               const ShapeTs &... ss) {
+  return _make_cat_shape(
+      axis, _make_cat_shape_seq(s1, s2, axis, make_rank_sequence(s1)), ss...);
+}
+template <size_t Axis, class TupleT, size_t... Is>
+constexpr auto _make_cat_shape_tuple(const const_index<Axis> &axis,
+                                     const TupleT &ins,
+                                     const const_ints<size_t, Is...> &) {
+  return _make_cat_shape(axis, std::get<Is>(ins).shape()...);
+}
 }
 
 // cat_result
-template <class ET, class ShapeT, size_t Axis, class T1, class T2>
+// - concatenates two or more tensors along Axis
+template <class ET, class ShapeT, size_t Axis, class... Ts>
 class cat_result
-    : public tensor_base<ET, ShapeT, cat_result<ET, ShapeT, Axis, T1, T2>> {
+    : public tensor_base<ET, ShapeT, cat_result<ET, ShapeT, Axis, Ts...>> {
+  static_assert(sizeof...(Ts) >= 2, "cat_result needs at least 2 inputs");
+
 public:
   using value_type = ET;
   using shape_type = ShapeT;
+  static constexpr size_t input_num = sizeof...(Ts);
 
-  constexpr cat_result(T1 &&in1, T2 &&in2)
-      : _input1(std::forward<T1>(in1)), _input2(std::forward<T2>(in2)),
-        _shape(detail::_make_cat_shape_seq(
-            _input1.shape(), _input2.shape(), const_index<Axis>(),
-            make_rank_sequence(_input1.shape()))) {}
+  constexpr cat_result(Ts &&... ins)
+      : _inputs(std::forward<Ts>(ins)...),
+        _shape(detail::_make_cat_shape_tuple(
+            const_index<Axis>(), _inputs,
+            make_const_sequence(const_size<sizeof...(Ts)>()))) {}
 
-  constexpr const T1 &input1() const { return _input1; }
-  constexpr const T2 &input2() const { return _input2; }
+  template <size_t I>
+  constexpr decltype(auto) input(const const_index<I> &) const {
+    return std::get<I>(_inputs);
+  }
+  constexpr decltype(auto) input1() const { return std::get<0>(_inputs); }
+  constexpr decltype(auto) input2() const { return std::get<1>(_inputs); }
   constexpr const ShapeT &shape() const { return _shape; }
 
 private:
-  T1 _input1;
-  T2 _input2;
+  std::tuple<Ts...> _inputs;
   ShapeT _shape;
 };
 
@@ -86,76 +117,238 @@ constexpr auto _cat_tensor_at(const const_index<Axis> &axis,
   return cat_result<ele_t, shape_t, Axis, TT1, TT2>(std::forward<TT1>(in1),
                                                     std::forward<TT2>(in2));
 }
+template <size_t Axis, class... TTs>
+constexpr auto _cat_tensors_at(const const_index<Axis> &axis, TTs &&... ins) {
+  using shape_t = decltype(_make_cat_shape(axis, ins.shape()...));
+  using ele_t =
+      std::common_type_t<typename std::decay_t<TTs>::value_type...>;
+  return cat_result<ele_t, shape_t, Axis, TTs...>(std::forward<TTs>(ins)...);
+}
 }
 
 // shape_of
-template <class ET, class ShapeT, size_t Axis, class T1, class T2>
+template <class ET, class ShapeT, size_t Axis, class... Ts>
 constexpr decltype(auto)
-shape_of(const cat_result<ET, ShapeT, Axis, T1, T2> &m) {
+shape_of(const cat_result<ET, ShapeT, Axis, Ts...> &m) {
   return m.shape();
 }
 
 // element_at
 namespace detail {
-template <class ET, class ShapeT, size_t Axis, class T1, class T2,
-          class SubsTupleT, size_t... Is>
-inline ET
-_element_at_cat_result_seq(const cat_result<ET, ShapeT, Axis, T1, T2> &m,
-                           SubsTupleT &&subs,
-                           const const_ints<size_t, Is...> &) {
-  if (std::get<Axis>(subs) < m.input1().shape().at(const_index<Axis>())) {
-    return (ET)element_at(m.input1(), std::get<Is>(subs)...);
-  }
-  else {
-    return (ET)element_at(
-        m.input2(), conditional(const_bool<Axis == Is>(),
-                                std::get<Axis>(subs) -
-                                    m.input1().shape().at(const_index<Axis>()),
-                                std::get<Is>(subs))...);
+template <class ET, size_t Axis, class T, class SubsTupleT, size_t... Is>
+inline ET _element_at_cat_input(const T &in, size_t offset,
+                                const SubsTupleT &subs,
+                                const const_ints<size_t, Is...> &) {
+  return (ET)element_at(in, conditional(const_bool<Axis == Is>(),
+                                        std::get<Axis>(subs) - offset,
+                                        std::get<Is>(subs))...);
+}
+// offset is where input I starts along Axis
+template <class ET, class ShapeT, size_t Axis, class... Ts, size_t I,
+          class SubsTupleT, class SeqT>
+inline ET _element_at_cat_result_seq(
+    const cat_result<ET, ShapeT, Axis, Ts...> &m, const const_index<I> &i,
+    yes, size_t offset, const SubsTupleT &subs, const SeqT &seq) {
+  return _element_at_cat_input<ET, Axis>(m.input(i), offset, subs, seq);
+}
+template <class ET, class ShapeT, size_t Axis, class... Ts, size_t I,
+          class SubsTupleT, class SeqT>
+inline ET _element_at_cat_result_seq(
+    const cat_result<ET, ShapeT, Axis, Ts...> &m, const const_index<I> &i,
+    no, size_t offset, const SubsTupleT &subs, const SeqT &seq) {
+  const size_t end = offset + m.input(i).shape().at(const_index<Axis>());
+  if (size_t(std::get<Axis>(subs)) < end) {
+    return _element_at_cat_input<ET, Axis>(m.input(i), offset, subs, seq);
   }
+  return _element_at_cat_result_seq(m, const_index<I + 1>(),
+                                    const_bool<I + 2 == sizeof...(Ts)>(), end,
+                                    subs, seq);
 }
 }
-template <class ET, class ShapeT, size_t Axis, class T1, class T2,
-          class... SubTs>
-constexpr ET element_at(const cat_result<ET, ShapeT, Axis, T1, T2> &m,
+template <class ET, class ShapeT, size_t Axis, class... Ts, class... SubTs>
+constexpr ET element_at(const cat_result<ET, ShapeT, Axis, Ts...> &m,
                         const SubTs &... subs) {
   assert(subscripts_are_valid(m.shape(), subs...));
   return detail::_element_at_cat_result_seq(
-      m, std::forward_as_tuple(subs...),
-      make_rank_sequence(m.input2().shape()));
+      m, const_index<0>(), no(), 0, std::forward_as_tuple(subs...),
+      make_rank_sequence(m.shape()));
+}
+
+namespace detail {
+// calls fun on the inputs in order while it returns true
+template <class CatT, class FunT>
+constexpr bool _all_cat_inputs(const CatT &, FunT &,
+                               const const_ints<size_t> &) {
+  return true;
+}
+template <class CatT, class FunT, size_t I, size_t... Is>
+bool _all_cat_inputs(const CatT &t, FunT &fun,
+                     const const_ints<size_t, I, Is...> &) {
+  return fun(t.input(const_index<I>())) &&
+         _all_cat_inputs(t, fun, const_ints<size_t, Is...>());
+}
+template <class ET, class ShapeT, size_t Axis, class... Ts, class FunT>
+bool _all_cat_inputs(const cat_result<ET, ShapeT, Axis, Ts...> &t, FunT fun) {
+  return _all_cat_inputs(t, fun,
+                         make_const_sequence(const_size<sizeof...(Ts)>()));
+}
 }
 
 // unordered
-template <class FunT, class ET, class ShapeT, size_t Axis, class T1, class T2>
+template <class FunT, class ET, class ShapeT, size_t Axis, class... Ts>
 bool for_each_element(behavior_flag<unordered> o, FunT fun,
-                      const cat_result<ET, ShapeT, Axis, T1, T2> &t) {
-  for_each_element(o, fun, t.input1());
-  for_each_element(o, fun, t.input2());
+                      const cat_result<ET, ShapeT, Axis, Ts...> &t) {
+  detail::_all_cat_inputs(t, [o, &fun](const auto &in) {
+    for_each_element(o, fun, in);
+    return true;
+  });
   return true;
 }
 
 // break_on_false
-template <class FunT, class ET, class ShapeT, size_t Axis, class T1, class T2>
+template <class FunT, class ET, class ShapeT, size_t Axis, class... Ts>
 bool for_each_element(behavior_flag<break_on_false> o, FunT fun,
-                      const cat_result<ET, ShapeT, Axis, T1, T2> &t) {
-  return for_each_element(o, fun, t.input1()) &&
-         for_each_element(o, fun, t.input2());
+                      const cat_result<ET, ShapeT, Axis, Ts...> &t) {
+  return detail::_all_cat_inputs(
+      t, [o, &fun](const auto &in) { return for_each_element(o, fun, in); });
 }
 
 // nonzero_only
-template <class FunT, class ET, class ShapeT, size_t Axis, class T1, class T2>
+template <class FunT, class ET, class ShapeT, size_t Axis, class... Ts>
 bool for_each_element(behavior_flag<nonzero_only> o, FunT fun,
-                      const cat_result<ET, ShapeT, Axis, T1, T2> &t) {
-  bool r1 = for_each_element(o, fun, t.input1());
-  bool r2 = for_each_element(o, fun, t.input2());
-  return r1 && r2;
+                      const cat_result<ET, ShapeT, Axis, Ts...> &t) {
+  bool r = true;
+  detail::_all_cat_inputs(t, [o, &fun, &r](const auto &in) {
+    r = for_each_element(o, fun, in) && r;
+    return true;
+  });
+  return r;
 }
 
 // size_t nonzero_elements_count(t)
-template <class ET, class ShapeT, size_t Axis, class T1, class T2>
+template <class ET, class ShapeT, size_t Axis, class... Ts>
 inline size_t
-nonzero_elements_count(const cat_result<ET, ShapeT, Axis, T1, T2> &t) {
-  return nonzero_elements_count(t.input1()) +
-         nonzero_elements_count(t.input2());
+nonzero_elements_count(const cat_result<ET, ShapeT, Axis, Ts...> &t) {
+  size_t n = 0;
+  detail::_all_cat_inputs(t, [&n](const auto &in) {
+    n += nonzero_elements_count(in);
+    return true;
+  });
+  return n;
+}
+
+// assign_elements
+// - every input is copied as one slab per subscript before Axis: continuous
+//   inputs by bulk copies, others through element_at_index, nested cats along
+//   the same Axis are flattened into their inputs
+namespace detail {
+template <size_t Axis, class T, class FunT>
+void _for_each_cat_leaf(const const_index<Axis> &, const tensor_core<T> &in,
+                        size_t offset, FunT &fun) {
+  fun(in.derived(), offset);
+}
+template <size_t Axis, class ET, class ShapeT, class... Ts, class FunT>
+void _for_each_cat_leaf(const const_index<Axis> &axis,
+                        const cat_result<ET, ShapeT, Axis, Ts...> &in,
+                        size_t offset, FunT &fun) {
+  _all_cat_inputs(in, [&axis, &offset, &fun](const auto &input) {
+    _for_each_cat_leaf(axis, input, offset, fun);
+    offset += input.shape().at(const_index<Axis>());
+    return true;
+  });
+}
+
+// copies elements [first, last) of a leaf holding slab elements per outer
+// subscript, whose slabs start at dst + o * row
+template <class ToET, class T>
+void _cat_copy_leaf(yes, ToET *dst, const T &in, size_t first, size_t last,
+                    size_t slab, size_t row) {
+  const auto *src = in.ptr();
+  for (size_t i = first; i < last;) {
+    const size_t j = i % slab;
+    const size_t len = std::min(slab - j, last - i);
+    _copy_converted_n(src + i, len, dst + i / slab * row + j);
+    i += len;
+  }
+}
+template <class ToET, class T>
+void _cat_copy_leaf(no, ToET *dst, const T &in, size_t first, size_t last,
+                    size_t slab, size_t row) {
+  for (size_t i = first; i < last;) {
+    const size_t j = i % slab;
+    const size_t len = std::min(slab - j, last - i);
+    ToET *d = dst + i / slab * row + j;
+    for (size_t k = 0; k < len; k++) {
+      d[k] = static_cast<ToET>(element_at_index(in, i + k));
+    }
+    i += len;
+  }
+}
+
+template <class ShapeT, size_t Axis, size_t... Is>
+size_t _cat_inner_size(const ShapeT &shape, const const_index<Axis> &,
+                       const const_ints<size_t, Is...> &) {
+  size_t inner = 1;
+  const size_t sizes[] = {1, (Is > Axis ? size_t(shape.at(const_index<Is>()))
+                                        : size_t(1))...};
+  for (size_t s : sizes) {
+    inner *= s;
+  }
+  return inner;
+}
+
+template <class ToET, class ET, class ShapeT, size_t Axis, class... Ts>
+void _assign_cat_elements(ToET *dst,
+                          const cat_result<ET, ShapeT, Axis, Ts...> &from) {
+  const size_t n = numel_of(from);
+  if (n == 0) {
+    return;
+  }
+  const size_t inner = _cat_inner_size(from.shape(), const_index<Axis>(),
+                                       make_rank_sequence(from.shape()));
+  const size_t row = size_t(from.shape().at(const_index<Axis>())) * inner;
+  auto &pool = default_thread_pool();
+  const size_t chunk_num =
+      n < parallel_threshold() ? 1 : (pool.worker_num() + 1) * 4;
+  auto chunk = [&](size_t c) {
+    auto leaf = [&](const auto &in, size_t offset) {
+      const size_t len = numel_of(in);
+      _cat_copy_leaf(decltype(_is_continuous_data(in))(), dst + offset * inner,
+                     in, len * c / chunk_num, len * (c + 1) / chunk_num,
+                     size_t(in.shape().at(const_index<Axis>())) * inner, row);
+    };
+    _for_each_cat_leaf(const_index<Axis>(), from, 0, leaf);
+  };
+  if (chunk_num == 1) {
+    chunk(0);
+  } else {
+    pool.run(chunk_num, chunk);
+  }
+}
+
+// whether any leaf may read [p, p + n)
+template <size_t Axis, class CatT, class ET>
+bool _cat_reads_from(const CatT &from, const ET *p, size_t n) {
+  bool aliased = false;
+  auto leaf = [&](const auto &in, size_t) {
+    aliased = aliased ||
+              _may_read_from(decltype(_is_continuous_data(in))(), in, p, n);
+  };
+  _for_each_cat_leaf(const_index<Axis>(), from, 0, leaf);
+  return aliased;
+}
+}
+template <class ToET, class ToShapeT, class ToT, class ET, class ShapeT,
+          size_t Axis, class... Ts>
+void assign_elements(tensor_continuous_data_base<ToET, ToShapeT, ToT> &to,
+                     const cat_result<ET, ShapeT, Axis, Ts...> &from) {
+  static_assert(ToShapeT::rank == ShapeT::rank, "shape ranks mismatch!");
+  const ToET *old = to.ptr();
+  // aliased, e.g. a = cat_at(const_index<0>(), a, b)
+  const bool aliased = old != nullptr && detail::_cat_reads_from<Axis>(
+                                             from, old, numel_of(to));
+  detail::_assign_continuous(to, from.shape(), aliased, [&from](ToET *dst) {
+    detail::_assign_cat_elements(dst, from);
+  });
 }
 }
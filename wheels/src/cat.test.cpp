@@ -2,6 +2,8 @@
 
 #include "cat.hpp"
 #include "ewise.hpp"
+#include "matrix.hpp"
+#include "permute.hpp"
 #include "tensor_map.hpp"
 #include "shape.hpp"
 #include "tensor.hpp"
@@ -28,4 +30,60 @@ TEST(tensor, cat) {
   for_each_element(behavior_flag<unordered>(), [](bool b) { ASSERT_TRUE(b); },
                    cat(vec3(1, 2, 3), vec2(4, 5), vecx({6})).ewised() ==
                        vecx({1, 2, 3, 4, 5, 6}));
-}
\ No newline at end of file
+}
+TEST(tensor, cat_bulk) {
+  matx_<int> a(make_shape(3, 4)), b(make_shape(2, 4)), c(make_shape(3, 2));
+  for (size_t i = 0; i < a.numel(); i++) {
+    a[i] = int(i);
+  }
+  for (size_t i = 0; i < b.numel(); i++) {
+    b[i] = 100 + int(i);
+  }
+  for (size_t i = 0; i < c.numel(); i++) {
+    c[i] = 200 + int(i);
+  }
+
+  // rows, columns and nested cats
+  matx_<int> r = cat_at(const_index<0>(), a, b);
+  ASSERT_TRUE(r == cat_at(const_index<0>(), a, b));
+  ASSERT_EQ(r(4, 3), 107);
+  r = cat_at(const_index<1>(), a, c);
+  ASSERT_TRUE(r == cat_at(const_index<1>(), a, c));
+  ASSERT_EQ(r(2, 5), 205);
+  r = cat_at(const_index<1>(), cat_at(const_index<1>(), c, a), c);
+  ASSERT_EQ(r.shape(), make_shape(3, 8));
+  ASSERT_EQ(r(1, 2), 4);
+  ASSERT_EQ(r(1, 7), 203);
+
+  // n-ary, with a non-continuous input and a converted element type
+  auto e = cat_at(const_index<0>(), a, b, a.ewised() * 2, b);
+  ASSERT_EQ(e.shape(), make_shape(10, 4));
+  matx_<double> rd(e);
+  ASSERT_TRUE(rd == e);
+  ASSERT_EQ(rd(6, 1), 10.0);
+  ASSERT_TRUE(cat_at(const_index<0>(), a, b, a) ==
+              cat_at(const_index<0>(), cat_at(const_index<0>(), a, b), a));
+
+  // aliased
+  a = cat_at(const_index<1>(), a, a);
+  ASSERT_EQ(a.shape(), make_shape(3, 8));
+  ASSERT_EQ(a(2, 7), 11);
+  // aliased through a view
+  matx_<int> sq(make_shape(3, 3));
+  for (size_t i = 0; i < sq.numel(); i++) {
+    sq[i] = int(i);
+  }
+  matx_<int> sqt = sq.t();
+  sq = cat_at(const_index<1>(), sq.t(), sqt);
+  ASSERT_EQ(sq.shape(), make_shape(3, 6));
+  ASSERT_EQ(sq(0, 1), 3);
+  ASSERT_EQ(sq(2, 4), 5);
+
+  // large enough to run on the pool
+  vecx_<float> big1(make_shape(300000), 1.0f), big2(make_shape(500000), 2.0f);
+  vecx_<float> big = cat_at(const_index<0>(), big1, big2, big1);
+  ASSERT_EQ(big.numel(), 1100000);
+  ASSERT_EQ(big[299999], 1.0f);
+  ASSERT_EQ(big[300000], 2.0f);
+  ASSERT_EQ(big[800000], 1.0f);
+}
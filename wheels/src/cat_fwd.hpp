@@ -31,8 +31,7 @@
 namespace wheels {
 
 // cat_result
-template <class ET, class ShapeT, size_t Axis, class T1, class T2>
-class cat_result;
+template <class ET, class ShapeT, size_t Axis, class... Ts> class cat_result;
 
 namespace detail {
 template <size_t Axis, class ShapeT1, class ET1, class T1, class ShapeT2,
@@ -51,6 +50,23 @@ constexpr auto cat_at(const const_index<Axis> &axis, T1 &&in1, T2 &&in2)
                                  std::forward<T2>(in2));
 }
 
+// cat_at(axis, t1, t2, t3, ...)
+namespace detail {
+template <size_t Axis, class... TTs>
+constexpr auto _cat_tensors_at(const const_index<Axis> &axis, TTs &&... ins);
+}
+template <size_t Axis, class T1, class T2, class T3, class... Ts>
+constexpr auto cat_at(const const_index<Axis> &axis, T1 &&in1, T2 &&in2,
+                      T3 &&in3, Ts &&... ins)
+    -> decltype(detail::_cat_tensors_at(axis, std::forward<T1>(in1),
+                                         std::forward<T2>(in2),
+                                         std::forward<T3>(in3),
+                                         std::forward<Ts>(ins)...)) {
+  return detail::_cat_tensors_at(axis, std::forward<T1>(in1),
+                                  std::forward<T2>(in2), std::forward<T3>(in3),
+                                  std::forward<Ts>(ins)...);
+}
+
 // cat2 (cat_at 0)
 template <class T1, class T2>
 constexpr auto cat2(T1 &&in1, T2 &&in2)
@@ -59,27 +75,26 @@ constexpr auto cat2(T1 &&in1, T2 &&in2)
   return cat_at(const_index<0>(), std::forward<T1>(in1), std::forward<T2>(in2));
 }
 
-template <class ET, class ShapeT, size_t Axis, class T1, class T2,
-          class... SubTs>
-constexpr ET element_at(const cat_result<ET, ShapeT, Axis, T1, T2> &m,
+template <class ET, class ShapeT, size_t Axis, class... Ts, class... SubTs>
+constexpr ET element_at(const cat_result<ET, ShapeT, Axis, Ts...> &m,
                         const SubTs &... subs);
 
 // unordered
-template <class FunT, class ET, class ShapeT, size_t Axis, class T1, class T2>
+template <class FunT, class ET, class ShapeT, size_t Axis, class... Ts>
 bool for_each_element(behavior_flag<unordered> o, FunT fun,
-                      const cat_result<ET, ShapeT, Axis, T1, T2> &t);
+                      const cat_result<ET, ShapeT, Axis, Ts...> &t);
 
 // break_on_false
-template <class FunT, class ET, class ShapeT, size_t Axis, class T1, class T2>
+template <class FunT, class ET, class ShapeT, size_t Axis, class... Ts>
 bool for_each_element(behavior_flag<break_on_false> o, FunT fun,
-                      const cat_result<ET, ShapeT, Axis, T1, T2> &t);
+                      const cat_result<ET, ShapeT, Axis, Ts...> &t);
 // nonzero_only
-template <class FunT, class ET, class ShapeT, size_t Axis, class T1, class T2>
+template <class FunT, class ET, class ShapeT, size_t Axis, class... Ts>
 bool for_each_element(behavior_flag<nonzero_only> o, FunT fun,
-                      const cat_result<ET, ShapeT, Axis, T1, T2> &t);
+                      const cat_result<ET, ShapeT, Axis, Ts...> &t);
 
 // size_t nonzero_elements_count(t)
-template <class ET, class ShapeT, size_t Axis, class T1, class T2>
+template <class ET, class ShapeT, size_t Axis, class... Ts>
 inline size_t
-nonzero_elements_count(const cat_result<ET, ShapeT, Axis, T1, T2> &t);
+nonzero_elements_count(const cat_result<ET, ShapeT, Axis, Ts...> &t);
 }
@@ -0,0 +1,222 @@
+/* * *
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Hao Yang (yangh2007@gmail.com)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include "simd.hpp"
+#include "tensor_base.hpp"
+#include "tensor.hpp"
+
+#include "compact_fwd.hpp"
+
+namespace wheels {
+
+// stream compaction
+// - the predicate is evaluated once per element into a byte mask, chunks of
+//   the mask are counted in parallel, an exclusive prefix sum of the counts
+//   gives every chunk its output offset, and the chunks are then written in
+//   parallel
+// - continuous tensors of bytes compacted on nonzero are used as the mask
+//   directly, masks are scanned with byte movemasks
+namespace detail {
+// _count_mask: number of nonzero bytes in mask[0, n)
+inline size_t _count_mask(const uint8_t *mask, size_t n) {
+  constexpr size_t w = simd_byte_mask::size;
+  size_t c = 0, i = 0;
+  for (; i + w <= n; i += w) {
+    c += simd_popcount(simd_byte_mask::run(mask + i));
+  }
+  for (; i < n; i++) {
+    c += mask[i] != 0;
+  }
+  return c;
+}
+
+// _for_each_in_mask: fun(i) for each nonzero mask[i], i < n, in order
+template <class FunT>
+void _for_each_in_mask(const uint8_t *mask, size_t n, FunT &fun) {
+  constexpr size_t w = simd_byte_mask::size;
+  size_t i = 0;
+  for (; i + w <= n; i += w) {
+    for (uint32_t m = simd_byte_mask::run(mask + i); m != 0; m &= m - 1) {
+      fun(i + simd_lowest_bit(m));
+    }
+  }
+  for (; i < n; i++) {
+    if (mask[i] != 0) {
+      fun(i);
+    }
+  }
+}
+
+// _compact_chunk_size: chunks cover whole byte masks
+inline size_t _compact_chunk_size(size_t n) {
+  if (n < parallel_threshold()) {
+    return std::max(n, size_t(1));
+  }
+  constexpr size_t w = simd_byte_mask::size;
+  const size_t chunk_num = (default_thread_pool().worker_num() + 1) * 4;
+  return ((n + chunk_num - 1) / chunk_num + w - 1) / w * w;
+}
+
+// _run_compact_chunks: fun(c, first, last) for every chunk c of [0, n)
+template <class FunT>
+void _run_compact_chunks(size_t n, size_t chunk_size, FunT &&fun) {
+  const size_t chunk_num = (n + chunk_size - 1) / chunk_size;
+  default_thread_pool().run(chunk_num, [&](size_t c) {
+    fun(c, c * chunk_size, std::min(n, (c + 1) * chunk_size));
+  });
+}
+
+// _compact_at: t[i]
+template <class T>
+decltype(auto) _compact_at(yes, const T &t, size_t i) {
+  return t.ptr()[i];
+}
+template <class T>
+decltype(auto) _compact_at(no, const T &t, size_t i) {
+  return element_at_index(t, i);
+}
+
+// _compact_mask: mask[i] = pred(t[i])
+template <class T, class PredT>
+const uint8_t *_compact_mask(const T &t, PredT &pred,
+                             std::unique_ptr<uint8_t[]> &buffer) {
+  const size_t n = numel_of(t);
+  buffer.reset(new uint8_t[n]);
+  uint8_t *mask = buffer.get();
+  auto continuous = _is_continuous_data(t);
+  _run_compact_chunks(n, _compact_chunk_size(n),
+                      [&](size_t, size_t first, size_t last) {
+                        for (size_t i = first; i < last; i++) {
+                          mask[i] = pred(_compact_at(continuous, t, i)) ? 1 : 0;
+                        }
+                      });
+  return mask;
+}
+template <class T>
+const uint8_t *_compact_bytes(yes, const T &t, _compact_nonzero &,
+                              std::unique_ptr<uint8_t[]> &) {
+  return reinterpret_cast<const uint8_t *>(t.ptr());
+}
+template <class T>
+const uint8_t *_compact_bytes(no, const T &t, _compact_nonzero &pred,
+                              std::unique_ptr<uint8_t[]> &buffer) {
+  return _compact_mask<T, _compact_nonzero>(t, pred, buffer);
+}
+template <class T>
+const uint8_t *_compact_mask(const T &t, _compact_nonzero &pred,
+                             std::unique_ptr<uint8_t[]> &buffer) {
+  using ele_t = typename T::value_type;
+  using bytes = const_bool<sizeof(ele_t) == 1 &&
+                           std::is_integral<ele_t>::value &&
+                           decltype(_is_continuous_data(t))::value>;
+  return _compact_bytes(bytes(), t, pred, buffer);
+}
+
+// _compact: alloc(count) once, then write(k, i) for the k-th selected index i
+template <class T, class PredT, class AllocT, class WriteT>
+void _compact(const T &t, PredT &pred, AllocT &&alloc, WriteT &&write) {
+  const size_t n = numel_of(t);
+  std::unique_ptr<uint8_t[]> buffer;
+  const uint8_t *mask = _compact_mask(t, pred, buffer);
+  const size_t chunk_size = _compact_chunk_size(n);
+  const size_t chunk_num = (n + chunk_size - 1) / chunk_size;
+  std::vector<size_t> offsets(chunk_num + 1, 0);
+  _run_compact_chunks(n, chunk_size, [&](size_t c, size_t first, size_t last) {
+    offsets[c + 1] = _count_mask(mask + first, last - first);
+  });
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  alloc(offsets.back());
+  _run_compact_chunks(n, chunk_size, [&](size_t c, size_t first, size_t last) {
+    size_t k = offsets[c];
+    auto emit = [&](size_t i) { write(k++, first + i); };
+    _for_each_in_mask(mask + first, last - first, emit);
+  });
+}
+}
+
+// compact
+template <class ET, class ShapeT, class T, class PredT>
+vecx_<ET> compact(const tensor_base<ET, ShapeT, T> &t, PredT pred) {
+  const auto &in = t.derived();
+  auto continuous = detail::_is_continuous_data(in);
+  vecx_<ET> values;
+  ET *dst = nullptr;
+  detail::_compact(in, pred,
+                   [&](size_t count) {
+                     values = vecx_<ET>(make_shape(count));
+                     dst = values.ptr();
+                   },
+                   [&](size_t k, size_t i) {
+                     dst[k] = detail::_compact_at(continuous, in, i);
+                   });
+  return values;
+}
+
+// compact_indices
+template <class ET, class ShapeT, class T, class PredT>
+vecx_<size_t> compact_indices(const tensor_base<ET, ShapeT, T> &t,
+                              PredT pred) {
+  vecx_<size_t> inds;
+  size_t *dst = nullptr;
+  detail::_compact(t.derived(), pred,
+                   [&](size_t count) {
+                     inds = vecx_<size_t>(make_shape(count));
+                     dst = inds.ptr();
+                   },
+                   [&](size_t k, size_t i) { dst[k] = i; });
+  return inds;
+}
+
+// compact_with_indices
+template <class ET, class ShapeT, class T, class PredT>
+std::pair<vecx_<ET>, vecx_<size_t>>
+compact_with_indices(const tensor_base<ET, ShapeT, T> &t, PredT pred) {
+  const auto &in = t.derived();
+  auto continuous = detail::_is_continuous_data(in);
+  std::pair<vecx_<ET>, vecx_<size_t>> result;
+  ET *values = nullptr;
+  size_t *inds = nullptr;
+  detail::_compact(in, pred,
+                   [&](size_t count) {
+                     result.first = vecx_<ET>(make_shape(count));
+                     result.second = vecx_<size_t>(make_shape(count));
+                     values = result.first.ptr();
+                     inds = result.second.ptr();
+                   },
+                   [&](size_t k, size_t i) {
+                     values[k] = detail::_compact_at(continuous, in, i);
+                     inds[k] = i;
+                   });
+  return result;
+}
+}
@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include "compact.hpp"
+#include "ewise.hpp"
+#include "index.hpp"
+#include "tensor.hpp"
+
+using namespace wheels;
+
+TEST(tensor, compact) {
+  vecx_<int> a(make_shape(1000));
+  for (size_t i = 0; i < a.numel(); i++) {
+    a[i] = int((i * 37) % 11) - 5;
+  }
+  auto pos = [](int e) { return e > 0; };
+  auto values = compact(a, pos);
+  auto inds = compact_indices(a, pos);
+  auto both = compact_with_indices(a, pos);
+  size_t c = 0;
+  for (size_t i = 0; i < a.numel(); i++) {
+    if (a[i] > 0) {
+      ASSERT_EQ(values[c], a[i]);
+      ASSERT_EQ(inds[c], i);
+      c++;
+    }
+  }
+  ASSERT_EQ(values.numel(), c);
+  ASSERT_EQ(inds.numel(), c);
+  ASSERT_TRUE(both.first == values);
+  ASSERT_TRUE(both.second == inds);
+
+  // nonzero by default, continuous bool tensors are scanned in place
+  vecx_<bool> flags(make_shape(a.numel()));
+  for (size_t i = 0; i < a.numel(); i++) {
+    flags[i] = a[i] > 0;
+  }
+  ASSERT_TRUE(compact_indices(flags) == inds);
+  ASSERT_TRUE(where(flags) == inds);
+  ASSERT_TRUE(where(a.ewised() > 0) == inds);
+  ASSERT_EQ(compact(a).numel(), a.numel() - compact_indices(a.ewised() == 0)
+                                               .numel());
+  ASSERT_EQ(compact_indices(vecx_<bool>(make_shape(0))).numel(), 0);
+}
@@ -0,0 +1,62 @@
+/* * *
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Hao Yang (yangh2007@gmail.com)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * */
+
+#pragma once
+
+#include <utility>
+
+#include "tensor_base_fwd.hpp"
+#include "tensor_fwd.hpp"
+
+namespace wheels {
+
+namespace detail {
+struct _compact_nonzero {
+  template <class T> constexpr bool operator()(const T &e) const {
+    return e != T(0);
+  }
+};
+}
+
+// compact(t, pred) -> vecx_<ET>
+// - elements e of t with pred(e), in index order, pred defaults to e != 0
+// - pred is called once per element, possibly from several threads
+template <class ET, class ShapeT, class T,
+          class PredT = detail::_compact_nonzero>
+vecx_<ET> compact(const tensor_base<ET, ShapeT, T> &t, PredT pred = PredT());
+
+// compact_indices(t, pred) -> vecx_<size_t>
+// - indices i of t with pred(t[i]), in increasing order
+template <class ET, class ShapeT, class T,
+          class PredT = detail::_compact_nonzero>
+vecx_<size_t> compact_indices(const tensor_base<ET, ShapeT, T> &t,
+                              PredT pred = PredT());
+
+// compact_with_indices(t, pred) -> (values, indices)
+template <class ET, class ShapeT, class T,
+          class PredT = detail::_compact_nonzero>
+std::pair<vecx_<ET>, vecx_<size_t>>
+compact_with_indices(const tensor_base<ET, ShapeT, T> &t,
+                     PredT pred = PredT());
+}
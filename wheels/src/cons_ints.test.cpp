@@ -34,6 +34,7 @@ TEST(core, constants) {
   ASSERT_EQ(1_c * 5, 5);
 
   static_assert((repeat(5_c, 3_c) == cat(5_c, 5_c, 5_c)).all(), "");
+  static_assert(!(cat(1_c, 2_c, 3_c) == 4_c).any(), "");
 
   static_assert(find_first_of(cat(1_c, 2_c, 3_c, 4_c), 0_c) == 4_indexc, "");
   static_assert(find_first_of(cat(1_c, 2_c, 3_c, 4_c), 1_c) == 0_indexc, "");
@@ -42,7 +42,7 @@ template <class T> struct _reduction<T> {
   static constexpr T sum = 0;
   static constexpr T prod = 1;
   static constexpr bool all = true;
-  static constexpr bool any = true;
+  static constexpr bool any = false;
 };
 template <class T, T Val, T... Vals> struct _reduction<T, Val, Vals...> {
   using _rest_reduction_t = _reduction<T, Vals...>;
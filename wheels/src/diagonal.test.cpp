@@ -8,6 +8,10 @@ using namespace wheels;
 TEST(tensor, diagonal) {
   ASSERT_TRUE(eye(5000).norm() == sqrt(5000));
   ASSERT_TRUE(eye(5000).sum() == 5000);
+  ASSERT_EQ(nonzero_elements_count(eye(5000)), 5000);
+  ASSERT_EQ(sum_of(eye(5000), summation_method<kahan_summation>()), 5000);
+  ASSERT_EQ(norm_squared(eye(5000), summation_method<pairwise_summation>()),
+            5000);
   ASSERT_TRUE(diag(eye(5000)) == ones(make_shape(5000)));
   ASSERT_TRUE(make_diag(vecx({2.0, 3.0, 4.0})) == matx(make_shape(3, 3),
                                                        with_elements, 2.0, 0.0,
@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+
+#include "ewise.hpp"
+#include "tensor.hpp"
+
+using namespace wheels;
+
+static void linear_sizes(benchmark::internal::Benchmark *b) {
+  b->RangeMultiplier(10)->Range(16, 100000000);
+}
+
+// (a + b) * c - d
+static void ewise_chain_dynamic(benchmark::State &state) {
+  const size_t n = state.range(0);
+  vecx_<float> a(make_shape(n), 1.0f), b(make_shape(n), 2.0f),
+      c(make_shape(n), 3.0f), d(make_shape(n), 4.0f), r(make_shape(n));
+  for (auto _ : state) {
+    r = (a + b).ewised() * c - d;
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetBytesProcessed(state.iterations() * n * sizeof(float) * 5);
+}
+BENCHMARK(ewise_chain_dynamic)->Apply(linear_sizes);
+
+template <size_t N> static void ewise_chain_static(benchmark::State &state) {
+  vec_<float, N> a, b, c, d, r;
+  std::fill(a.ptr(), a.ptr() + N, 1.0f);
+  std::fill(b.ptr(), b.ptr() + N, 2.0f);
+  for (auto _ : state) {
+    r = (a + b).ewised() * c - d;
+    benchmark::DoNotOptimize(r.ptr());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK_TEMPLATE(ewise_chain_static, 4);
+BENCHMARK_TEMPLATE(ewise_chain_static, 16);
+BENCHMARK_TEMPLATE(ewise_chain_static, 64);
+
+// a * s + b
+static void ewise_scalar_dynamic(benchmark::State &state) {
+  const size_t n = state.range(0);
+  vecx_<double> a(make_shape(n), 1.0), b(make_shape(n), 2.0), r(make_shape(n));
+  for (auto _ : state) {
+    r = a * 3.0 + b;
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(ewise_scalar_dynamic)->Apply(linear_sizes);
+
+// sin(a) + cos(b), no packet form
+static void ewise_std_func_dynamic(benchmark::State &state) {
+  const size_t n = state.range(0);
+  vecx_<double> a(make_shape(n), 1.0), b(make_shape(n), 2.0), r(make_shape(n));
+  for (auto _ : state) {
+    r = sin(a) + cos(b);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(ewise_std_func_dynamic)->RangeMultiplier(10)->Range(16, 10000000);
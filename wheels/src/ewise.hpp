@@ -27,8 +27,10 @@
 #include "ewise_fwd.hpp"
 
 #include "overloads.hpp"
+#include "simd.hpp"
 #include "what.hpp"
 
+#include "aligned.hpp"
 #include "extension.hpp"
 #include "tensor_base.hpp"
 #include "types.hpp"
@@ -155,6 +157,343 @@ constexpr bool for_each_element(
       std::forward<Ts>(ts)...);
 }
 
+// assign_elements for continuous targets
+// - expression trees whose leaves all have continuous data are flattened into
+//   a single loop over raw pointers
+// - trees built only from arithmetic ops, abs, min and max on one floating
+//   point type are evaluated on simd_pack packets
+// - super linear inputs (see cache.hpp) are evaluated once beforehand
+namespace detail {
+struct _linear_tag {};
+
+// _linear_leaf
+template <class ET> struct _linear_leaf {
+  using value_type = ET;
+  const ET *ptr;
+  const ET &operator()(size_t i) const { return ptr[i]; }
+  template <class PackT> typename PackT::type pack(size_t i) const {
+    return PackT::load(ptr + i);
+  }
+};
+
+// _pack_op
+// - how an ewise functor applies on packets, value is false if it cannot
+template <class OpT, class T> struct _pack_op : no {};
+#define WHEELS_LINEAR_PACK_BINARY_OP(name, pack_fun)                           \
+  template <class T> struct _pack_op<name, T> : yes {                          \
+    template <class PackT>                                                     \
+    static typename PackT::type apply(const name &,                            \
+                                      const typename PackT::type &a,           \
+                                      const typename PackT::type &b) {         \
+      return PackT::pack_fun(a, b);                                            \
+    }                                                                          \
+  };
+WHEELS_LINEAR_PACK_BINARY_OP(binary_op_plus, add)
+WHEELS_LINEAR_PACK_BINARY_OP(binary_op_minus, sub)
+WHEELS_LINEAR_PACK_BINARY_OP(binary_op_mul, mul)
+WHEELS_LINEAR_PACK_BINARY_OP(binary_op_div, div)
+WHEELS_LINEAR_PACK_BINARY_OP(std_func_min, min)
+WHEELS_LINEAR_PACK_BINARY_OP(std_func_max, max)
+#undef WHEELS_LINEAR_PACK_BINARY_OP
+
+template <class T> struct _pack_op<unary_op_minus, T> : yes {
+  template <class PackT>
+  static typename PackT::type apply(const unary_op_minus &,
+                                    const typename PackT::type &a) {
+    return PackT::mul(PackT::set1(T(-1)), a);
+  }
+};
+template <class T> struct _pack_op<std_func_abs, T> : yes {
+  template <class PackT>
+  static typename PackT::type apply(const std_func_abs &,
+                                    const typename PackT::type &a) {
+    return PackT::abs(a);
+  }
+};
+
+// tensor op scalar, scalar op tensor
+template <class OpT> struct _is_pack_arith_op : no {};
+template <> struct _is_pack_arith_op<binary_op_plus> : yes {};
+template <> struct _is_pack_arith_op<binary_op_minus> : yes {};
+template <> struct _is_pack_arith_op<binary_op_mul> : yes {};
+template <> struct _is_pack_arith_op<binary_op_div> : yes {};
+template <class T, class S,
+          bool = std::is_floating_point<T>::value &&
+                 std::is_arithmetic<std::decay_t<S>>::value>
+struct _is_pack_coeff : no {};
+template <class T, class S>
+struct _is_pack_coeff<T, S, true>
+    : const_bool<std::is_same<
+          std::decay_t<decltype(std::declval<T>() * std::declval<S>())>,
+          T>::value> {};
+template <class OpT, class S, class T>
+struct _pack_op<const_call_list<OpT, const_arg<0>, const_coeff<S>>, T>
+    : const_bool<_is_pack_arith_op<OpT>::value &&
+                 _is_pack_coeff<T, S>::value> {
+  template <class PackT>
+  static typename PackT::type
+  apply(const const_call_list<OpT, const_arg<0>, const_coeff<S>> &op,
+        const typename PackT::type &a) {
+    return _pack_op<OpT, T>::template apply<PackT>(
+        op.functor, a, PackT::set1(T(std::get<1>(op.bind_expr_args).val)));
+  }
+};
+template <class OpT, class S, class T>
+struct _pack_op<const_call_list<OpT, const_coeff<S>, const_arg<0>>, T>
+    : const_bool<_is_pack_arith_op<OpT>::value &&
+                 _is_pack_coeff<T, S>::value> {
+  template <class PackT>
+  static typename PackT::type
+  apply(const const_call_list<OpT, const_coeff<S>, const_arg<0>> &op,
+        const typename PackT::type &a) {
+    return _pack_op<OpT, T>::template apply<PackT>(
+        op.functor, PackT::set1(T(std::get<0>(op.bind_expr_args).val)), a);
+  }
+};
+
+// _linear_node
+template <class OpT, class... ChildTs> struct _linear_node {
+  const OpT &op;
+  std::tuple<ChildTs...> children;
+  decltype(auto) operator()(size_t i) const {
+    return _call(i, make_const_sequence_for<ChildTs...>());
+  }
+  template <class PackT> typename PackT::type pack(size_t i) const {
+    return _pack<PackT>(i, make_const_sequence_for<ChildTs...>());
+  }
+
+private:
+  template <size_t... Is>
+  decltype(auto) _call(size_t i, const const_ints<size_t, Is...> &) const {
+    return op(std::get<Is>(children)(i)...);
+  }
+  template <class PackT, size_t... Is>
+  typename PackT::type _pack(size_t i,
+                             const const_ints<size_t, Is...> &) const {
+    return _pack_op<OpT, typename PackT::value_type>::template apply<PackT>(
+        op, std::get<Is>(children).template pack<PackT>(i)...);
+  }
+};
+
+// _linear_pack_value_t
+// - the floating point type packets of the tree hold, void if not packable
+template <class EvalT> struct _linear_pack_value { using type = void; };
+template <class ET> struct _linear_pack_value<_linear_leaf<ET>> {
+  using type = std::conditional_t<std::is_floating_point<ET>::value &&
+                                      simd_pack<ET>::size != 1,
+                                  ET, void>;
+};
+template <class OpT, class ChildT, class... ChildTs>
+struct _linear_pack_value<_linear_node<OpT, ChildT, ChildTs...>> {
+  using _t = typename _linear_pack_value<ChildT>::type;
+  using type = std::conditional_t<
+      !std::is_void<_t>::value &&
+          const_ints<bool, std::is_same<
+                               typename _linear_pack_value<ChildTs>::type,
+                               _t>::value...>::all() &&
+          _pack_op<OpT, _t>::value,
+      _t, void>;
+};
+template <class EvalT>
+using _linear_pack_value_t = typename _linear_pack_value<EvalT>::type;
+
+// _is_linear_evaluable
+template <class T> constexpr no _is_linear_evaluable(_linear_tag, const tensor_core<T> &) {
+  return no();
+}
+template <class ET, class ShapeT, class T>
+constexpr yes
+_is_linear_evaluable(_linear_tag,
+                     const tensor_continuous_data_base<ET, ShapeT, T> &) {
+  return yes();
+}
+template <class EleT, class ShapeT, class OpT, class InputT, class... InputTs>
+constexpr auto _is_linear_evaluable(
+    _linear_tag,
+    const ewise_op_result<EleT, ShapeT, OpT, InputT, InputTs...> &) {
+  return decltype(
+      const_ints<bool, decltype(_is_linear_evaluable(
+                           _linear_tag(),
+                           std::declval<const std::decay_t<InputT> &>()))::value,
+                 decltype(_is_linear_evaluable(
+                     _linear_tag(),
+                     std::declval<const std::decay_t<InputTs> &>()))::value...>::
+          all())();
+}
+
+// _make_linear_eval
+template <class ET, class ShapeT, class T>
+constexpr _linear_leaf<ET>
+_make_linear_eval(_linear_tag,
+                  const tensor_continuous_data_base<ET, ShapeT, T> &t) {
+  return _linear_leaf<ET>{t.ptr()};
+}
+template <class EwiseOpResultT, size_t... Is>
+constexpr auto _make_linear_eval_seq(const EwiseOpResultT &t,
+                                     const const_ints<size_t, Is...> &) {
+  using node_t = _linear_node<std::decay_t<decltype(t.op)>,
+                              decltype(_make_linear_eval(
+                                  _linear_tag(), std::get<Is>(t.inputs)))...>;
+  return node_t{t.op, std::make_tuple(_make_linear_eval(
+                          _linear_tag(), std::get<Is>(t.inputs))...)};
+}
+template <class EleT, class ShapeT, class OpT, class InputT, class... InputTs>
+constexpr auto _make_linear_eval(
+    _linear_tag,
+    const ewise_op_result<EleT, ShapeT, OpT, InputT, InputTs...> &t) {
+  return _make_linear_eval_seq(t, make_const_sequence_for<InputT, InputTs...>());
+}
+
+// _assign_linear_range
+template <class ToET, class EvalT, class PackValueT>
+void _assign_linear_range(ToET *to, const EvalT &e, size_t first, size_t last,
+                          const PackValueT *) {
+  using pack_t = simd_pack<PackValueT>;
+  size_t i = first;
+  for (; i + pack_t::size <= last; i += pack_t::size) {
+    pack_t::store(to + i, e.template pack<pack_t>(i));
+  }
+  for (; i < last; i++) {
+    to[i] = e(i);
+  }
+}
+template <class ToET, class EvalT>
+void _assign_linear_range(ToET *to, const EvalT &e, size_t first, size_t last,
+                          const void *) {
+  for (size_t i = first; i < last; i++) {
+    auto v = e(i);
+    to[i] = v;
+  }
+}
+
+// _assign_linear_static
+// - small static shapes (see _is_small_static_shape) are unrolled and never
+//   reach the thread pool
+template <size_t N, class ToET, class EvalT, class PackValueT>
+void _assign_linear_static(ToET *to, const EvalT &e, const PackValueT *) {
+  using pack_t = simd_pack<PackValueT>;
+  constexpr size_t np = N / pack_t::size * pack_t::size;
+  for_each(make_const_sequence(const_size<np / pack_t::size>()),
+           [to, &e](auto i) {
+             constexpr size_t k = decltype(i)::value * pack_t::size;
+             pack_t::store(to + k, e.template pack<pack_t>(k));
+           });
+  _assign_linear_range(to, e, np, N, (const void *)nullptr);
+}
+template <size_t N, class ToET, class EvalT>
+void _assign_linear_static(ToET *to, const EvalT &e, const void *) {
+  for_each(make_const_sequence(const_size<N>()), [to, &e](auto i) {
+    auto v = e(decltype(i)::value);
+    to[decltype(i)::value] = v;
+  });
+}
+template <class ET, class EvalT, class PackTagT, class FromShapeT>
+bool _assign_linear_small(yes, ET *dst, const EvalT &e, PackTagT pack_tag,
+                          const FromShapeT &) {
+  _assign_linear_static<FromShapeT::static_magnitude>(dst, e, pack_tag);
+  return true;
+}
+template <class ET, class EvalT, class PackTagT, class FromShapeT>
+bool _assign_linear_small(no, ET *, const EvalT &, PackTagT,
+                          const FromShapeT &) {
+  return false;
+}
+
+template <class ET, class ShapeT, class T, class FromT>
+void _assign_ewise_op_result(yes, tensor_continuous_data_base<ET, ShapeT, T> &to,
+                             const FromT &from) {
+  decltype(auto) s = from.shape();
+  if (to.shape() != s) {
+    reserve_shape(to.derived(), s);
+  }
+  const auto e = _make_linear_eval(_linear_tag(), from);
+  using pack_value_t = _linear_pack_value_t<std::decay_t<decltype(e)>>;
+  using pack_tag_t = std::conditional_t<std::is_same<pack_value_t, ET>::value,
+                                        const pack_value_t *, const void *>;
+  using from_shape_t = std::decay_t<decltype(s)>;
+  ET *dst = to.ptr();
+  if (_assign_linear_small(
+          const_bool<_is_small_static_shape<from_shape_t>::value>(), dst, e,
+          pack_tag_t(), s)) {
+    return;
+  }
+  const size_t n = numel_of(to);
+  auto &pool = default_thread_pool();
+  if (n < parallel_threshold()) {
+    _assign_linear_range(dst, e, 0, n, pack_tag_t());
+    return;
+  }
+  // chunks are whole numbers of cache lines
+  const size_t chunk_size =
+      (std::max(parallel_threshold() / 2,
+                (n + (pool.worker_num() + 1) * 4 - 1) /
+                    ((pool.worker_num() + 1) * 4)) +
+       63) /
+      64 * 64;
+  pool.run((n + chunk_size - 1) / chunk_size, [dst, &e, n, chunk_size](size_t c) {
+    _assign_linear_range(dst, e, c * chunk_size,
+                         std::min(n, (c + 1) * chunk_size), pack_tag_t());
+  });
+}
+template <class ET, class ShapeT, class T, class FromT>
+void _assign_ewise_op_result(no, tensor_continuous_data_base<ET, ShapeT, T> &to,
+                             const FromT &from) {
+  assign_elements(static_cast<tensor_core<T> &>(to),
+                  static_cast<const tensor_core<FromT> &>(from));
+}
+
+// _is_super_linear
+template <class EleT, class ShapeT, class OpT, class InputT, class... InputTs>
+constexpr auto _is_super_linear(
+    _cache_tag, const ewise_op_result<EleT, ShapeT, OpT, InputT, InputTs...> &) {
+  return decltype(
+      const_ints<bool, decltype(_is_super_linear(
+                           _cache_tag(),
+                           std::declval<const std::decay_t<InputT> &>()))::value,
+                 decltype(_is_super_linear(
+                     _cache_tag(),
+                     std::declval<const std::decay_t<InputTs> &>()))::value...>::
+          any())();
+}
+
+// _cache_super_linear
+// - rebuilds the tree with super linear inputs replaced by their evaluations
+template <class EwiseOpResultT, size_t... Is>
+auto _cache_super_linear_seq(const EwiseOpResultT &t,
+                             const const_ints<size_t, Is...> &) {
+  return make_ewise_op_result<typename EwiseOpResultT::value_type,
+                              typename EwiseOpResultT::shape_type>(
+      t.op, _cache_super_linear(_cache_tag(), std::get<Is>(t.inputs))...);
+}
+template <class EleT, class ShapeT, class OpT, class InputT, class... InputTs>
+auto _cache_super_linear(
+    _cache_tag,
+    const ewise_op_result<EleT, ShapeT, OpT, InputT, InputTs...> &t) {
+  return _cache_super_linear_seq(t,
+                                 make_const_sequence_for<InputT, InputTs...>());
+}
+
+template <class ET, class ShapeT, class T, class FromT>
+void _assign_ewise_op_result_cached(
+    no, tensor_continuous_data_base<ET, ShapeT, T> &to, const FromT &from) {
+  _assign_ewise_op_result(_is_linear_evaluable(_linear_tag(), from), to, from);
+}
+template <class ET, class ShapeT, class T, class FromT>
+void _assign_ewise_op_result_cached(
+    yes, tensor_continuous_data_base<ET, ShapeT, T> &to, const FromT &from) {
+  assign_elements(to, _cache_super_linear(_cache_tag(), from));
+}
+}
+template <class ET, class ShapeT, class T, class EleT, class FromShapeT,
+          class OpT, class InputT, class... InputTs>
+void assign_elements(
+    tensor_continuous_data_base<ET, ShapeT, T> &to,
+    const ewise_op_result<EleT, FromShapeT, OpT, InputT, InputTs...> &from) {
+  static_assert(ShapeT::rank == FromShapeT::rank, "shape ranks mismatch!");
+  detail::_assign_ewise_op_result_cached(
+      detail::_is_super_linear(detail::_cache_tag(), from), to, from);
+}
+
 // most ewise binray ops apply on two tensors (except certain ops like below)
 template <class OpT, class, class EleT, class ShapeT, class T, class... EleTs,
           class... ShapeTs, class... Ts>
@@ -9,6 +9,7 @@
 #include "tensor.hpp"
 #include "matrix.hpp"
 #include "diagonal.hpp"
+#include "tensor_map.hpp"
 
 using namespace wheels;
 using namespace wheels::literals;
@@ -85,4 +86,37 @@ TEST(tensor, ewise_ops4) {
       ASSERT_TRUE(sum3(i, j) == mat_of_mats1(i, j) + mat_of_mats2);
     }
   }
-}
\ No newline at end of file
+}
+TEST(tensor, ewise_linear) {
+  const size_t n = 1003;
+  vecx_<float> a(make_shape(n)), b(make_shape(n)), c(make_shape(n));
+  for (size_t i = 0; i < n; i++) {
+    a.ptr()[i] = float(i % 17) - 8.5f;
+    b.ptr()[i] = float(i % 5) + 0.25f;
+    c.ptr()[i] = float(i % 11) * 0.5f - 2.0f;
+  }
+  vecx_<float> r1 = (a + b).ewised() * c - a / b;
+  vecx_<float> r2 = -abs(a) * 3 + min(b, c) - max(a, c) / 2.0f;
+  vecx_<double> r3 = a * 0.1; // float * double, not packed
+  for (size_t i = 0; i < n; i++) {
+    float x = a.ptr()[i], y = b.ptr()[i], z = c.ptr()[i];
+    ASSERT_EQ(r1.ptr()[i], (x + y) * z - x / y);
+    ASSERT_EQ(r2.ptr()[i],
+              -std::abs(x) * 3 + std::min(y, z) - std::max(x, z) / 2.0f);
+    ASSERT_EQ(r3.ptr()[i], x * 0.1);
+  }
+
+  // aliasing with a leaf, parallel chunks
+  set_parallel_threshold(64);
+  auto aa = a;
+  aa = aa * 2.0f + b;
+  for (size_t i = 0; i < n; i++) {
+    ASSERT_EQ(aa.ptr()[i], a.ptr()[i] * 2.0f + b.ptr()[i]);
+  }
+  set_parallel_threshold(0);
+
+  // tensor_map leaves and integers
+  std::vector<int> data(n, 3);
+  matx_<int> m = map(make_shape(17, 59), data.data()) * 2 - 1;
+  ASSERT_TRUE(m == constants(make_shape(17, 59), 5));
+}
@@ -30,6 +30,8 @@
 
 #include "const_ints.hpp"
 
+#include "aligned_fwd.hpp"
+#include "cache_fwd.hpp"
 #include "extension_fwd.hpp"
 #include "tensor_base_fwd.hpp"
 
@@ -104,6 +106,13 @@ constexpr auto scalarize(T &&t)
 template <class EleT, class ShapeT, class OpT, class InputT, class... InputTs>
 class ewise_op_result;
 
+// assign_elements
+template <class ET, class ShapeT, class T, class EleT, class FromShapeT,
+          class OpT, class InputT, class... InputTs>
+void assign_elements(
+    tensor_continuous_data_base<ET, ShapeT, T> &to,
+    const ewise_op_result<EleT, FromShapeT, OpT, InputT, InputTs...> &from);
+
 namespace detail {
 template <class FirstTT, class... TTs, size_t... Is, class FirstEleT,
           class... EleTs, class FirstShapeT, class... ShapeTs, class FirstT,
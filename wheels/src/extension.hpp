@@ -101,6 +101,21 @@ void reserve_shape(tensor_extension_wrapper<ExtensionT, EleT, ShapeT, T> &t,
   reserve_shape(t.host, shape);
 }
 
+// _is_super_linear
+namespace detail {
+template <class ExtensionT, class EleT, class ShapeT, class T>
+constexpr auto _is_super_linear(
+    _cache_tag, const tensor_extension_wrapper<ExtensionT, EleT, ShapeT, T> &) {
+  return decltype(_is_super_linear(
+      _cache_tag(), std::declval<const std::decay_t<T> &>()))();
+}
+template <class ExtensionT, class EleT, class ShapeT, class T>
+constexpr decltype(auto) _cache_super_linear(
+    _cache_tag, const tensor_extension_wrapper<ExtensionT, EleT, ShapeT, T> &t) {
+  return _cache_super_linear(_cache_tag(), t.host);
+}
+}
+
 // for_each_element
 template <behavior_flag_enum F, class FunT, class ExtensionT, class EleT,
           class ShapeT, class T, class... Ts>
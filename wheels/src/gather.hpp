@@ -0,0 +1,117 @@
+/* * *
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Hao Yang (yangh2007@gmail.com)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "simd.hpp"
+
+namespace wheels {
+
+namespace detail {
+// how many elements ahead gathers and scatters prefetch
+constexpr size_t _gather_prefetch_distance = 16;
+
+// _copy_converted_n: dst[i] = src[i]
+template <class ToET, class FromET>
+void _copy_converted_n(const FromET *src, size_t n, ToET *dst) {
+  std::transform(src, src + n, dst,
+                 [](const FromET &e) { return static_cast<ToET>(e); });
+}
+template <class ET> void _copy_converted_n(const ET *src, size_t n, ET *dst) {
+  std::copy_n(src, n, dst);
+}
+
+// _gather_strided_n: dst[i] = src[i * step]
+template <class ToET, class FromET>
+void _gather_strided_n(const FromET *src, int64_t step, size_t n, ToET *dst) {
+  for (size_t i = 0; i < n; i++) {
+    dst[i] = static_cast<ToET>(src[int64_t(i) * step]);
+  }
+}
+
+// _scatter_strided_n: dst[i * step] = src[i]
+template <class ToET, class FromET>
+void _scatter_strided_n(const FromET *src, size_t n, ToET *dst, int64_t step) {
+  for (size_t i = 0; i < n; i++) {
+    dst[int64_t(i) * step] = static_cast<ToET>(src[i]);
+  }
+}
+
+// _gather_n: dst[i] = src[offsets[i]]
+template <class ToET, class FromET, class IndexT>
+void _gather_n(const FromET *src, const IndexT *offsets, size_t n,
+               ToET *dst) {
+  constexpr size_t d = _gather_prefetch_distance;
+  for (size_t i = 0; i < n; i++) {
+    if (i + d < n) {
+      wheels_prefetch(src + offsets[i + d]);
+    }
+    dst[i] = static_cast<ToET>(src[offsets[i]]);
+  }
+}
+template <class ET, class IndexT>
+void _gather_simd_n(const ET *src, const IndexT *offsets, size_t n, ET *dst) {
+  using gather = simd_gather<ET>;
+  constexpr size_t d = _gather_prefetch_distance;
+  size_t i = 0;
+  for (; i + gather::size <= n; i += gather::size) {
+    for (size_t j = i + d; j < std::min(n, i + d + gather::size); j++) {
+      wheels_prefetch(src + offsets[j]);
+    }
+    gather::run(src, offsets + i, dst + i);
+  }
+  _gather_n(src, offsets + i, n - i, dst + i);
+}
+template <class ET>
+void _gather_n(const ET *src, const int64_t *offsets, size_t n, ET *dst) {
+  _gather_simd_n(src, offsets, n, dst);
+}
+template <class ET>
+void _gather_n(const ET *src, const int32_t *offsets, size_t n, ET *dst) {
+  _gather_simd_n(src, offsets, n, dst);
+}
+
+// _scatter_n: dst[offsets[i]] = src[i], later elements win on duplicates
+template <class ToET, class FromET, class IndexT>
+void _scatter_n(const FromET *src, size_t n, ToET *dst,
+                const IndexT *offsets) {
+  for (size_t i = 0; i < n; i++) {
+    dst[offsets[i]] = static_cast<ToET>(src[i]);
+  }
+}
+
+// _is_unit_run: offsets[i] == offsets[0] + i
+template <class IndexT> bool _is_unit_run(const IndexT *offsets, size_t n) {
+  for (size_t i = 1; i < n; i++) {
+    if (offsets[i] != offsets[0] + IndexT(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+}
+}
@@ -0,0 +1,233 @@
+/* * *
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Hao Yang (yangh2007@gmail.com)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * */
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+
+#include "parallel.hpp"
+#include "simd.hpp"
+#include "storage.hpp"
+
+namespace wheels {
+
+namespace detail {
+// blocking parameters
+// - a micro tile of mr x nr results lives in registers, nr spans whole
+//   vector registers
+// - a kc x nr panel of b stays in L1, an mc x kc block of a in L2, and a
+//   kc x nc block of b in L3
+template <class T> struct _gemm_config {
+  using pack = simd_pack<T>;
+  static constexpr size_t nr_packs = pack::size > 1 ? 2 : 4;
+  static constexpr size_t nr = pack::size * nr_packs;
+  static constexpr size_t mr = pack::size > 1 ? 6 : 4;
+  static constexpr size_t kc = 256;
+  static constexpr size_t mc = mr * 20;
+  static constexpr size_t nc = nr * 64;
+};
+template <class T> constexpr size_t _gemm_config<T>::nr_packs;
+template <class T> constexpr size_t _gemm_config<T>::nr;
+template <class T> constexpr size_t _gemm_config<T>::mr;
+template <class T> constexpr size_t _gemm_config<T>::kc;
+template <class T> constexpr size_t _gemm_config<T>::mc;
+template <class T> constexpr size_t _gemm_config<T>::nc;
+
+// pack rows [i0, i0 + mc) x cols [p0, p0 + kc) of a into mr-row panels,
+// stored column by column, the last panel is padded with zeros
+template <class T>
+void _gemm_pack_a(size_t mc, size_t kc, const T *a, size_t lda, T *ap) {
+  constexpr size_t mr = _gemm_config<T>::mr;
+  for (size_t i0 = 0; i0 < mc; i0 += mr) {
+    const size_t mr_eff = std::min(mr, mc - i0);
+    for (size_t p = 0; p < kc; p++) {
+      for (size_t i = 0; i < mr; i++) {
+        ap[p * mr + i] = i < mr_eff ? a[(i0 + i) * lda + p] : T(0);
+      }
+    }
+    ap += mr * kc;
+  }
+}
+
+// pack rows [p0, p0 + kc) x cols [j0, j0 + nc) of b into nr-column panels,
+// stored row by row, the last panel is padded with zeros
+template <class T>
+void _gemm_pack_b(size_t kc, size_t nc, const T *b, size_t ldb, T *bp) {
+  constexpr size_t nr = _gemm_config<T>::nr;
+  for (size_t j0 = 0; j0 < nc; j0 += nr) {
+    const size_t nr_eff = std::min(nr, nc - j0);
+    for (size_t p = 0; p < kc; p++) {
+      const T *brow = b + p * ldb + j0;
+      T *bprow = bp + p * nr;
+      size_t j = 0;
+      for (; j < nr_eff; j++) {
+        bprow[j] = brow[j];
+      }
+      for (; j < nr; j++) {
+        bprow[j] = T(0);
+      }
+    }
+    bp += nr * kc;
+  }
+}
+
+// c[mr_eff x nr_eff] (+)= ap * bp
+template <class T>
+void _gemm_micro_kernel(size_t kc, const T *ap, const T *bp, T *c, size_t ldc,
+                        size_t mr_eff, size_t nr_eff, bool accumulate) {
+  using config = _gemm_config<T>;
+  using pack = typename config::pack;
+  using pack_t = typename pack::type;
+  constexpr size_t mr = config::mr;
+  constexpr size_t nr = config::nr;
+  constexpr size_t nrp = config::nr_packs;
+  constexpr size_t ps = pack::size;
+
+  pack_t acc[mr][nrp];
+  for (size_t i = 0; i < mr; i++) {
+    for (size_t j = 0; j < nrp; j++) {
+      acc[i][j] = pack::zero();
+    }
+  }
+  for (size_t p = 0; p < kc; p++) {
+    pack_t b[nrp];
+    for (size_t j = 0; j < nrp; j++) {
+      b[j] = pack::load(bp + p * nr + j * ps);
+    }
+    for (size_t i = 0; i < mr; i++) {
+      const pack_t a = pack::set1(ap[p * mr + i]);
+      for (size_t j = 0; j < nrp; j++) {
+        acc[i][j] = pack::fma(a, b[j], acc[i][j]);
+      }
+    }
+  }
+
+  if (mr_eff == mr && nr_eff == nr) {
+    for (size_t i = 0; i < mr; i++) {
+      for (size_t j = 0; j < nrp; j++) {
+        T *cij = c + i * ldc + j * ps;
+        pack::store(cij,
+                    accumulate ? pack::add(pack::load(cij), acc[i][j])
+                               : acc[i][j]);
+      }
+    }
+  } else {
+    T tile[mr * nr];
+    for (size_t i = 0; i < mr; i++) {
+      for (size_t j = 0; j < nrp; j++) {
+        pack::store(tile + i * nr + j * ps, acc[i][j]);
+      }
+    }
+    for (size_t i = 0; i < mr_eff; i++) {
+      for (size_t j = 0; j < nr_eff; j++) {
+        c[i * ldc + j] =
+            accumulate ? c[i * ldc + j] + tile[i * nr + j] : tile[i * nr + j];
+      }
+    }
+  }
+}
+}
+
+// gemm
+// - c = a * b, where a is m x k, b is k x n and c is m x n, all row-major
+//   with leading dimensions lda, ldb and ldc, c must not overlap a or b
+// - blocks of rows of c are computed in parallel on default_thread_pool()
+//   for large products
+template <class T>
+void gemm(size_t m, size_t n, size_t k, const T *a, size_t lda, const T *b,
+          size_t ldb, T *c, size_t ldc) {
+  using config = detail::_gemm_config<T>;
+  constexpr size_t mr = config::mr;
+  constexpr size_t nr = config::nr;
+  if (m == 0 || n == 0) {
+    return;
+  }
+  if (k == 0) {
+    for (size_t i = 0; i < m; i++) {
+      std::fill(c + i * ldc, c + i * ldc + n, T(0));
+    }
+    return;
+  }
+
+  const size_t kc_max = std::min(config::kc, k);
+  const size_t nc_max = std::min(config::nc, (n + nr - 1) / nr * nr);
+  const size_t mc_max = std::min(config::mc, (m + mr - 1) / mr * mr);
+
+  auto &pool = default_thread_pool();
+  const size_t mblocks = (m + config::mc - 1) / config::mc;
+  const bool go_parallel =
+      mblocks > 1 && m * n * k / 64 >= parallel_threshold();
+  const size_t nchunks =
+      go_parallel ? std::min(mblocks, pool.worker_num() + 1) : 1;
+
+  // the packed b panel and one packed a block per chunk, each starting on a
+  // cache line and left uninitialized since packing overwrites them
+  using alloc_t = aligned_allocator<T>;
+  constexpr size_t line = alloc_t::alignment / sizeof(T) > 0
+                              ? alloc_t::alignment / sizeof(T)
+                              : 1;
+  const size_t bp_size = (kc_max * nc_max + line - 1) / line * line;
+  const size_t ap_size = (mc_max * kc_max + line - 1) / line * line;
+  const size_t panels_size = bp_size + ap_size * nchunks;
+  alloc_t alloc;
+  auto release = [&alloc, panels_size](T *p) {
+    alloc.deallocate(p, panels_size);
+  };
+  std::unique_ptr<T, decltype(release)> panels(alloc.allocate(panels_size),
+                                               release);
+  T *const bp = panels.get();
+
+  for (size_t jc = 0; jc < n; jc += config::nc) {
+    const size_t nc = std::min(config::nc, n - jc);
+    for (size_t pc = 0; pc < k; pc += config::kc) {
+      const size_t kc = std::min(config::kc, k - pc);
+      detail::_gemm_pack_b(kc, nc, b + pc * ldb + jc, ldb, bp);
+
+      // each chunk owns a run of mc-row blocks and its own packed a
+      pool.run(nchunks,
+               [&, nc, kc](size_t chunk) {
+                 T *const ap = bp + bp_size + chunk * ap_size;
+                 const size_t first = chunk * mblocks / nchunks;
+                 const size_t last = (chunk + 1) * mblocks / nchunks;
+                 for (size_t ib = first; ib < last; ib++) {
+                   const size_t ic = ib * config::mc;
+                   const size_t mc = std::min(config::mc, m - ic);
+                   detail::_gemm_pack_a(mc, kc, a + ic * lda + pc, lda, ap);
+                   for (size_t jr = 0; jr < nc; jr += nr) {
+                     for (size_t ir = 0; ir < mc; ir += mr) {
+                       detail::_gemm_micro_kernel(
+                           kc, ap + ir * kc, bp + jr * kc,
+                           c + (ic + ir) * ldc + jc + jr, ldc,
+                           std::min(mr, mc - ir), std::min(nr, nc - jr),
+                           pc > 0);
+                     }
+                   }
+                 }
+               },
+               nchunks);
+    }
+  }
+}
+}
@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+
+#include "ewise.hpp"
+#include "index.hpp"
+#include "tensor.hpp"
+
+using namespace wheels;
+
+static void linear_sizes(benchmark::internal::Benchmark *b) {
+  b->RangeMultiplier(10)->Range(16, 100000000);
+}
+
+// where, half of the flags set
+static void index_where(benchmark::State &state) {
+  const size_t n = state.range(0);
+  vecx_<float> a(make_shape(n));
+  for (size_t i = 0; i < n; i++) {
+    a.ptr()[i] = (i * 2654435761u) % 7 < 3 ? 1.0f : -1.0f;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(where(a > 0.0f));
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(index_where)->Apply(linear_sizes);
+
+// gather by an index tensor
+static void index_gather(benchmark::State &state) {
+  const size_t n = state.range(0);
+  vecx_<float> a(make_shape(n), 1.0f), r(make_shape(n / 2));
+  vecx_<size_t> inds(make_shape(n / 2));
+  for (size_t i = 0; i < n / 2; i++) {
+    inds.ptr()[i] = (i * 2654435761u) % n;
+  }
+  for (auto _ : state) {
+    r = a[inds];
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * (n / 2));
+}
+BENCHMARK(index_gather)->Apply(linear_sizes);
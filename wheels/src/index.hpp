@@ -24,6 +24,12 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
+
+#include "alias.hpp"
+#include "compact.hpp"
+#include "gather.hpp"
 #include "tensor_base.hpp"
 #include "tensor_view_base.hpp"
 #include "tensor.hpp"
@@ -100,18 +106,164 @@ _at_indices(const tensor_base<InputET, InputShapeT, InputTensorT> &,
 }
 }
 
+// assign_elements
+// - index views of continuous inputs are read with gathers and written with
+//   scatters, indices are converted in batches and consecutive batches
+//   become bulk copies
+namespace detail {
+constexpr size_t _index_batch_size = 256;
+
+// offsets[j] = index[first + j]
+// - continuous integral index tensors are used in place
+template <class IndexT>
+const int64_t *_index_batch(no, const IndexT &index, size_t first, size_t n,
+                            int64_t *offsets) {
+  for (size_t j = 0; j < n; j++) {
+    offsets[j] = int64_t(element_at_index(index, first + j));
+  }
+  return offsets;
+}
+template <class IndexT>
+auto _index_batch(yes, const IndexT &index, size_t first, size_t,
+                  int64_t *) {
+  return index.ptr() + first;
+}
+template <class IndexT>
+auto _index_batch(const IndexT &index, size_t first, size_t n,
+                  int64_t *offsets) {
+  using index_ele_t = typename IndexT::value_type;
+  using in_place = const_bool<std::is_integral<index_ele_t>::value &&
+                              decltype(_is_continuous_data(index))::value>;
+  return _index_batch(in_place(), index, first, n, offsets);
+}
+
+template <class ToET, class ViewT>
+void _read_index_elements(ToET *dst, const ViewT &from) {
+  const size_t n = numel_of(from);
+  const size_t batch_num = (n + _index_batch_size - 1) / _index_batch_size;
+  const auto *src = from.input_tensor.ptr();
+  auto task = [&](size_t first, size_t last) {
+    int64_t offsets[_index_batch_size];
+    for (size_t b = first; b < last; b++) {
+      const size_t begin = b * _index_batch_size;
+      const size_t len = std::min(_index_batch_size, n - begin);
+      auto *offs = _index_batch(from.index_tensor, begin, len, offsets);
+      if (_is_unit_run(offs, len)) {
+        _copy_converted_n(src + offs[0], len, dst + begin);
+      } else {
+        _gather_n(src, offs, len, dst + begin);
+      }
+    }
+  };
+  auto &pool = default_thread_pool();
+  if (n < parallel_threshold() || batch_num < 2) {
+    task(size_t(0), batch_num);
+    return;
+  }
+  const size_t chunk_num = std::min(batch_num, (pool.worker_num() + 1) * 4);
+  const size_t chunk_size = (batch_num + chunk_num - 1) / chunk_num;
+  pool.run((batch_num + chunk_size - 1) / chunk_size, [&](size_t c) {
+    task(c * chunk_size, std::min(batch_num, (c + 1) * chunk_size));
+  });
+}
+
+template <class ET, class ShapeT, class T, class ViewT>
+void _assign_index_view(no, tensor_continuous_data_base<ET, ShapeT, T> &to,
+                        const ViewT &from) {
+  assign_elements(static_cast<tensor_core<T> &>(to),
+                  static_cast<const tensor_core<ViewT> &>(from));
+}
+template <class ET, class ShapeT, class T, class ViewT>
+void _assign_index_view(yes, tensor_continuous_data_base<ET, ShapeT, T> &to,
+                        const ViewT &from) {
+  // aliased, e.g. a = at_indices(a, inds)
+  const bool aliased =
+      numel_of(from) != 0 &&
+      _may_read_from(yes(), from.input_tensor, to.ptr(), numel_of(to));
+  _assign_continuous(to, from.shape(), aliased,
+                     [&from](ET *dst) { _read_index_elements(dst, from); });
+}
+
+// values[j] = from[first + j]
+template <class ET, class FromT>
+const ET *_index_batch_source(yes, const FromT &from, size_t first, size_t,
+                              ET *) {
+  return from.ptr() + first;
+}
+template <class ET, class FromT>
+const ET *_index_batch_source(no, const FromT &from, size_t first, size_t n,
+                              ET *values) {
+  for (size_t j = 0; j < n; j++) {
+    values[j] = element_at_index(from, first + j);
+  }
+  return values;
+}
+
+template <class ViewT, class FromT>
+void _write_index_view(no, no, ViewT &to, const FromT &from) {
+  assign_elements(static_cast<tensor_core<ViewT> &>(to),
+                  static_cast<const tensor_core<FromT> &>(from));
+}
+template <class ViewT, class FromT>
+void _write_index_view(no, yes, ViewT &to, const FromT &from) {
+  _write_index_view(no(), no(), to, from);
+}
+// scatters run in order, so that later duplicates win as in the element-wise
+// path
+template <class FromContinuous, class ViewT, class FromT>
+void _write_index_view(yes, FromContinuous from_continuous, ViewT &to,
+                       const FromT &from) {
+  using to_ele_t = std::decay_t<decltype(*to.input_tensor.ptr())>;
+  using from_ele_t = std::conditional_t<FromContinuous::value,
+                                        typename FromT::value_type, to_ele_t>;
+  assert(to.shape() == from.shape());
+  const size_t n = numel_of(from);
+  auto *dst = to.input_tensor.ptr();
+  int64_t offsets[_index_batch_size];
+  std::unique_ptr<from_ele_t[]> values(
+      new from_ele_t[FromContinuous::value ? 0 : _index_batch_size]);
+  for (size_t begin = 0; begin < n; begin += _index_batch_size) {
+    const size_t len = std::min(_index_batch_size, n - begin);
+    auto *offs = _index_batch(to.index_tensor, begin, len, offsets);
+    const from_ele_t *src = _index_batch_source(from_continuous, from, begin,
+                                                len, values.get());
+    if (_is_unit_run(offs, len)) {
+      _copy_converted_n(src, len, dst + offs[0]);
+    } else {
+      _scatter_n(src, len, dst, offs);
+    }
+  }
+}
+}
+template <class ToET, class ToShapeT, class ToT, class ET, class ShapeT,
+          class IndexTensorT, class InputTensorT>
+void assign_elements(
+    tensor_continuous_data_base<ToET, ToShapeT, ToT> &to,
+    const index_view<ET, ShapeT, IndexTensorT, InputTensorT> &from) {
+  static_assert(ToShapeT::rank == ShapeT::rank, "shape ranks mismatch!");
+  detail::_assign_index_view(
+      decltype(detail::_is_continuous_data(from.input_tensor))(), to, from);
+}
+template <class ET, class ShapeT, class IndexTensorT, class InputTensorT,
+          class FromT>
+void assign_elements(index_view<ET, ShapeT, IndexTensorT, InputTensorT> &to,
+                     const tensor_core<FromT> &from) {
+  detail::_write_index_view(
+      decltype(detail::_is_continuous_data(to.input_tensor))(),
+      decltype(detail::_is_continuous_data(from.derived()))(), to,
+      from.derived());
+}
+template <class ET, class ShapeT, class IndexTensorT, class InputTensorT,
+          class CET, class CShapeT, class CT>
+void assign_elements(index_view<ET, ShapeT, IndexTensorT, InputTensorT> &to,
+                     const cached_result<CET, CShapeT, CT> &from) {
+  assign_elements(to, from.data());
+}
+
 // where
 template <class ShapeT, class BoolTensorT>
 inline vecx_<size_t>
 where(const tensor_base<bool, ShapeT, BoolTensorT> &flags) {
-  size_t nzc = nonzero_elements_count(flags.derived());
-  vecx_<size_t> inds(make_shape(nzc));
-  size_t c = 0;
-  for (size_t i = 0; i < flags.numel(); i++) {
-    if (element_at_index(flags.derived(), i)) {
-      element_at_index(inds, c++) = i;
-    }
-  }
-  return inds;
+  return compact_indices(flags);
+}
 }
-}
\ No newline at end of file
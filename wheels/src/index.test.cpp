@@ -17,4 +17,32 @@ TEST(tensor, index) {
   a[last - vecxi({0, 1})] = 5;
   ASSERT_TRUE(a == vecx({10, 2, 10, 5, 5}));
   println(a);
-}
\ No newline at end of file
+}
+TEST(tensor, index_gather) {
+  vecx_<float> a(make_shape(5000));
+  for (size_t i = 0; i < a.numel(); i++) {
+    a[i] = float(i) * 0.5f;
+  }
+  vecx_<int> inds(make_shape(3000));
+  for (size_t i = 0; i < inds.numel(); i++) {
+    inds[i] = i < 1000 ? int(i + 7) : int((i * 7919) % 5000);
+  }
+  vecx_<float> g = a[inds];
+  vecx_<double> gd(a[inds]);
+  for (size_t i = 0; i < inds.numel(); i++) {
+    ASSERT_EQ(g[i], a[inds[i]]);
+    ASSERT_EQ(gd[i], double(a[inds[i]]));
+  }
+
+  auto b = a.eval();
+  b[inds] = g.ewised() + 1.0f;
+  for (size_t i = 0; i < inds.numel(); i++) {
+    ASSERT_EQ(b[inds[i]], a[inds[i]] + 1.0f);
+  }
+
+  // later duplicates win
+  vecx_<int> dup({1, 3, 1});
+  b[dup] = vecx_<float>({10, 20, 30});
+  ASSERT_EQ(b[1], 30.0f);
+  ASSERT_EQ(b[3], 20.0f);
+}
@@ -0,0 +1,388 @@
+/* * *
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Hao Yang (yangh2007@gmail.com)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * */
+
+#pragma once
+
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "macros.hpp"
+#include "storage.hpp"
+#include "tensor_view_base.hpp"
+
+#include "mapped_file_fwd.hpp"
+
+namespace wheels {
+
+// mapped_file_storage
+// - owns a mapping of [offset, offset + length) of a file, length = -1 maps up
+//   to the end of the file
+// - the mapping starts at the page (allocation granularity on windows) below
+//   offset, data() points at offset itself
+// - the file handles are closed once mapped, the mapping keeps the file alive
+// - huge_pages is a hint, it is ignored where the system can not back file
+//   pages with huge pages
+class mapped_file_storage {
+public:
+  mapped_file_storage() noexcept
+      : _base(nullptr), _mapped(0), _data(nullptr), _size(0),
+        _mode(file_map_mode::read_only) {}
+  explicit mapped_file_storage(const std::string &path,
+                               file_map_mode mode = file_map_mode::read_only,
+                               file_map_advice advice = file_map_advice::normal,
+                               bool huge_pages = false, size_t offset = 0,
+                               size_t length = size_t(-1))
+      : mapped_file_storage() {
+    _mode = mode;
+    _open(path, offset, length);
+    if (_mapped != 0) {
+      if (huge_pages) {
+        _advise_huge_pages();
+      }
+      advise(advice);
+    }
+  }
+  ~mapped_file_storage() { _unmap(); }
+
+  mapped_file_storage(mapped_file_storage &&m) noexcept
+      : _base(m._base), _mapped(m._mapped), _data(m._data), _size(m._size),
+        _mode(m._mode) {
+    m._base = m._data = nullptr;
+    m._mapped = m._size = 0;
+  }
+  mapped_file_storage &operator=(mapped_file_storage &&m) noexcept {
+    if (this != &m) {
+      _unmap();
+      _base = m._base;
+      _mapped = m._mapped;
+      _data = m._data;
+      _size = m._size;
+      _mode = m._mode;
+      m._base = m._data = nullptr;
+      m._mapped = m._size = 0;
+    }
+    return *this;
+  }
+  mapped_file_storage(const mapped_file_storage &) = delete;
+  mapped_file_storage &operator=(const mapped_file_storage &) = delete;
+
+  const void *data() const { return _data; }
+  void *data() { return _data; }
+  size_t size() const { return _size; }
+  file_map_mode mode() const { return _mode; }
+
+  // advise
+  // - tells the system how the pages are going to be accessed, may be called
+  //   again between phases of different access patterns
+  void advise(file_map_advice advice) const {
+    if (_mapped == 0) {
+      return;
+    }
+#if defined(_WIN32)
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+    if (advice == file_map_advice::willneed) {
+      WIN32_MEMORY_RANGE_ENTRY range = {_base, _mapped};
+      PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#else
+    (void)advice;
+#endif
+#else
+    int a = MADV_NORMAL;
+    switch (advice) {
+    case file_map_advice::sequential:
+      a = MADV_SEQUENTIAL;
+      break;
+    case file_map_advice::random:
+      a = MADV_RANDOM;
+      break;
+    case file_map_advice::willneed:
+      a = MADV_WILLNEED;
+      break;
+    default:
+      break;
+    }
+    ::madvise(_base, _mapped, a);
+#endif
+  }
+
+  // flush
+  // - writes dirty pages of a read_write mapping back to the file
+  void flush() {
+    if (_mapped == 0 || _mode != file_map_mode::read_write) {
+      return;
+    }
+#if defined(_WIN32)
+    if (!FlushViewOfFile(_base, _mapped)) {
+      wheels_throw(std::system_error(int(GetLastError()),
+                                     std::system_category(),
+                                     "FlushViewOfFile"));
+    }
+#else
+    if (::msync(_base, _mapped, MS_SYNC) != 0) {
+      wheels_throw(
+          std::system_error(errno, std::system_category(), "msync"));
+    }
+#endif
+  }
+
+private:
+#if defined(_WIN32)
+  void _open(const std::string &path, size_t offset, size_t length) {
+    const bool writable = _mode == file_map_mode::read_write;
+    HANDLE file = CreateFileA(
+        path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+        FILE_SHARE_READ | (writable ? 0 : FILE_SHARE_WRITE), nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      wheels_throw(std::system_error(int(GetLastError()),
+                                     std::system_category(), path));
+      return;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+      const int err = int(GetLastError());
+      CloseHandle(file);
+      wheels_throw(std::system_error(err, std::system_category(), path));
+      return;
+    }
+    _size = _clamp_length(size_t(file_size.QuadPart), offset, length, path);
+    if (_size == 0) {
+      CloseHandle(file);
+      return;
+    }
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const size_t begin = offset - offset % info.dwAllocationGranularity;
+    _mapped = offset - begin + _size;
+
+    const DWORD protect = _mode == file_map_mode::read_only
+                              ? PAGE_READONLY
+                              : _mode == file_map_mode::copy_on_write
+                                    ? PAGE_WRITECOPY
+                                    : PAGE_READWRITE;
+    const DWORD access = _mode == file_map_mode::read_only
+                             ? FILE_MAP_READ
+                             : _mode == file_map_mode::copy_on_write
+                                   ? FILE_MAP_COPY
+                                   : FILE_MAP_WRITE;
+    HANDLE mapping = CreateFileMappingA(file, nullptr, protect, 0, 0, nullptr);
+    const int map_err = mapping ? 0 : int(GetLastError());
+    CloseHandle(file);
+    if (!mapping) {
+      _mapped = _size = 0;
+      wheels_throw(std::system_error(map_err, std::system_category(), path));
+      return;
+    }
+    const unsigned long long b = begin;
+    _base = MapViewOfFile(mapping, access, DWORD(b >> 32),
+                          DWORD(b & 0xffffffffull), _mapped);
+    const int view_err = _base ? 0 : int(GetLastError());
+    CloseHandle(mapping);
+    if (!_base) {
+      _mapped = _size = 0;
+      wheels_throw(std::system_error(view_err, std::system_category(), path));
+      return;
+    }
+    _data = static_cast<char *>(_base) + (offset - begin);
+  }
+  void _advise_huge_pages() const {}
+  void _unmap() noexcept {
+    if (_base) {
+      UnmapViewOfFile(_base);
+    }
+    _base = _data = nullptr;
+    _mapped = _size = 0;
+  }
+#else
+  void _open(const std::string &path, size_t offset, size_t length) {
+    const int fd = ::open(path.c_str(), _mode == file_map_mode::read_write
+                                            ? O_RDWR
+                                            : O_RDONLY);
+    if (fd < 0) {
+      wheels_throw(std::system_error(errno, std::system_category(), path));
+      return;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      const int err = errno;
+      ::close(fd);
+      wheels_throw(std::system_error(err, std::system_category(), path));
+      return;
+    }
+    _size = _clamp_length(size_t(st.st_size), offset, length, path);
+    if (_size == 0) {
+      ::close(fd);
+      return;
+    }
+    const size_t page = size_t(::sysconf(_SC_PAGESIZE));
+    const size_t begin = offset - offset % page;
+    _mapped = offset - begin + _size;
+
+    const int prot = _mode == file_map_mode::read_only
+                         ? PROT_READ
+                         : PROT_READ | PROT_WRITE;
+    const int flags =
+        _mode == file_map_mode::read_write ? MAP_SHARED : MAP_PRIVATE;
+    void *p = ::mmap(nullptr, _mapped, prot, flags, fd, off_t(begin));
+    const int err = errno;
+    ::close(fd);
+    if (p == MAP_FAILED) {
+      _mapped = _size = 0;
+      wheels_throw(std::system_error(err, std::system_category(), path));
+      return;
+    }
+    _base = p;
+    _data = static_cast<char *>(_base) + (offset - begin);
+  }
+  void _advise_huge_pages() const {
+#if defined(MADV_HUGEPAGE)
+    ::madvise(_base, _mapped, MADV_HUGEPAGE);
+#endif
+  }
+  void _unmap() noexcept {
+    if (_base) {
+      ::munmap(_base, _mapped);
+    }
+    _base = _data = nullptr;
+    _mapped = _size = 0;
+  }
+#endif
+
+  static size_t _clamp_length(size_t file_size, size_t offset, size_t length,
+                              const std::string &path) {
+    if (offset > file_size) {
+      wheels_throw(std::out_of_range("offset beyond the end of " + path));
+      return 0;
+    }
+    if (length == size_t(-1)) {
+      return file_size - offset;
+    }
+    if (length > file_size - offset) {
+      wheels_throw(std::out_of_range("range beyond the end of " + path));
+      return 0;
+    }
+    return length;
+  }
+
+private:
+  void *_base;
+  size_t _mapped;
+  void *_data;
+  size_t _size;
+  file_map_mode _mode;
+};
+
+// mapped_tensor
+// - a tensor_map over a mapped_file_storage, which it owns
+template <class ET, class ShapeT>
+class mapped_tensor
+    : public tensor_view_base<std::decay_t<ET>, ShapeT,
+                              mapped_tensor<ET, ShapeT>, true> {
+  using _base_t = tensor_view_base<std::decay_t<ET>, ShapeT,
+                                   mapped_tensor<ET, ShapeT>, true>;
+  static_assert(std::is_trivially_copyable<std::decay_t<ET>>::value,
+                "only trivially copyable elements can be mapped from files");
+
+public:
+  using shape_type = ShapeT;
+  using value_type = std::decay_t<ET>;
+
+public:
+  mapped_tensor() : _file(), _storage() {}
+  mapped_tensor(const shape_type &s, mapped_file_storage &&file)
+      : _file(std::move(file)), _storage(s, static_cast<ET *>(_file.data())) {
+    assert(s.magnitude() * sizeof(ET) <= _file.size());
+  }
+
+public:
+  mapped_tensor(const mapped_tensor &) = delete;
+  mapped_tensor(mapped_tensor &&) = default;
+  mapped_tensor &operator=(const mapped_tensor &) = delete;
+  mapped_tensor &operator=(mapped_tensor &&) = default;
+
+  constexpr const ET *ptr() const { return _storage.data(); }
+  ET *ptr() { return _storage.data(); }
+  constexpr decltype(auto) shape() const { return _storage.shape(); }
+
+  const mapped_file_storage &file() const { return _file; }
+  mapped_file_storage &file() { return _file; }
+
+  using _base_t::operator=;
+  using _base_t::operator+=;
+  using _base_t::operator-=;
+  using _base_t::operator*=;
+  using _base_t::operator/=;
+
+private:
+  mapped_file_storage _file;
+  map_storage<ET, shape_type> _storage;
+};
+
+// ptr_of
+template <class ET, class ShapeT>
+constexpr auto ptr_of(const mapped_tensor<ET, ShapeT> &t) {
+  return t.ptr();
+}
+template <class ET, class ShapeT>
+constexpr auto ptr_of(mapped_tensor<ET, ShapeT> &t) {
+  return t.ptr();
+}
+
+// shape_of
+template <class ET, class ShapeT>
+constexpr decltype(auto) shape_of(const mapped_tensor<ET, ShapeT> &t) {
+  return t.shape();
+}
+
+// map_file
+// - maps shape.magnitude() elements starting at byte offset of the file
+template <class ET, class ST, class... SizeTs>
+auto map_file(const std::string &path, const tensor_shape<ST, SizeTs...> &shape,
+              file_map_mode mode, file_map_advice advice, bool huge_pages,
+              size_t offset) {
+  if (mode == file_map_mode::read_only && !std::is_const<ET>::value) {
+    wheels_throw(std::invalid_argument(
+        "read_only mappings need a const element type"));
+  }
+  return mapped_tensor<ET, tensor_shape<ST, SizeTs...>>(
+      shape,
+      mapped_file_storage(path, mode, advice, huge_pages, offset,
+                          size_t(shape.magnitude()) * sizeof(ET)));
+}
+}
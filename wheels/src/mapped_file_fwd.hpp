@@ -0,0 +1,56 @@
+/* * *
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Hao Yang (yangh2007@gmail.com)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+#include "tensor_base_fwd.hpp"
+
+namespace wheels {
+// file_map_mode
+// - read_only: pages are mapped read-only, the element type must be const
+// - copy_on_write: writes go to private copies of the touched pages and never
+//   reach the file
+// - read_write: writes are shared with the file
+enum class file_map_mode { read_only, copy_on_write, read_write };
+
+// file_map_advice
+enum class file_map_advice { normal, sequential, random, willneed };
+
+class mapped_file_storage;
+
+template <class ET, class ShapeT> class mapped_tensor;
+
+// map_file
+template <class ET, class ST, class... SizeTs>
+auto map_file(const std::string &path, const tensor_shape<ST, SizeTs...> &shape,
+              file_map_mode mode = std::is_const<ET>::value
+                                       ? file_map_mode::read_only
+                                       : file_map_mode::copy_on_write,
+              file_map_advice advice = file_map_advice::normal,
+              bool huge_pages = false, size_t offset = 0);
+}
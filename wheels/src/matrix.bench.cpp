@@ -0,0 +1,134 @@
+#include <benchmark/benchmark.h>
+#include <numeric>
+
+#include "matrix.hpp"
+#include "permute.hpp"
+#include "tensor.hpp"
+
+using namespace wheels;
+
+// matrix_mul_result
+template <class T> static void matrix_mul_dynamic(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx_<T> a(make_shape(n, n), T(1)), b(make_shape(n, n), T(2)),
+      c(make_shape(n, n));
+  for (auto _ : state) {
+    c = a * b;
+    benchmark::ClobberMemory();
+  }
+  state.counters["flops"] = benchmark::Counter(
+      2.0 * n * n * n * state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK_TEMPLATE(matrix_mul_dynamic, float)->RangeMultiplier(2)->Range(4, 1024);
+BENCHMARK_TEMPLATE(matrix_mul_dynamic, double)
+    ->RangeMultiplier(2)
+    ->Range(4, 1024);
+
+static void matrix_mul_static(benchmark::State &state) {
+  mat4 a, b, c;
+  std::fill(a.ptr(), a.ptr() + 16, 1.0);
+  std::fill(b.ptr(), b.ptr() + 16, 2.0);
+  for (auto _ : state) {
+    c = a * b;
+    benchmark::DoNotOptimize(c.ptr());
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(matrix_mul_static);
+
+// matrix * vector
+static void matrix_mul_vec_dynamic(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx a(make_shape(n, n), 1.0);
+  vecx x(make_shape(n), 2.0), y(make_shape(n));
+  for (auto _ : state) {
+    y = a * x;
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * n * n * sizeof(double));
+}
+BENCHMARK(matrix_mul_vec_dynamic)->RangeMultiplier(4)->Range(4, 8192);
+
+// small static matrices
+template <class T> static void matrix_mul_static4(benchmark::State &state) {
+  mat_<T, 4, 4> a, b, c;
+  std::fill(a.ptr(), a.ptr() + 16, T(1));
+  std::fill(b.ptr(), b.ptr() + 16, T(2));
+  for (auto _ : state) {
+    c = a * b;
+    benchmark::DoNotOptimize(c.ptr());
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK_TEMPLATE(matrix_mul_static4, float);
+BENCHMARK_TEMPLATE(matrix_mul_static4, double);
+
+template <class T> static void matrix_mul_vec_static4(benchmark::State &state) {
+  mat_<T, 4, 4> a;
+  vec_<T, 4> x, y;
+  std::fill(a.ptr(), a.ptr() + 16, T(1));
+  std::fill(x.ptr(), x.ptr() + 4, T(2));
+  for (auto _ : state) {
+    y = a * x;
+    benchmark::DoNotOptimize(y.ptr());
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK_TEMPLATE(matrix_mul_vec_static4, float);
+BENCHMARK_TEMPLATE(matrix_mul_vec_static4, double);
+
+static void matrix_transpose_static4(benchmark::State &state) {
+  mat4 a, b;
+  std::iota(a.ptr(), a.ptr() + 16, 0.0);
+  for (auto _ : state) {
+    b = a.t();
+    benchmark::DoNotOptimize(b.ptr());
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(matrix_transpose_static4);
+
+static void matrix_ewise_static4(benchmark::State &state) {
+  mat4 a, b, c;
+  std::fill(a.ptr(), a.ptr() + 16, 1.0);
+  std::fill(b.ptr(), b.ptr() + 16, 2.0);
+  for (auto _ : state) {
+    c = a + b * 2.0;
+    benchmark::DoNotOptimize(c.ptr());
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(matrix_ewise_static4);
+
+// small static inverses
+template <class T> static void matrix_inverse_static4(benchmark::State &state) {
+  mat_<T, 4, 4> a, b;
+  std::iota(a.ptr(), a.ptr() + 16, T(1));
+  a(0, 0) = T(20);
+  a(2, 1) = T(-3);
+  for (auto _ : state) {
+    b = inverse(a);
+    benchmark::DoNotOptimize(b.ptr());
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK_TEMPLATE(matrix_inverse_static4, float);
+BENCHMARK_TEMPLATE(matrix_inverse_static4, double);
+
+template <class T> static void matrix_inverse_each4(benchmark::State &state) {
+  const size_t n = state.range(0);
+  tensor<T, tensor_shape<size_t, size_t, const_size<4>, const_size<4>>> ms(
+      make_shape(n, const_size<4>(), const_size<4>()));
+  std::iota(ms.ptr(), ms.ptr() + ms.numel(), T(1));
+  for (auto _ : state) {
+    auto inv = inverse_each(ms);
+    benchmark::DoNotOptimize(inv.ptr());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(matrix_inverse_each4, float)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 15);
+BENCHMARK_TEMPLATE(matrix_inverse_each4, double)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 15);
@@ -26,10 +26,12 @@
 
 #include "tensor_base.hpp"
 #include "block.hpp"
+#include "cache.hpp"
 #include "constants.hpp"
 #include "ewise.hpp"
 #include "iota.hpp"
 #include "tensor.hpp"
+#include "gemm.hpp"
 
 #include "matrix_fwd.hpp"
 
@@ -239,6 +241,30 @@ public:
   decltype(auto) a() { return ::wheels::element_at(this->derived(), 0, 3); }
 };
 
+// _sum_of_products(k, prod)
+// - prod(0) + prod(1) + ... + prod(k - 1), unrolled when k is static
+namespace detail {
+template <class EleT, class ProdT>
+EleT _sum_of_products(size_t k, const ProdT &prod) {
+  EleT result = types<EleT>::zero();
+  for (size_t i = 0; i < k; i++) {
+    result += prod(i);
+  }
+  return result;
+}
+template <class EleT, class K, class ProdT>
+EleT _sum_of_products(const const_ints<K, 0> &, const ProdT &) {
+  return types<EleT>::zero();
+}
+template <class EleT, class K, K N, class ProdT>
+EleT _sum_of_products(const const_ints<K, N> &, const ProdT &prod) {
+  EleT result = prod(size_t(0));
+  for_each(make_const_range(const_size<1>(), const_size<(size_t)N>()),
+           [&result, &prod](auto i) { result += prod(decltype(i)::value); });
+  return result;
+}
+}
+
 // matrix * matrix -> matrix
 template <class EleT, class ShapeT, class A, class B>
 class matrix_mul_result<EleT, ShapeT, A, B, true, true>
@@ -249,17 +275,18 @@ public:
   using shape_type = ShapeT;
   constexpr matrix_mul_result(A &&aa, B &&bb)
       : _a(std::forward<A>(aa)), _b(std::forward<B>(bb)) {}
+  constexpr const std::decay_t<A> &input1() const { return _a; }
+  constexpr const std::decay_t<B> &input2() const { return _b; }
   constexpr auto shape() const {
     return make_shape(size_at(_a, const_index<0>()),
                       size_at(_b, const_index<1>()));
   }
   template <class SubT1, class SubT2>
   decltype(auto) at_subs(const SubT1 &s1, const SubT2 &s2) const {
-    EleT result = types<EleT>::zero();
-    for (size_t i = 0; i < size_at(_a, const_index<1>()); i++) {
-      result += element_at(_a, s1, i) * element_at(_b, i, s2);
-    }
-    return result;
+    return detail::_sum_of_products<EleT>(
+        size_at(_a, const_index<1>()), [this, &s1, &s2](size_t i) {
+          return element_at(_a, s1, i) * element_at(_b, i, s2);
+        });
   }
 
 private:
@@ -277,15 +304,16 @@ public:
   using shape_type = ShapeT;
   constexpr matrix_mul_result(A &&aa, B &&bb)
       : _a(std::forward<A>(aa)), _b(std::forward<B>(bb)) {}
+  constexpr const std::decay_t<A> &input1() const { return _a; }
+  constexpr const std::decay_t<B> &input2() const { return _b; }
   constexpr auto shape() const {
     return make_shape(size_at(_a, const_index<0>()));
   }
   template <class SubT> decltype(auto) at_subs(const SubT &s) const {
-    EleT result = types<EleT>::zero();
-    for (size_t i = 0; i < size_at(_a, const_index<1>()); i++) {
-      result += element_at(_a, s, i) * element_at(_b, i);
-    }
-    return result;
+    return detail::_sum_of_products<EleT>(
+        size_at(_a, const_index<1>()), [this, &s](size_t i) {
+          return element_at(_a, s, i) * element_at(_b, i);
+        });
   }
 
 private:
@@ -303,15 +331,16 @@ public:
   using shape_type = ShapeT;
   constexpr matrix_mul_result(A &&aa, B &&bb)
       : _a(std::forward<A>(aa)), _b(std::forward<B>(bb)) {}
+  constexpr const std::decay_t<A> &input1() const { return _a; }
+  constexpr const std::decay_t<B> &input2() const { return _b; }
   constexpr auto shape() const {
     return make_shape(size_at(_b, const_index<1>()));
   }
   template <class SubT> decltype(auto) at_subs(const SubT &s) const {
-    EleT result = types<EleT>::zero();
-    for (size_t i = 0; i < size_at(_a, const_index<0>()); i++) {
-      result += element_at(_a, i) * element_at(_b, i, s);
-    }
-    return result;
+    return detail::_sum_of_products<EleT>(
+        size_at(_a, const_index<0>()), [this, &s](size_t i) {
+          return element_at(_a, i) * element_at(_b, i, s);
+        });
   }
 
 private:
@@ -341,6 +370,253 @@ element_at(const matrix_mul_result<EleT, ShapeT, A, B, AIsMat, BIsMat> &m,
   return m.at_subs(subs...);
 }
 
+// _is_super_linear
+// - each element of a product costs a dot product
+namespace detail {
+template <class EleT, class ShapeT, class A, class B, bool AIsMat, bool BIsMat>
+constexpr yes _is_super_linear(
+    _cache_tag, const matrix_mul_result<EleT, ShapeT, A, B, AIsMat, BIsMat> &) {
+  return yes();
+}
+template <class EleT, class ShapeT, class A, class B, bool AIsMat, bool BIsMat>
+auto _cache_super_linear(
+    _cache_tag,
+    const matrix_mul_result<EleT, ShapeT, A, B, AIsMat, BIsMat> &m) {
+  return m.eval();
+}
+}
+
+// assign_elements(to, matrix * matrix)
+// - products of continuous operands of the same arithmetic type are
+//   evaluated by gemm(), others element by element, bool is left to the
+//   element path whose accumulation is a logical or
+// - operands without continuous data (e.g. another product) are materialized
+//   first when the product is large enough for gemm(), since every operand
+//   element is read once per row or column of the result
+namespace detail {
+static constexpr size_t _gemm_min_volume = 16 * 16 * 16;
+template <class ET>
+struct _is_gemm_element
+    : const_bool<std::is_arithmetic<ET>::value &&
+                 !std::is_same<ET, bool>::value> {};
+
+template <class IsContinuousT, class ET, class ShapeT, class T, class MulT>
+void _assign_matrix_mul_result(no, IsContinuousT,
+                               tensor_continuous_data_base<ET, ShapeT, T> &to,
+                               const MulT &from) {
+  assign_elements(static_cast<tensor_core<T> &>(to),
+                  static_cast<const tensor_core<MulT> &>(from));
+}
+template <class ET, class ShapeT, class T, class MulT>
+void _assign_matrix_mul_result(yes, no,
+                               tensor_continuous_data_base<ET, ShapeT, T> &to,
+                               const MulT &from) {
+  const auto &a = from.input1();
+  const auto &b = from.input2();
+  if (size_t(a.rows()) * size_t(a.cols()) * size_t(b.cols()) <
+      _gemm_min_volume) {
+    _assign_matrix_mul_result(no(), no(), to, from);
+    return;
+  }
+  assign_elements(to, make_matrix_mul_result<typename MulT::value_type,
+                                             typename MulT::shape_type, true,
+                                             true>(materialize(a),
+                                                   materialize(b)));
+}
+template <class ET, class ShapeT, class T, class MulT>
+void _assign_matrix_mul_result(yes, yes,
+                               tensor_continuous_data_base<ET, ShapeT, T> &to,
+                               const MulT &from) {
+  const auto &a = from.input1();
+  const auto &b = from.input2();
+  const size_t m = a.rows(), k = a.cols(), n = b.cols();
+  if (m * n * k < _gemm_min_volume) {
+    _assign_matrix_mul_result(no(), no(), to, from);
+    return;
+  }
+  decltype(auto) s = from.shape();
+  if (to.shape() != s) {
+    reserve_shape(to.derived(), s);
+  }
+  const ET *pa = a.ptr();
+  const ET *pb = b.ptr();
+  ET *pc = to.ptr();
+  auto overlaps = [pc, m, n](const ET *p, size_t len) {
+    return p < pc + m * n && pc < p + len;
+  };
+  if (overlaps(pa, m * k) || overlaps(pb, k * n)) {
+    tensor<ET, tensor_shape<size_t, size_t, size_t>> result(make_shape(m, n));
+    gemm(m, n, k, pa, k, pb, n, result.ptr(), n);
+    std::copy(result.ptr(), result.ptr() + m * n, pc);
+  } else {
+    gemm(m, n, k, pa, k, pb, n, pc, n);
+  }
+}
+}
+// small static products
+// - products of continuous operands whose shapes are small and static (see
+//   _is_small_static_shape) are unrolled into straight-line code over raw
+//   pointers, a vector operand is seen as a 1 x k or k x 1 matrix
+// - when a row of the result spans whole simd_packs, each pack of it is
+//   accumulated from the rows of the right operand with broadcast fmas
+// - when the result is a column (matrix * vector) and the rows of the left
+//   operand span whole simd_packs, each element is a packed dot product
+//   finished by a horizontal add
+// - otherwise each element is an unrolled scalar dot product
+// - the result goes through a local buffer so that the target may alias
+//   an operand
+namespace detail {
+struct _small_mul_scalar {};
+struct _small_mul_rows {};
+struct _small_mul_dots {};
+template <class ET, size_t M, size_t K, size_t N>
+using _small_mul_kernel_t = std::conditional_t<
+    (simd_pack<ET>::size > 1 && N % simd_pack<ET>::size == 0),
+    _small_mul_rows,
+    std::conditional_t<(simd_pack<ET>::size > 1 && N == 1 &&
+                        K % simd_pack<ET>::size == 0),
+                       _small_mul_dots, _small_mul_scalar>>;
+
+template <size_t M, size_t K, size_t N, class ET>
+void _small_matrix_mul(const ET *a, const ET *b, ET *c, _small_mul_scalar) {
+  for_each(make_const_sequence(const_size<M * N>()), [a, b, c](auto ij) {
+    constexpr size_t i = decltype(ij)::value / N, j = decltype(ij)::value % N;
+    ET r = a[i * K] * b[j];
+    for_each(make_const_range(const_size<1>(), const_size<K>()),
+             [a, b, &r](auto kk) {
+               constexpr size_t k = decltype(kk)::value;
+               r += a[i * K + k] * b[k * N + j];
+             });
+    c[i * N + j] = r;
+  });
+}
+template <size_t M, size_t K, size_t N, class ET>
+void _small_matrix_mul(const ET *a, const ET *b, ET *c, _small_mul_rows) {
+  using pack = simd_pack<ET>;
+  constexpr size_t w = pack::size;
+  // the i-th row, j-th pack of c
+  for_each(make_const_sequence(const_size<M * N / w>()), [a, b, c](auto ij) {
+    constexpr size_t i = decltype(ij)::value / (N / w),
+                     j = decltype(ij)::value % (N / w) * w;
+    auto r = pack::mul(pack::set1(a[i * K]), pack::load(b + j));
+    for_each(make_const_range(const_size<1>(), const_size<K>()),
+             [a, b, &r](auto kk) {
+               constexpr size_t k = decltype(kk)::value;
+               r = pack::fma(pack::set1(a[i * K + k]),
+                             pack::load(b + k * N + j), r);
+             });
+    pack::store(c + i * N + j, r);
+  });
+}
+template <size_t M, size_t K, size_t N, class ET>
+void _small_matrix_mul(const ET *a, const ET *b, ET *c, _small_mul_dots) {
+  using pack = simd_pack<ET>;
+  constexpr size_t w = pack::size;
+  for_each(make_const_sequence(const_size<M>()), [a, b, c](auto ii) {
+    constexpr size_t i = decltype(ii)::value;
+    auto r = pack::mul(pack::load(a + i * K), pack::load(b));
+    for_each(make_const_range(const_size<1>(), const_size<K / w>()),
+             [a, b, &r](auto kk) {
+               constexpr size_t k = decltype(kk)::value * w;
+               r = pack::fma(pack::load(a + i * K + k), pack::load(b + k), r);
+             });
+    c[i] = pack::sum(r);
+  });
+}
+
+// _small_mul_dims
+template <class AShapeT, class BShapeT, bool AIsMat, bool BIsMat>
+struct _small_mul_dims {};
+template <class T1, T1 M, T1 K, class T2, T2 K2, T2 N>
+struct _small_mul_dims<tensor_shape<T1, const_ints<T1, M>, const_ints<T1, K>>,
+                       tensor_shape<T2, const_ints<T2, K2>, const_ints<T2, N>>,
+                       true, true> {
+  static constexpr size_t m = M, k = K, n = N;
+};
+template <class T1, T1 M, T1 K, class T2, T2 K2>
+struct _small_mul_dims<tensor_shape<T1, const_ints<T1, M>, const_ints<T1, K>>,
+                       tensor_shape<T2, const_ints<T2, K2>>, true, false> {
+  static constexpr size_t m = M, k = K, n = 1;
+};
+template <class T1, T1 K, class T2, T2 K2, T2 N>
+struct _small_mul_dims<tensor_shape<T1, const_ints<T1, K>>,
+                       tensor_shape<T2, const_ints<T2, K2>, const_ints<T2, N>>,
+                       false, true> {
+  static constexpr size_t m = 1, k = K, n = N;
+};
+
+// _is_small_matrix_mul
+template <class ET, class MulT> struct _is_small_matrix_mul : no {};
+template <class ET, class EleT, class ShapeT, class A, class B, bool AIsMat,
+          bool BIsMat>
+struct _is_small_matrix_mul<ET,
+                            matrix_mul_result<EleT, ShapeT, A, B, AIsMat, BIsMat>>
+    : const_bool<
+          _is_gemm_element<ET>::value && std::is_same<ET, EleT>::value &&
+          std::is_same<ET, typename std::decay_t<A>::value_type>::value &&
+          std::is_same<ET, typename std::decay_t<B>::value_type>::value &&
+          decltype(_is_continuous_data(
+              std::declval<const std::decay_t<A> &>()))::value &&
+          decltype(_is_continuous_data(
+              std::declval<const std::decay_t<B> &>()))::value &&
+          _is_small_static_shape<typename std::decay_t<A>::shape_type>::value &&
+          _is_small_static_shape<typename std::decay_t<B>::shape_type>::value> {
+};
+
+template <class ET, class ShapeT, class T, class EleT, class MulShapeT,
+          class A, class B, bool AIsMat, bool BIsMat>
+void _assign_small_matrix_mul_result(
+    yes, tensor_continuous_data_base<ET, ShapeT, T> &to,
+    const matrix_mul_result<EleT, MulShapeT, A, B, AIsMat, BIsMat> &from) {
+  using dims_t =
+      _small_mul_dims<typename std::decay_t<A>::shape_type,
+                      typename std::decay_t<B>::shape_type, AIsMat, BIsMat>;
+  constexpr size_t m = dims_t::m, k = dims_t::k, n = dims_t::n;
+  ET c[m * n];
+  _small_matrix_mul<m, k, n>(from.input1().ptr(), from.input2().ptr(), c,
+                             _small_mul_kernel_t<ET, m, k, n>());
+  decltype(auto) s = from.shape();
+  if (to.shape() != s) {
+    reserve_shape(to.derived(), s);
+  }
+  std::copy_n(c, m * n, to.ptr());
+}
+template <class ET, class ShapeT, class T, class EleT, class MulShapeT,
+          class A, class B>
+void _assign_small_matrix_mul_result(
+    no, tensor_continuous_data_base<ET, ShapeT, T> &to,
+    const matrix_mul_result<EleT, MulShapeT, A, B, true, true> &from) {
+  using a_t = std::decay_t<A>;
+  using b_t = std::decay_t<B>;
+  using use_gemm_t =
+      const_bool<_is_gemm_element<ET>::value && std::is_same<ET, EleT>::value &&
+                 std::is_same<ET, typename a_t::value_type>::value &&
+                 std::is_same<ET, typename b_t::value_type>::value>;
+  using is_continuous_t = const_bool<
+      decltype(_is_continuous_data(std::declval<const a_t &>()))::value &&
+      decltype(_is_continuous_data(std::declval<const b_t &>()))::value>;
+  _assign_matrix_mul_result(use_gemm_t(), is_continuous_t(), to, from);
+}
+template <class ET, class ShapeT, class T, class EleT, class MulShapeT,
+          class A, class B, bool AIsMat, bool BIsMat>
+void _assign_small_matrix_mul_result(
+    no, tensor_continuous_data_base<ET, ShapeT, T> &to,
+    const matrix_mul_result<EleT, MulShapeT, A, B, AIsMat, BIsMat> &from) {
+  using mul_t = matrix_mul_result<EleT, MulShapeT, A, B, AIsMat, BIsMat>;
+  assign_elements(static_cast<tensor_core<T> &>(to),
+                  static_cast<const tensor_core<mul_t> &>(from));
+}
+}
+template <class ET, class ShapeT, class T, class EleT, class MulShapeT,
+          class A, class B, bool AIsMat, bool BIsMat>
+void assign_elements(
+    tensor_continuous_data_base<ET, ShapeT, T> &to,
+    const matrix_mul_result<EleT, MulShapeT, A, B, AIsMat, BIsMat> &from) {
+  using mul_t = matrix_mul_result<EleT, MulShapeT, A, B, AIsMat, BIsMat>;
+  detail::_assign_small_matrix_mul_result(
+      const_bool<detail::_is_small_matrix_mul<ET, mul_t>::value>(), to, from);
+}
+
 template <class ST1, class MT1, class NT1, class E1, class T1, class ST2,
           class MT2, class NT2, class E2, class T2>
 auto overload_as(const func_base<binary_op_mul> &,
@@ -381,6 +657,334 @@ auto overload_as(const func_base<binary_op_mul> &,
   };
 }
 
+// det(m), inverse(m), solve(a, b)
+// - closed forms for small static square matrices, without lapack and
+//   without heap allocations: the inverse is the adjugate over the
+//   determinant, a 4 x 4 matrix is expanded over the 2 x 2 minors of its
+//   upper (s) and lower (c) row pairs
+// - the formulas are written once on an arithmetic policy OpsT (set1, add,
+//   sub, mul, div), either _scalar_ops for a single matrix or a simd_pack
+//   whose lanes carry different matrices (see inverse_each)
+namespace detail {
+template <class T> struct _scalar_ops {
+  using value_type = T;
+  using type = T;
+  static T set1(const T &v) { return v; }
+  static T add(const T &a, const T &b) { return a + b; }
+  static T sub(const T &a, const T &b) { return a - b; }
+  static T mul(const T &a, const T &b) { return a * b; }
+  static T div(const T &a, const T &b) { return a / b; }
+};
+
+// a * b - c * d
+template <class OpsT, class V>
+V _dp(const V &a, const V &b, const V &c, const V &d) {
+  return OpsT::sub(OpsT::mul(a, b), OpsT::mul(c, d));
+}
+// a * b - c * d + e * f
+template <class OpsT, class V>
+V _tp(const V &a, const V &b, const V &c, const V &d, const V &e,
+      const V &f) {
+  return OpsT::add(_dp<OpsT>(a, b, c, d), OpsT::mul(e, f));
+}
+
+// 2 x 2 minors of the upper and lower row pairs of a 4 x 4 matrix
+template <class OpsT, class V> void _small_minors4(const V *a, V *s, V *c) {
+  s[0] = _dp<OpsT>(a[0], a[5], a[4], a[1]);
+  s[1] = _dp<OpsT>(a[0], a[6], a[4], a[2]);
+  s[2] = _dp<OpsT>(a[0], a[7], a[4], a[3]);
+  s[3] = _dp<OpsT>(a[1], a[6], a[5], a[2]);
+  s[4] = _dp<OpsT>(a[1], a[7], a[5], a[3]);
+  s[5] = _dp<OpsT>(a[2], a[7], a[6], a[3]);
+  c[5] = _dp<OpsT>(a[10], a[15], a[14], a[11]);
+  c[4] = _dp<OpsT>(a[9], a[15], a[13], a[11]);
+  c[3] = _dp<OpsT>(a[9], a[14], a[13], a[10]);
+  c[2] = _dp<OpsT>(a[8], a[15], a[12], a[11]);
+  c[1] = _dp<OpsT>(a[8], a[14], a[12], a[10]);
+  c[0] = _dp<OpsT>(a[8], a[13], a[12], a[9]);
+}
+template <class OpsT, class V> V _small_det4(const V *s, const V *c) {
+  return OpsT::add(_tp<OpsT>(s[0], c[5], s[1], c[4], s[2], c[3]),
+                   _tp<OpsT>(s[3], c[2], s[4], c[1], s[5], c[0]));
+}
+
+// _small_det
+template <class OpsT, class V> V _small_det(const V *a, const const_size<1> &) {
+  return a[0];
+}
+template <class OpsT, class V> V _small_det(const V *a, const const_size<2> &) {
+  return _dp<OpsT>(a[0], a[3], a[1], a[2]);
+}
+template <class OpsT, class V> V _small_det(const V *a, const const_size<3> &) {
+  return _tp<OpsT>(a[0], _dp<OpsT>(a[4], a[8], a[5], a[7]), a[1],
+                   _dp<OpsT>(a[3], a[8], a[5], a[6]), a[2],
+                   _dp<OpsT>(a[3], a[7], a[4], a[6]));
+}
+template <class OpsT, class V> V _small_det(const V *a, const const_size<4> &) {
+  V s[6], c[6];
+  _small_minors4<OpsT>(a, s, c);
+  return _small_det4<OpsT>(s, c);
+}
+
+// _small_adjugate_minors
+// - m[i * N + j] = minor of a at (j, i), the adjugate without its
+//   checkerboard signs, returns det(a)
+template <class OpsT, class V>
+V _small_adjugate_minors(const V *a, V *m, const const_size<1> &) {
+  m[0] = OpsT::set1(1);
+  return a[0];
+}
+template <class OpsT, class V>
+V _small_adjugate_minors(const V *a, V *m, const const_size<2> &) {
+  m[0] = a[3];
+  m[1] = a[1];
+  m[2] = a[2];
+  m[3] = a[0];
+  return _dp<OpsT>(a[0], a[3], a[1], a[2]);
+}
+template <class OpsT, class V>
+V _small_adjugate_minors(const V *a, V *m, const const_size<3> &) {
+  m[0] = _dp<OpsT>(a[4], a[8], a[5], a[7]);
+  m[1] = _dp<OpsT>(a[1], a[8], a[2], a[7]);
+  m[2] = _dp<OpsT>(a[1], a[5], a[2], a[4]);
+  m[3] = _dp<OpsT>(a[3], a[8], a[5], a[6]);
+  m[4] = _dp<OpsT>(a[0], a[8], a[2], a[6]);
+  m[5] = _dp<OpsT>(a[0], a[5], a[2], a[3]);
+  m[6] = _dp<OpsT>(a[3], a[7], a[4], a[6]);
+  m[7] = _dp<OpsT>(a[0], a[7], a[1], a[6]);
+  m[8] = _dp<OpsT>(a[0], a[4], a[1], a[3]);
+  return _tp<OpsT>(a[0], m[0], a[1], m[3], a[2], m[6]);
+}
+template <class OpsT, class V>
+V _small_adjugate_minors(const V *a, V *m, const const_size<4> &) {
+  V s[6], c[6];
+  _small_minors4<OpsT>(a, s, c);
+  m[0] = _tp<OpsT>(a[5], c[5], a[6], c[4], a[7], c[3]);
+  m[1] = _tp<OpsT>(a[1], c[5], a[2], c[4], a[3], c[3]);
+  m[2] = _tp<OpsT>(a[13], s[5], a[14], s[4], a[15], s[3]);
+  m[3] = _tp<OpsT>(a[9], s[5], a[10], s[4], a[11], s[3]);
+  m[4] = _tp<OpsT>(a[4], c[5], a[6], c[2], a[7], c[1]);
+  m[5] = _tp<OpsT>(a[0], c[5], a[2], c[2], a[3], c[1]);
+  m[6] = _tp<OpsT>(a[12], s[5], a[14], s[2], a[15], s[1]);
+  m[7] = _tp<OpsT>(a[8], s[5], a[10], s[2], a[11], s[1]);
+  m[8] = _tp<OpsT>(a[4], c[4], a[5], c[2], a[7], c[0]);
+  m[9] = _tp<OpsT>(a[0], c[4], a[1], c[2], a[3], c[0]);
+  m[10] = _tp<OpsT>(a[12], s[4], a[13], s[2], a[15], s[0]);
+  m[11] = _tp<OpsT>(a[8], s[4], a[9], s[2], a[11], s[0]);
+  m[12] = _tp<OpsT>(a[4], c[3], a[5], c[1], a[6], c[0]);
+  m[13] = _tp<OpsT>(a[0], c[3], a[1], c[1], a[2], c[0]);
+  m[14] = _tp<OpsT>(a[12], s[3], a[13], s[1], a[14], s[0]);
+  m[15] = _tp<OpsT>(a[8], s[3], a[9], s[1], a[10], s[0]);
+  return _small_det4<OpsT>(s, c);
+}
+
+// _small_inverse: r = inverse(a), returns det(a)
+template <class OpsT, size_t N, class V> V _small_inverse(const V *a, V *r) {
+  using value_t = typename OpsT::value_type;
+  const V d = _small_adjugate_minors<OpsT>(a, r, const_size<N>());
+  const V inv = OpsT::div(OpsT::set1(value_t(1)), d);
+  const V ninv = OpsT::sub(OpsT::set1(value_t(0)), inv);
+  for_each(make_const_sequence(const_size<N * N>()), [r, &inv, &ninv](auto ij) {
+    constexpr size_t i = decltype(ij)::value / N, j = decltype(ij)::value % N;
+    r[i * N + j] = OpsT::mul(r[i * N + j], (i + j) % 2 == 0 ? inv : ninv);
+  });
+  return d;
+}
+
+// _small_elements: copies the elements of a static matrix to a[]
+template <size_t M, size_t N, class ET, class T>
+void _small_elements(const tensor_core<T> &m, ET *a) {
+  for_each(make_const_sequence(const_size<M * N>()), [&m, a](auto ij) {
+    constexpr size_t i = decltype(ij)::value / N, j = decltype(ij)::value % N;
+    a[i * N + j] = element_at(m.derived(), i, j);
+  });
+}
+}
+
+// ET det(m)
+template <class ET, class ST, ST N, class T>
+ET det(const tensor_base<ET, tensor_shape<ST, const_ints<ST, N>,
+                                          const_ints<ST, N>>, T> &m) {
+  static_assert(N >= 1 && N <= detail::_small_static_size,
+                "det is only available for static matrices up to 4 x 4");
+  ET a[N * N];
+  detail::_small_elements<N, N>(m.derived(), a);
+  return detail::_small_det<detail::_scalar_ops<ET>>(a, const_size<N>());
+}
+
+// auto inverse(m, succeed)
+// - *succeed is set to false if m is singular, the result is then not finite
+template <class ET, class ST, ST N, class T>
+auto inverse(const tensor_base<ET, tensor_shape<ST, const_ints<ST, N>,
+                                                const_ints<ST, N>>, T> &m,
+             bool *succeed) {
+  static_assert(N >= 1 && N <= detail::_small_static_size,
+                "inverse is only available for static matrices up to 4 x 4");
+  static_assert(std::is_floating_point<ET>::value,
+                "inverse requires a floating point matrix");
+  ET a[N * N];
+  detail::_small_elements<N, N>(m.derived(), a);
+  tensor<ET, tensor_shape<ST, const_ints<ST, N>, const_ints<ST, N>>> r;
+  const ET d = detail::_small_inverse<detail::_scalar_ops<ET>, N>(a, r.ptr());
+  if (succeed) {
+    *succeed = d != ET(0);
+  }
+  return r;
+}
+
+// auto solve(a, b, succeed)
+// - solves a * x = b for a small static square a, b is a vector or a
+//   matrix of right hand sides
+template <class ET, class ST, ST N, class T, class E2, class ST2, class MT2,
+          class T2>
+auto solve(const tensor_base<ET, tensor_shape<ST, const_ints<ST, N>,
+                                              const_ints<ST, N>>, T> &a,
+           const tensor_base<E2, tensor_shape<ST2, MT2>, T2> &b,
+           bool *succeed) {
+  assert(b.numel() == N);
+  using result_t = tensor<ET, tensor_shape<ST, const_ints<ST, N>>>;
+  return result_t(inverse(a, succeed) * b.derived());
+}
+template <class ET, class ST, ST N, class T, class E2, class ST2, class MT2,
+          class NT2, class T2>
+auto solve(const tensor_base<ET, tensor_shape<ST, const_ints<ST, N>,
+                                              const_ints<ST, N>>, T> &a,
+           const tensor_base<E2, tensor_shape<ST2, MT2, NT2>, T2> &b,
+           bool *succeed) {
+  assert(b.rows() == N);
+  using result_t = tensor<ET, tensor_shape<ST, const_ints<ST, N>, NT2>>;
+  return result_t(inverse(a, succeed) * b.derived());
+}
+
+// det_each(ms), inverse_each(ms, succeed)
+// - ms is a [n, k, k] tensor holding n static k x k matrices, k <= 4
+// - blocks of simd_pack::size matrices are transposed on the stack so that
+//   lane l of the e-th pack holds element e of the l-th matrix (SoA), the
+//   closed forms above then run on whole packs, the remaining matrices one
+//   by one
+// - the matrices are split deterministically across the thread pool
+namespace detail {
+template <size_t K, class ET>
+void _det_each(const ET *in, ET *out, size_t first, size_t last) {
+  using pack = simd_pack<ET>;
+  constexpr size_t w = pack::size;
+  constexpr size_t kk = K * K;
+  size_t i = first;
+  if (w > 1) {
+    ET t[kk * w];
+    typename pack::type a[kk];
+    for (; i + w <= last; i += w) {
+      for (size_t l = 0; l < w; l++) {
+        for (size_t e = 0; e < kk; e++) {
+          t[e * w + l] = in[(i + l) * kk + e];
+        }
+      }
+      for (size_t e = 0; e < kk; e++) {
+        a[e] = pack::load(t + e * w);
+      }
+      pack::store(out + i, _small_det<pack>(a, const_size<K>()));
+    }
+  }
+  for (; i < last; i++) {
+    out[i] = _small_det<_scalar_ops<ET>>(in + i * kk, const_size<K>());
+  }
+}
+
+// returns the number of singular matrices
+template <size_t K, class ET>
+size_t _inverse_each(const ET *in, ET *out, size_t first, size_t last) {
+  using pack = simd_pack<ET>;
+  constexpr size_t w = pack::size;
+  constexpr size_t kk = K * K;
+  size_t singular = 0;
+  size_t i = first;
+  if (w > 1) {
+    ET t[kk * w], d[w];
+    typename pack::type a[kk], r[kk];
+    for (; i + w <= last; i += w) {
+      for (size_t l = 0; l < w; l++) {
+        for (size_t e = 0; e < kk; e++) {
+          t[e * w + l] = in[(i + l) * kk + e];
+        }
+      }
+      for (size_t e = 0; e < kk; e++) {
+        a[e] = pack::load(t + e * w);
+      }
+      pack::store(d, _small_inverse<pack, K>(a, r));
+      for (size_t e = 0; e < kk; e++) {
+        pack::store(t + e * w, r[e]);
+      }
+      for (size_t l = 0; l < w; l++) {
+        for (size_t e = 0; e < kk; e++) {
+          out[(i + l) * kk + e] = t[e * w + l];
+        }
+        singular += d[l] == ET(0);
+      }
+    }
+  }
+  for (; i < last; i++) {
+    singular += _small_inverse<_scalar_ops<ET>, K>(in + i * kk,
+                                                   out + i * kk) == ET(0);
+  }
+  return singular;
+}
+
+static constexpr size_t _small_batch_grain = 256;
+}
+
+// det_each(ms)
+template <class ET, class ST, class NT, ST K, class T>
+auto det_each(const tensor_base<ET, tensor_shape<ST, NT, const_ints<ST, K>,
+                                                 const_ints<ST, K>>, T> &ms) {
+  static_assert(K >= 1 && K <= detail::_small_static_size,
+                "det_each is only available for matrices up to 4 x 4");
+  decltype(auto) in = materialize(ms.derived());
+  const size_t n = in.size(const_index<0>());
+  tensor<ET, tensor_shape<ST, NT>> out(make_shape(in.size(const_index<0>())),
+                                       with_uninitialized);
+  const ET *src = in.ptr();
+  ET *dst = out.ptr();
+  if (n == 0) {
+    return out;
+  }
+  constexpr size_t grain = detail::_small_batch_grain;
+  default_thread_pool().run(
+      (n + grain - 1) / grain,
+      [src, dst, n](size_t c) {
+        detail::_det_each<K>(src, dst, c * grain, std::min(n, (c + 1) * grain));
+      },
+      n * K * K < parallel_threshold() ? 1 : 0);
+  return out;
+}
+
+// inverse_each(ms, succeed)
+// - *succeed is set to false if any of the matrices is singular
+template <class ET, class ST, class NT, ST K, class T>
+auto inverse_each(const tensor_base<ET, tensor_shape<ST, NT, const_ints<ST, K>,
+                                                     const_ints<ST, K>>, T> &ms,
+                  bool *succeed) {
+  static_assert(K >= 1 && K <= detail::_small_static_size,
+                "inverse_each is only available for matrices up to 4 x 4");
+  static_assert(std::is_floating_point<ET>::value,
+                "inverse_each requires floating point matrices");
+  decltype(auto) in = materialize(ms.derived());
+  const size_t n = in.size(const_index<0>());
+  tensor<ET, tensor_shape<ST, NT, const_ints<ST, K>, const_ints<ST, K>>> out(
+      in.shape(), with_uninitialized);
+  const ET *src = in.ptr();
+  ET *dst = out.ptr();
+  const size_t singular = parallel_reduce_chunks(
+      n, size_t(0),
+      [src, dst](size_t first, size_t last) {
+        return detail::_inverse_each<K>(src, dst, first, last);
+      },
+      [](size_t a, size_t b) { return a + b; }, detail::_small_batch_grain);
+  if (succeed) {
+    *succeed = singular == 0;
+  }
+  return out;
+}
+
 // translate (TODO transpose or not?)
 template <class E1, class ST1, class MT1, class NT1, class T1, class E2,
           class ST2, class MT2, class T2>
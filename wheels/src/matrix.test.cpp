@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
+#include <numeric>
 
 #include "diagonal.hpp"
 #include "matrix.hpp"
+#include "permute.hpp"
 #include "reshape.hpp"
 #include "tensor.hpp"
 
@@ -42,4 +44,228 @@ TEST(matrix, matrix_ops) {
                                vec3(1, 2, 3)),
                      vec3(-1, -2, -3));
   ASSERT_LE((m - eye(4)).norm(), 1e-3);
-}
\ No newline at end of file
+}
+TEST(matrix, gemm) {
+  std::default_random_engine rng;
+  for (auto mnk : {std::make_tuple(17, 19, 23), std::make_tuple(130, 7, 300),
+                   std::make_tuple(1, 513, 40), std::make_tuple(129, 65, 1)}) {
+    size_t m = std::get<0>(mnk), n = std::get<1>(mnk), k = std::get<2>(mnk);
+    auto a = rand(make_shape(m, k), rng);
+    auto b = rand(make_shape(k, n), rng);
+    matx c = a * b;
+    ASSERT_TRUE(c.shape() == make_shape(m, n));
+    for (size_t i = 0; i < m; i++) {
+      for (size_t j = 0; j < n; j++) {
+        double e = 0.0;
+        for (size_t p = 0; p < k; p++) {
+          e += a(i, p) * b(p, j);
+        }
+        ASSERT_NEAR(c(i, j), e, 1e-9);
+      }
+    }
+
+    matx_<int> ai(a * 10.0), bi(b * 10.0);
+    matx_<int> ci = ai * bi;
+    ASSERT_TRUE(ci == (ai * bi).ewised().eval());
+  }
+
+  // aliased destination
+  auto a = rand(make_shape(40, 40), rng);
+  auto b = rand(make_shape(40, 40), rng);
+  matx ab = a * b;
+  a = a * b;
+  ASSERT_LE((a - ab).norm(), 1e-9);
+
+  // bool products stay logical and never reach gemm()
+  static_assert(!detail::_is_gemm_element<bool>::value, "");
+  matx_<bool> x(make_shape(40, 30)), y(make_shape(30, 20));
+  for (size_t i = 0; i < x.numel(); i++) {
+    x.ptr()[i] = rng() % 4 == 0;
+  }
+  for (size_t i = 0; i < y.numel(); i++) {
+    y.ptr()[i] = rng() % 4 == 0;
+  }
+  matx_<bool> xy = x * y;
+  for (size_t i = 0; i < 40; i++) {
+    for (size_t j = 0; j < 20; j++) {
+      bool e = false;
+      for (size_t p = 0; p < 30; p++) {
+        e = e || (x(i, p) && y(p, j));
+      }
+      ASSERT_EQ(xy(i, j), e);
+    }
+  }
+}
+
+template <class T, size_t M, size_t K, size_t N>
+static void check_small_static_mul(std::default_random_engine &rng) {
+  mat_<T, M, K> a;
+  mat_<T, K, N> b;
+  vec_<T, K> x;
+  vec_<T, M> y;
+  for (size_t i = 0; i < M * K; i++) {
+    a.ptr()[i] = T(rng() % 17) - 8;
+  }
+  for (size_t i = 0; i < K * N; i++) {
+    b.ptr()[i] = T(rng() % 17) - 8;
+  }
+  for (size_t i = 0; i < K; i++) {
+    x.ptr()[i] = T(rng() % 17) - 8;
+  }
+  for (size_t i = 0; i < M; i++) {
+    y.ptr()[i] = T(rng() % 17) - 8;
+  }
+  // exact on small integers, compared with the element by element path
+  mat_<T, M, N> ab = a * b;
+  ASSERT_TRUE(ab == (a * b).ewised().eval());
+  vec_<T, M> ax = a * x;
+  ASSERT_TRUE(ax == (a * x).ewised().eval());
+  vec_<T, K> ya = y * a;
+  ASSERT_TRUE(ya == (y * a).ewised().eval());
+  matx_<T> abx = a * b;
+  ASSERT_TRUE(abx == ab);
+  mat_<T, K, M> at = a.t();
+  for (size_t i = 0; i < M; i++) {
+    for (size_t j = 0; j < K; j++) {
+      ASSERT_EQ(at(j, i), a(i, j));
+    }
+  }
+  mat_<T, M, K> c = a + a * T(2) - a;
+  ASSERT_TRUE(c == (a * T(2)).eval());
+}
+
+template <class T, size_t M, size_t K, size_t N>
+static void check_small_mul_kernel(std::default_random_engine &rng) {
+  using kernel_t = detail::_small_mul_kernel_t<T, M, K, N>;
+  static_assert(simd_pack<T>::size == 1 ||
+                    std::is_same<kernel_t, std::conditional_t<
+                                               N == 1, detail::_small_mul_dots,
+                                               detail::_small_mul_rows>>::value,
+                "");
+  alignas(64) T a[M * K], b[K * N], c[M * N], expected[M * N];
+  for (size_t i = 0; i < M * K; i++) {
+    a[i] = T(rng() % 17) - 8;
+  }
+  for (size_t i = 0; i < K * N; i++) {
+    b[i] = T(rng() % 17) - 8;
+  }
+  detail::_small_matrix_mul<M, K, N>(a, b, c, kernel_t());
+  detail::_small_matrix_mul<M, K, N>(a, b, expected,
+                                     detail::_small_mul_scalar());
+  for (size_t i = 0; i < M * N; i++) {
+    ASSERT_EQ(c[i], expected[i]);
+  }
+}
+
+TEST(matrix, small_static) {
+  std::default_random_engine rng;
+  check_small_static_mul<float, 4, 4, 4>(rng);
+  check_small_static_mul<double, 4, 4, 4>(rng);
+  check_small_static_mul<double, 2, 3, 4>(rng);
+  check_small_static_mul<float, 3, 1, 2>(rng);
+  check_small_static_mul<int, 3, 3, 3>(rng);
+  check_small_static_mul<double, 2, 2, 2>(rng);
+
+  // packed kernels, run directly since the packs may be wider than a small
+  // static shape: several packs per row and packed dot products
+  check_small_mul_kernel<float, 2, 3, 2 * simd_pack<float>::size>(rng);
+  check_small_mul_kernel<double, 2, 3, 2 * simd_pack<double>::size>(rng);
+  check_small_mul_kernel<float, 3, 2 * simd_pack<float>::size, 1>(rng);
+  check_small_mul_kernel<double, 3, 2 * simd_pack<double>::size, 1>(rng);
+  mat4 m4(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
+  vec4 v4(1, 0, 2, 0);
+  vec4 mv = m4 * v4;
+  ASSERT_TRUE(mv == vec4(7, 19, 31, 43));
+
+  // aliased destinations
+  mat4 a, b;
+  std::iota(a.ptr(), a.ptr() + 16, 1.0);
+  std::iota(b.ptr(), b.ptr() + 16, -5.0);
+  mat4 ab = (a * b).ewised().eval();
+  mat4 at = a.t();
+  mat4 a2 = a;
+  a = a * b;
+  ASSERT_TRUE(a == ab);
+  a2 = a2.t();
+  ASSERT_TRUE(a2 == at);
+
+  // det
+  ASSERT_EQ(det(mat2(1, 2, 3, 4)), -2.0);
+  ASSERT_EQ(det(mat3(2, 0, 1, 1, 3, 2, 1, 1, 2)), 6.0);
+  ASSERT_EQ(det(mat4(1, 0, 2, -1, 3, 0, 0, 5, 2, 1, 4, -3, 1, 0, 5, 0)),
+            30.0);
+  ASSERT_EQ(det(eye(make_shape(const_size<4>(), const_size<4>()))), 1.0);
+  mat4 r = rotate(eye(4), 0.3, vec3(1, 2, 3) / norm_of(vec3(1, 2, 3)));
+  ASSERT_NEAR(det(r), 1.0, 1e-12);
+}
+
+template <class T, size_t N>
+static void check_small_inverse(std::default_random_engine &rng, double tol) {
+  std::uniform_real_distribution<T> dist(-1, 1);
+  for (int t = 0; t < 50; t++) {
+    mat_<T, N, N> a;
+    vec_<T, N> b;
+    for (size_t i = 0; i < N * N; i++) {
+      a.ptr()[i] = dist(rng) + (i % (N + 1) == 0 ? T(4) : T(0));
+    }
+    for (size_t i = 0; i < N; i++) {
+      b.ptr()[i] = dist(rng);
+    }
+    bool succeed = false;
+    mat_<T, N, N> x = inverse(a, &succeed);
+    ASSERT_TRUE(succeed);
+    mat_<T, N, N> ax = a * x;
+    ASSERT_LE(norm_of(ax - eye(make_shape(const_size<N>(), const_size<N>()))),
+              tol);
+    vec_<T, N> y = solve(a, b, &succeed);
+    ASSERT_TRUE(succeed);
+    vec_<T, N> ay = a * y;
+    ASSERT_LE(norm_of(ay - b), tol);
+    matx_<T> bs(make_shape(N, 3), T(1));
+    matx_<T> ys = solve(a, bs);
+    ASSERT_LE(norm_of(a * ys - bs), tol);
+  }
+}
+
+TEST(matrix, small_inverse) {
+  std::default_random_engine rng;
+  check_small_inverse<double, 2>(rng, 1e-12);
+  check_small_inverse<double, 3>(rng, 1e-12);
+  check_small_inverse<double, 4>(rng, 1e-12);
+  check_small_inverse<float, 3>(rng, 1e-4);
+  check_small_inverse<float, 4>(rng, 1e-4);
+
+  bool succeed = true;
+  inverse(mat3(1, 2, 3, 2, 4, 6, 0, 1, 1), &succeed);
+  ASSERT_FALSE(succeed);
+
+  // batches
+  for (size_t n : {0, 1, 3, 8, 1001}) {
+    tensor<float, tensor_shape<size_t, size_t, const_size<4>, const_size<4>>>
+        ms(make_shape(n, const_size<4>(), const_size<4>()));
+    std::uniform_real_distribution<float> dist(-1, 1);
+    for (size_t i = 0; i < ms.numel(); i++) {
+      ms.ptr()[i] = dist(rng) + (i % 5 == 0 ? 2.0f : 0.0f);
+    }
+    succeed = false;
+    auto inv = inverse_each(ms, &succeed);
+    auto dets = det_each(ms);
+    auto dets2 = det_each(ms * 1.0f);
+    ASSERT_TRUE(succeed);
+    ASSERT_TRUE(inv.shape() == ms.shape());
+    ASSERT_EQ(dets.numel(), n);
+    for (size_t i = 0; i < n; i++) {
+      mat_<float, 4, 4> m, mi;
+      std::copy_n(ms.ptr() + i * 16, 16, m.ptr());
+      std::copy_n(inv.ptr() + i * 16, 16, mi.ptr());
+      ASSERT_LE(norm_of(mi - inverse(m)), 1e-5);
+      ASSERT_NEAR(dets[i], det(m), 1e-5);
+      ASSERT_NEAR(dets2[i], det(m), 1e-5);
+    }
+  }
+  tensor<double, tensor_shape<size_t, size_t, const_size<2>, const_size<2>>>
+      singular(make_shape(size_t(5), const_size<2>(), const_size<2>()), 1.0);
+  succeed = true;
+  inverse_each(singular, &succeed);
+  ASSERT_FALSE(succeed);
+}
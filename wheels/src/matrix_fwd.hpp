@@ -35,6 +35,42 @@ template <class T> class matrix_base;
 template <class EleT, class ShapeT, class A, class B, bool AIsMat, bool BIsMat>
 class matrix_mul_result;
 
+// ET det(m);
+template <class ET, class ST, ST N, class T>
+ET det(const tensor_base<ET, tensor_shape<ST, const_ints<ST, N>,
+                                          const_ints<ST, N>>, T> &m);
+
+// auto inverse(m, succeed);
+template <class ET, class ST, ST N, class T>
+auto inverse(const tensor_base<ET, tensor_shape<ST, const_ints<ST, N>,
+                                                const_ints<ST, N>>, T> &m,
+             bool *succeed = nullptr);
+
+// auto solve(a, b, succeed);
+template <class ET, class ST, ST N, class T, class E2, class ST2, class MT2,
+          class T2>
+auto solve(const tensor_base<ET, tensor_shape<ST, const_ints<ST, N>,
+                                              const_ints<ST, N>>, T> &a,
+           const tensor_base<E2, tensor_shape<ST2, MT2>, T2> &b,
+           bool *succeed = nullptr);
+template <class ET, class ST, ST N, class T, class E2, class ST2, class MT2,
+          class NT2, class T2>
+auto solve(const tensor_base<ET, tensor_shape<ST, const_ints<ST, N>,
+                                              const_ints<ST, N>>, T> &a,
+           const tensor_base<E2, tensor_shape<ST2, MT2, NT2>, T2> &b,
+           bool *succeed = nullptr);
+
+// auto det_each(ms);
+template <class ET, class ST, class NT, ST K, class T>
+auto det_each(const tensor_base<ET, tensor_shape<ST, NT, const_ints<ST, K>,
+                                                 const_ints<ST, K>>, T> &ms);
+
+// auto inverse_each(ms, succeed);
+template <class ET, class ST, class NT, ST K, class T>
+auto inverse_each(const tensor_base<ET, tensor_shape<ST, NT, const_ints<ST, K>,
+                                                     const_ints<ST, K>>, T> &ms,
+                  bool *succeed = nullptr);
+
 template <class E1, class ST1, class MT1, class NT1, class T1, class E2,
           class ST2, class MT2, class T2>
 inline auto translate(const tensor_base<E1, tensor_shape<ST1, MT1, NT1>, T1> &m,
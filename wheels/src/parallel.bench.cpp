@@ -0,0 +1,56 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "parallel.hpp"
+
+using namespace wheels;
+
+static void linear_sizes(benchmark::internal::Benchmark *b) {
+  b->RangeMultiplier(10)->Range(16, 100000000);
+}
+
+// parallel_reduce
+static void parallel_reduce_sum(benchmark::State &state) {
+  const size_t n = state.range(0);
+  std::vector<double> data(n, 1.0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parallel_reduce(
+        data.begin(), data.end(), 0.0,
+        [](double a, double b) { return a + b; }, 1 << 12));
+  }
+  state.SetBytesProcessed(state.iterations() * n * sizeof(double));
+}
+BENCHMARK(parallel_reduce_sum)->Apply(linear_sizes);
+
+// parallel_reduce_chunks
+static void parallel_reduce_chunks_sum(benchmark::State &state) {
+  const size_t n = state.range(0);
+  std::vector<double> data(n, 1.0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parallel_reduce_chunks(
+        n, 0.0,
+        [&data](size_t first, size_t last) {
+          double s = 0.0;
+          for (size_t i = first; i < last; i++) {
+            s += data[i];
+          }
+          return s;
+        },
+        [](double a, double b) { return a + b; }));
+  }
+  state.SetBytesProcessed(state.iterations() * n * sizeof(double));
+}
+BENCHMARK(parallel_reduce_chunks_sum)->Apply(linear_sizes);
+
+// parallel_for_each dispatch cost
+static void parallel_for_each_dispatch(benchmark::State &state) {
+  const size_t n = state.range(0);
+  std::vector<float> data(n, 1.0f);
+  for (auto _ : state) {
+    parallel_for_each(n, [&data](size_t i) { data[i] *= 1.0001f; }, 1 << 14);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(parallel_for_each_dispatch)->Apply(linear_sizes);
@@ -24,101 +24,466 @@
 
 #pragma once
 
-#include <future>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <type_traits>
 #include <numeric>
 #include <vector>
 
+#include "macros.hpp"
+
 #include "parallel_fwd.hpp"
 
 namespace wheels {
 
-// parallel_for_each
-template <class FunT>
-void parallel_for_each(size_t n, FunT &&fun, size_t batch_num,
-                       size_t concurrency_num) {
-  std::vector<std::thread> threads;
-  threads.reserve(concurrency_num);
-  for (size_t bid = 0; bid < n / batch_num + 1; bid++) {
-    size_t bfirst = bid * batch_num;
-    size_t blast = std::min(n, (bid + 1) * batch_num) - 1;
-    threads.emplace_back(
-        [&fun](size_t first, size_t last) {
-          for (size_t i = first; i <= last; i++) {
-            fun(i);
+// thread_pool
+// - a persistent pool of workers, each owning a task deque
+// - a worker pops its own tasks from the back and steals from the front of
+//   others' deques when it runs dry
+// - the thread that starts a parallel region always takes part in it, and
+//   keeps running queued tasks while waiting, so nested regions never block
+class thread_pool {
+  struct _task {
+    void (*run)(void *);
+    void *context;
+  };
+  struct _worker {
+    std::mutex mutex;
+    std::deque<_task> tasks;
+  };
+
+  // a parallel region: chunks are claimed through an atomic counter
+  template <class FunT> struct _job {
+    FunT &fun;
+    size_t chunk_num;
+    std::atomic<size_t> next_chunk;
+    std::atomic<size_t> pending_helpers;
+    std::atomic<bool> failed;
+    std::exception_ptr error;
+
+    _job(FunT &f, size_t n, size_t helpers)
+        : fun(f), chunk_num(n), next_chunk(0), pending_helpers(helpers),
+          failed(false) {}
+
+    void work() {
+      wheels_try {
+        while (!failed.load(std::memory_order_relaxed)) {
+          size_t c = next_chunk.fetch_add(1, std::memory_order_relaxed);
+          if (c >= chunk_num) {
+            break;
           }
-        },
-        bfirst, blast);
-    if (threads.size() >= concurrency_num || bid == n / batch_num) {
-      for (auto &&t : threads) {
-        t.join();
+          fun(c);
+        }
+      }
+      wheels_catch_all {
+        if (!failed.exchange(true)) {
+          error = std::current_exception();
+        }
+      }
+    }
+    static void run_as_helper(void *context) {
+      auto *job = static_cast<_job *>(context);
+      job->work();
+      job->pending_helpers.fetch_sub(1, std::memory_order_release);
+    }
+  };
+
+public:
+  explicit thread_pool(size_t worker_num)
+      : _workers(worker_num), _queued(0), _stopped(false), _next_victim(0) {
+    _threads.reserve(worker_num);
+    for (size_t i = 0; i < worker_num; i++) {
+      _threads.emplace_back([this, i]() { _worker_loop(i); });
+    }
+  }
+  thread_pool(const thread_pool &) = delete;
+  thread_pool &operator=(const thread_pool &) = delete;
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(_sleep_mutex);
+      _stopped = true;
+    }
+    _wakeup.notify_all();
+    for (auto &t : _threads) {
+      t.join();
+    }
+  }
+
+  size_t worker_num() const { return _workers.size(); }
+
+  // run fun(chunk) for each chunk in [0, chunk_num) using at most
+  // concurrency_num threads (including the calling one), returns when all
+  // chunks are done, rethrows the first exception raised by fun
+  template <class FunT>
+  void run(size_t chunk_num, FunT &&fun, size_t concurrency_num = 0) {
+    if (chunk_num == 0) {
+      return;
+    }
+    if (concurrency_num == 0 || concurrency_num > worker_num() + 1) {
+      concurrency_num = worker_num() + 1;
+    }
+    size_t helper_num = std::min(concurrency_num, chunk_num) - 1;
+    if (helper_num == 0) {
+      for (size_t c = 0; c < chunk_num; c++) {
+        fun(c);
+      }
+      return;
+    }
+
+    using fun_t = std::remove_reference_t<FunT>;
+    _job<fun_t> job(fun, chunk_num, helper_num);
+    for (size_t i = 0; i < helper_num; i++) {
+      _push(_task{&_job<fun_t>::run_as_helper, &job});
+    }
+    job.work();
+    while (job.pending_helpers.load(std::memory_order_acquire) != 0) {
+      if (!_try_run_one()) {
+        std::this_thread::yield();
+      }
+    }
+    if (job.error) {
+      std::rethrow_exception(job.error);
+    }
+  }
+
+private:
+  static std::pair<thread_pool *, size_t> &_this_thread_worker() {
+    static thread_local std::pair<thread_pool *, size_t> w(nullptr, 0);
+    return w;
+  }
+
+  void _push(const _task &task) {
+    auto &self = _this_thread_worker();
+    size_t wid =
+        self.first == this
+            ? self.second
+            : _next_victim.fetch_add(1, std::memory_order_relaxed) %
+                  _workers.size();
+    {
+      std::lock_guard<std::mutex> lock(_workers[wid].mutex);
+      _workers[wid].tasks.push_back(task);
+    }
+    {
+      std::lock_guard<std::mutex> lock(_sleep_mutex);
+      _queued++;
+    }
+    _wakeup.notify_one();
+  }
+
+  bool _try_pop(size_t wid, bool steal, _task &task) {
+    auto &w = _workers[wid];
+    std::lock_guard<std::mutex> lock(w.mutex);
+    if (w.tasks.empty()) {
+      return false;
+    }
+    if (steal) {
+      task = w.tasks.front();
+      w.tasks.pop_front();
+    } else {
+      task = w.tasks.back();
+      w.tasks.pop_back();
+    }
+    _queued--;
+    return true;
+  }
+
+  // run one queued task, own deque first, then steal
+  bool _try_run_one() {
+    if (_queued.load(std::memory_order_relaxed) == 0) {
+      return false;
+    }
+    auto &self = _this_thread_worker();
+    size_t n = _workers.size();
+    size_t first = self.first == this ? self.second : 0;
+    _task task;
+    for (size_t k = 0; k < n; k++) {
+      size_t wid = (first + k) % n;
+      if (_try_pop(wid, self.first != this || k > 0, task)) {
+        task.run(task.context);
+        return true;
       }
-      threads.clear();
     }
+    return false;
   }
+
+  void _worker_loop(size_t wid) {
+    _this_thread_worker() = std::make_pair(this, wid);
+    while (true) {
+      if (_try_run_one()) {
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(_sleep_mutex);
+      _wakeup.wait(lock, [this]() { return _stopped || _queued > 0; });
+      if (_stopped && _queued == 0) {
+        return;
+      }
+    }
+  }
+
+private:
+  std::vector<_worker> _workers;
+  std::vector<std::thread> _threads;
+  std::atomic<size_t> _queued;
+  std::mutex _sleep_mutex;
+  std::condition_variable _wakeup;
+  bool _stopped;
+  std::atomic<size_t> _next_victim;
+};
+
+// default_thread_pool
+// the calling thread always joins a region, so hardware_concurrency() - 1
+// workers are enough to occupy every core
+inline thread_pool &default_thread_pool() {
+  static thread_pool pool(std::max(std::thread::hardware_concurrency(), 1u) -
+                          1);
+  return pool;
+}
+
+// parallel_threshold
+// - the minimum element count for which element-wise traversals are split
+//   across default_thread_pool()
+// - calibrated on first use by comparing the cost of dispatching an empty
+//   region with the cost of a simple per-element loop, can be overridden by
+//   the WHEELS_PARALLEL_THRESHOLD environment variable or
+//   set_parallel_threshold(n) (n == 0 restores the calibrated value)
+namespace detail {
+inline size_t _calibrate_parallel_threshold() {
+  auto &pool = default_thread_pool();
+  if (pool.worker_num() == 0) {
+    return std::numeric_limits<size_t>::max();
+  }
+  if (const char *env = std::getenv("WHEELS_PARALLEL_THRESHOLD")) {
+    char *end = nullptr;
+    auto n = std::strtoull(env, &end, 10);
+    if (end != env && n > 0) {
+      return (size_t)n;
+    }
+  }
+
+  using clock = std::chrono::steady_clock;
+  auto min_cost = [](auto &&fun) {
+    auto best = clock::duration::max();
+    for (int k = 0; k < 8; k++) {
+      auto start = clock::now();
+      fun();
+      best = std::min(best, clock::now() - start);
+    }
+    return std::chrono::duration<double, std::nano>(best).count();
+  };
+
+  double dispatch_ns = min_cost(
+      [&pool]() { pool.run(pool.worker_num() + 1, [](size_t) {}); });
+
+  static constexpr size_t n = 1 << 12;
+  std::vector<double> a(n, 1.0), b(n, 0.0);
+  volatile double sink = 0.0;
+  double loop_ns = min_cost([&]() {
+    for (size_t i = 0; i < n; i++) {
+      b[i] = a[i] * 1.0001 + b[i];
+    }
+    sink = b[n / 2];
+  });
+  (void)sink;
+
+  // a region should run long enough to amortize the dispatch several times
+  double per_element_ns = std::max(loop_ns / n, 1e-3);
+  double thres = 8.0 * dispatch_ns / per_element_ns;
+  return (size_t)std::min(std::max(thres, (double)(1 << 12)),
+                          (double)(1 << 24));
+}
+inline std::atomic<size_t> &_parallel_threshold_override() {
+  static std::atomic<size_t> thres(0);
+  return thres;
+}
+}
+
+inline size_t parallel_threshold() {
+  size_t thres = detail::_parallel_threshold_override().load();
+  if (thres != 0) {
+    return thres;
+  }
+  static const size_t calibrated = detail::_calibrate_parallel_threshold();
+  return calibrated;
+}
+
+inline void set_parallel_threshold(size_t n) {
+  detail::_parallel_threshold_override().store(n);
+}
+
+// parallel_for_each
+template <class FunT>
+void parallel_for_each(thread_pool &pool, size_t n, FunT &&fun,
+                       size_t batch_num, size_t concurrency_num) {
+  batch_num = std::max<size_t>(batch_num, 1);
+  pool.run((n + batch_num - 1) / batch_num,
+           [n, batch_num, &fun](size_t bid) {
+             size_t last = std::min(n, (bid + 1) * batch_num);
+             for (size_t i = bid * batch_num; i < last; i++) {
+               fun(i);
+             }
+           },
+           concurrency_num);
+}
+
+template <class FunT>
+void parallel_for_each(size_t n, FunT &&fun, size_t batch_num,
+                       size_t concurrency_num) {
+  parallel_for_each(default_thread_pool(), n, std::forward<FunT>(fun),
+                    batch_num, concurrency_num);
+}
+
+template <class IterT, class FunT>
+void parallel_for_each(thread_pool &pool, IterT begin, IterT end, FunT &&fun,
+                       size_t batch_num, size_t concurrency_num) {
+  size_t n = std::distance(begin, end);
+  batch_num = std::max<size_t>(batch_num, 1);
+  pool.run((n + batch_num - 1) / batch_num,
+           [begin, n, batch_num, &fun](size_t bid) {
+             IterT first = begin + bid * batch_num;
+             IterT last = begin + std::min(n, (bid + 1) * batch_num);
+             while (first != last) {
+               fun(*first);
+               ++first;
+             }
+           },
+           concurrency_num);
 }
 
 template <class IterT, class FunT>
 void parallel_for_each(IterT begin, IterT end, FunT &&fun, size_t batch_num,
                        size_t concurrency_num) {
-  std::vector<std::thread> threads;
-  threads.reserve(concurrency_num);
-
-  auto n = std::distance(begin, end);
-  for (size_t bid = 0; bid < n / batch_num + 1; bid++) {
-    size_t bfirst = bid * batch_num;
-    size_t blast = std::min(n, (bid + 1) * batch_num) - 1;
-    threads.emplace_back(
-        [&fun](IterT first, IterT last) {
-          while (first != last) {
-            fun(*first);
-            ++first;
-          }
-        },
-        begin + bfirst, begin + blast);
-    if (threads.size() >= concurrency_num || bid == n / batch_num) {
-      for (auto &&t : threads) {
-        t.join();
-      }
-      threads.clear();
+  parallel_for_each(default_thread_pool(), begin, end, std::forward<FunT>(fun),
+                    batch_num, concurrency_num);
+}
+
+// parallel_reduce_chunks
+// - splits [0, n) into at most _max_reduce_chunks chunks of at least grain
+//   elements, chunk_reduce(first, last) returns the partial result of a chunk
+//   and combine(a, b) merges two partials, identity is returned when n == 0
+// - chunk bounds depend only on n and grain, and partials are merged in a
+//   fixed pairwise tree, so the result does not depend on the number of
+//   threads or on scheduling, even for floating point sums
+// - partials live in cache line padded slots on the stack, no allocation
+// - regions smaller than parallel_threshold() run in the calling thread with
+//   the same chunking
+namespace detail {
+static constexpr size_t _max_reduce_chunks = 64;
+static constexpr size_t _reduce_grain = 1 << 10;
+
+template <class T> struct alignas(64) _reduce_slot {
+  T value;
+  explicit _reduce_slot(const T &v) : value(v) {}
+};
+template <class T> class _reduce_slots {
+public:
+  _reduce_slots(size_t n, const T &identity) : _n(0) {
+    for (; _n < n; _n++) {
+      new (&_slots[_n]) _reduce_slot<T>(identity);
     }
   }
-}
+  ~_reduce_slots() {
+    for (size_t i = 0; i < _n; i++) {
+      reinterpret_cast<_reduce_slot<T> &>(_slots[i]).~_reduce_slot();
+    }
+  }
+  _reduce_slots(const _reduce_slots &) = delete;
+  _reduce_slots &operator=(const _reduce_slots &) = delete;
+  T &operator[](size_t i) {
+    return reinterpret_cast<_reduce_slot<T> &>(_slots[i]).value;
+  }
 
-// parallel_reduce
-template <class IterT, class T, class ReduceT>
-T parallel_reduce(IterT begin, IterT end, const T &initial, ReduceT&& redux,
-                  size_t batch_num, size_t concurrency_num) {
-  std::vector<std::future<T>> futures;
-  futures.reserve(concurrency_num);
-
-  T result = initial;
-  auto n = std::distance(begin, end);
-  for (size_t bid = 0; bid < n / batch_num + 1; bid++) {
-    size_t bfirst = bid * batch_num;
-    size_t blast = std::min<size_t>(n, (bid + 1) * batch_num) - 1;
-    std::packaged_task<T(IterT, IterT)> task([&redux](IterT first, IterT last) {
-      T tmp_result = 0;
-      while (first != last) {
-        tmp_result = redux(tmp_result, *first);
-        ++first;
-      }
-      return tmp_result;
-    });
+private:
+  size_t _n;
+  std::aligned_storage_t<sizeof(_reduce_slot<T>), alignof(_reduce_slot<T>)>
+      _slots[_max_reduce_chunks];
+};
 
-    futures.push_back(task.get_future());
+template <class T, class ChunkReduceT, class CombineT>
+T _parallel_reduce_chunks(thread_pool &pool, size_t n, const T &identity,
+                          ChunkReduceT &chunk_reduce, CombineT &combine,
+                          size_t grain, size_t concurrency_num) {
+  if (n == 0) {
+    return identity;
+  }
+  grain = std::max<size_t>(grain, 1);
+  const size_t chunk_size = std::max(
+      grain, (n + _max_reduce_chunks - 1) / _max_reduce_chunks);
+  const size_t nchunks = (n + chunk_size - 1) / chunk_size;
+  if (nchunks == 1) {
+    return chunk_reduce((size_t)0, n);
+  }
 
-    std::thread(std::move(task), begin + bfirst, begin + blast).detach();
-    if (futures.size() >= concurrency_num || bid == n / batch_num) {
-      for (auto &&f : futures) {
-        f.wait();
-      }
-      for (auto &&f : futures) {
-        result = redux(result, f.get());
-      }
-      futures.clear();
+  _reduce_slots<T> partials(nchunks, identity);
+  pool.run(nchunks,
+           [&chunk_reduce, &partials, n, chunk_size](size_t c) {
+             partials[c] = chunk_reduce(c * chunk_size,
+                                        std::min(n, (c + 1) * chunk_size));
+           },
+           n < parallel_threshold() ? 1 : concurrency_num);
+  for (size_t step = 1; step < nchunks; step *= 2) {
+    for (size_t i = 0; i + step < nchunks; i += 2 * step) {
+      partials[i] = combine(partials[i], partials[i + step]);
     }
   }
-  return result;
+  return partials[0];
+}
+}
+
+template <class T, class ChunkReduceT, class CombineT>
+T parallel_reduce_chunks(thread_pool &pool, size_t n, const T &identity,
+                         ChunkReduceT &&chunk_reduce, CombineT &&combine,
+                         size_t grain) {
+  return detail::_parallel_reduce_chunks(pool, n, identity, chunk_reduce,
+                                         combine, grain, 0);
+}
+
+template <class T, class ChunkReduceT, class CombineT>
+T parallel_reduce_chunks(size_t n, const T &identity,
+                         ChunkReduceT &&chunk_reduce, CombineT &&combine,
+                         size_t grain) {
+  return parallel_reduce_chunks(
+      default_thread_pool(), n, identity,
+      std::forward<ChunkReduceT>(chunk_reduce),
+      std::forward<CombineT>(combine), grain);
+}
+
+// parallel_reduce
+// - redux must be associative, each batch is folded starting from its own
+//   first element, and the batch results are merged into initial
+template <class IterT, class T, class ReduceT>
+T parallel_reduce(thread_pool &pool, IterT begin, IterT end, const T &initial,
+                  ReduceT &&redux, size_t batch_num, size_t concurrency_num) {
+  size_t n = std::distance(begin, end);
+  if (n == 0) {
+    return initial;
+  }
+  auto reduce_batch = [begin, &redux](size_t first, size_t last) {
+    IterT it = begin + first;
+    T tmp_result = *it;
+    for (++it; it != begin + last; ++it) {
+      tmp_result = redux(tmp_result, *it);
+    }
+    return tmp_result;
+  };
+  return redux(initial,
+               detail::_parallel_reduce_chunks(pool, n, initial, reduce_batch,
+                                               redux, batch_num,
+                                               concurrency_num));
+}
+
+template <class IterT, class T, class ReduceT>
+T parallel_reduce(IterT begin, IterT end, const T &initial, ReduceT &&redux,
+                  size_t batch_num, size_t concurrency_num) {
+  return parallel_reduce(default_thread_pool(), begin, end, initial,
+                         std::forward<ReduceT>(redux), batch_num,
+                         concurrency_num);
 }
 }
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "parallel.hpp"
+
+using namespace wheels;
+
+TEST(core, thread_pool) {
+  thread_pool pool(4);
+  ASSERT_EQ(pool.worker_num(), 4);
+
+  std::vector<int> data(10000, 0);
+  parallel_for_each(pool, data.size(), [&data](size_t i) { data[i] = (int)i; },
+                    100);
+  for (size_t i = 0; i < data.size(); i++) {
+    ASSERT_EQ(data[i], i);
+  }
+
+  // nested regions
+  std::atomic<size_t> count(0);
+  parallel_for_each(pool, 16, [&pool, &count](size_t) {
+    parallel_for_each(pool, 100, [&count](size_t) { count++; }, 10);
+  });
+  ASSERT_EQ(count, 1600);
+
+  // exceptions are passed to the caller
+  ASSERT_THROW(parallel_for_each(pool, 100,
+                                 [](size_t i) {
+                                   if (i == 42) {
+                                     throw std::runtime_error("42");
+                                   }
+                                 }),
+               std::runtime_error);
+
+  // an empty pool runs everything in the calling thread
+  thread_pool empty(0);
+  parallel_for_each(empty, data.begin(), data.end(), [](int &e) { e = -e; },
+                    7);
+  for (size_t i = 0; i < data.size(); i++) {
+    ASSERT_EQ(data[i], -(int)i);
+  }
+}
+
+TEST(core, parallel_reduce) {
+  std::vector<int> data(1001);
+  std::iota(data.begin(), data.end(), 0);
+  thread_pool pool(3);
+  for (size_t batch : {1, 10, 333, 5000}) {
+    ASSERT_EQ(parallel_reduce(pool, data.begin(), data.end(), 0,
+                              [](int a, int b) { return a + b; }, batch),
+              500500);
+  }
+  ASSERT_EQ(parallel_reduce(data.begin(), data.end(), 0,
+                            [](int a, int b) { return a + b; }, 64),
+            500500);
+}
+
+TEST(core, parallel_reduce_chunks) {
+  std::vector<float> data(100003);
+  std::default_random_engine rng;
+  std::uniform_real_distribution<float> dist(-1e3f, 1e3f);
+  for (auto &e : data) {
+    e = dist(rng);
+  }
+  auto sum_chunk = [&data](size_t first, size_t last) {
+    float s = 0.0f;
+    for (size_t i = first; i < last; i++) {
+      s += data[i];
+    }
+    return s;
+  };
+  auto plus = [](float a, float b) { return a + b; };
+
+  set_parallel_threshold(1);
+  thread_pool pool(4), empty(0);
+  float s1 = parallel_reduce_chunks(pool, data.size(), 0.0f, sum_chunk, plus);
+  for (int k = 0; k < 10; k++) {
+    ASSERT_EQ(parallel_reduce_chunks(pool, data.size(), 0.0f, sum_chunk, plus),
+              s1);
+    ASSERT_EQ(parallel_reduce_chunks(empty, data.size(), 0.0f, sum_chunk, plus),
+              s1);
+  }
+  set_parallel_threshold(0);
+
+  ASSERT_EQ(parallel_reduce_chunks(pool, 0, 42.0f, sum_chunk, plus), 42.0f);
+}
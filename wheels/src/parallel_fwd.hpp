@@ -28,22 +28,50 @@
 
 namespace wheels {
 
+// thread_pool
+class thread_pool;
+inline thread_pool &default_thread_pool();
+
+// parallel_threshold
+inline size_t parallel_threshold();
+inline void set_parallel_threshold(size_t n);
+
 // parallel_for_each
 template <class FunT>
 void parallel_for_each(
     size_t n, FunT &&fun, size_t batch_num = 1,
     size_t concurrency_num = std::thread::hardware_concurrency());
+template <class FunT>
+void parallel_for_each(thread_pool &pool, size_t n, FunT &&fun,
+                       size_t batch_num = 1, size_t concurrency_num = 0);
 
 // parallel_for_each
 template <class IterT, class FunT>
 void parallel_for_each(
     IterT begin, IterT end, FunT &&fun, size_t batch_num = 1,
     size_t concurrency_num = std::thread::hardware_concurrency());
+template <class IterT, class FunT>
+void parallel_for_each(thread_pool &pool, IterT begin, IterT end, FunT &&fun,
+                       size_t batch_num = 1, size_t concurrency_num = 0);
+
+// parallel_reduce_chunks
+template <class T, class ChunkReduceT, class CombineT>
+T parallel_reduce_chunks(thread_pool &pool, size_t n, const T &identity,
+                         ChunkReduceT &&chunk_reduce, CombineT &&combine,
+                         size_t grain = 1 << 10);
+template <class T, class ChunkReduceT, class CombineT>
+T parallel_reduce_chunks(size_t n, const T &identity,
+                         ChunkReduceT &&chunk_reduce, CombineT &&combine,
+                         size_t grain = 1 << 10);
 
 // parallel_reduce
 template <class IterT, class T, class ReduceT>
 T parallel_reduce(IterT begin, IterT end, const T &initial, ReduceT &&redux,
                   size_t batch_num = 1,
                   size_t concurrency_num = std::thread::hardware_concurrency());
+template <class IterT, class T, class ReduceT>
+T parallel_reduce(thread_pool &pool, IterT begin, IterT end, const T &initial,
+                  ReduceT &&redux, size_t batch_num = 1,
+                  size_t concurrency_num = 0);
 
 }
@@ -0,0 +1,38 @@
+#include <benchmark/benchmark.h>
+
+#include "matrix.hpp"
+#include "permute.hpp"
+#include "tensor.hpp"
+
+using namespace wheels;
+using namespace wheels::literals;
+
+static void image_sides(benchmark::internal::Benchmark *b) {
+  b->RangeMultiplier(4)->Range(4, 8192);
+}
+
+// transpose
+static void permute_transpose(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx_<float> a(make_shape(n, n), 1.0f), r(make_shape(n, n));
+  for (auto _ : state) {
+    r = a.t();
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * n * n * sizeof(float) * 2);
+}
+BENCHMARK(permute_transpose)->Apply(image_sides);
+
+// rank 3 permute
+static void permute_rank3(benchmark::State &state) {
+  const size_t n = state.range(0);
+  tensor<float, tensor_shape<size_t, size_t, size_t, size_t>> a(
+      make_shape(n, n, 3), 1.0f),
+      r(make_shape(3, n, n));
+  for (auto _ : state) {
+    r = permute(a, 2_c, 0_c, 1_c);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * n * n * 3 * sizeof(float) * 2);
+}
+BENCHMARK(permute_rank3)->RangeMultiplier(4)->Range(4, 4096);
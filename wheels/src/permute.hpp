@@ -24,6 +24,11 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+
+#include "alias.hpp"
+#include "simd.hpp"
 #include "tensor_base.hpp"
 
 #include "permute_fwd.hpp"
@@ -127,6 +132,202 @@ constexpr bool any_of(const permute_result<ET, ShapeT, T, Inds...> &t) {
   return any_of(t.input);
 }
 
+// assign_elements(to, permute_result)
+// - permutes of continuous inputs are copied block by block: if the innermost
+//   axis stays innermost whole rows are copied, otherwise each 2d slice over
+//   the two innermost axes (of the input and of the output) is transposed by
+//   halving it recursively down to tiles of simd_transpose kernels
+namespace detail {
+static constexpr size_t _transpose_leaf_size = 32;
+static constexpr size_t _transpose_task_rows = 64;
+
+// dst[i * ldd + j] = src[j * lds + i], i < rows, j < cols
+template <class ToET, class FromET>
+void _transpose_leaf(const FromET *src, size_t lds, ToET *dst, size_t ldd,
+                     size_t rows, size_t cols, no) {
+  for (size_t i = 0; i < rows; i++) {
+    for (size_t j = 0; j < cols; j++) {
+      dst[i * ldd + j] = static_cast<ToET>(src[j * lds + i]);
+    }
+  }
+}
+template <class ET>
+void _transpose_leaf(const ET *src, size_t lds, ET *dst, size_t ldd,
+                     size_t rows, size_t cols, yes) {
+  using kernel_t = simd_transpose<ET>;
+  const size_t rows_k = rows / kernel_t::size * kernel_t::size;
+  const size_t cols_k = cols / kernel_t::size * kernel_t::size;
+  for (size_t i = 0; i < rows_k; i += kernel_t::size) {
+    for (size_t j = 0; j < cols_k; j += kernel_t::size) {
+      kernel_t::run(src + j * lds + i, lds, dst + i * ldd + j, ldd);
+    }
+    _transpose_leaf(src + cols_k * lds + i, lds, dst + i * ldd + cols_k, ldd,
+                    kernel_t::size, cols - cols_k, no());
+  }
+  _transpose_leaf(src + rows_k, lds, dst + rows_k * ldd, ldd, rows - rows_k,
+                  cols, no());
+}
+template <class ToET, class FromET, class UseSimdT>
+void _transpose_recursive(const FromET *src, size_t lds, ToET *dst, size_t ldd,
+                          size_t rows, size_t cols, UseSimdT use_simd) {
+  if (rows <= _transpose_leaf_size && cols <= _transpose_leaf_size) {
+    _transpose_leaf(src, lds, dst, ldd, rows, cols, use_simd);
+  } else if (rows >= cols) {
+    const size_t h = (rows / 2 + 7) / 8 * 8;
+    _transpose_recursive(src, lds, dst, ldd, h, cols, use_simd);
+    _transpose_recursive(src + h, lds, dst + h * ldd, ldd, rows - h, cols,
+                         use_simd);
+  } else {
+    const size_t h = (cols / 2 + 7) / 8 * 8;
+    _transpose_recursive(src, lds, dst, ldd, rows, h, use_simd);
+    _transpose_recursive(src + h * lds, lds, dst + h, ldd, rows, cols - h,
+                         use_simd);
+  }
+}
+
+// _permute_elements
+// - out_shape: shape of the output
+// - src_strides[k]: input stride along output axis k
+// - inner: the output axis that is innermost in the input
+template <class ToET, class FromET, size_t Rank>
+void _permute_elements(ToET *dst, const FromET *src,
+                       const std::array<size_t, Rank> &out_shape,
+                       const std::array<size_t, Rank> &src_strides,
+                       size_t inner) {
+  std::array<size_t, Rank> out_strides;
+  out_strides[Rank - 1] = 1;
+  for (size_t k = Rank - 1; k > 0; k--) {
+    out_strides[k - 1] = out_strides[k] * out_shape[k];
+  }
+  const size_t n = out_strides[0] * out_shape[0];
+  const size_t cols = out_shape[Rank - 1];
+  const size_t rows = inner == Rank - 1 ? 1 : out_shape[inner];
+  if (n == 0) {
+    return;
+  }
+  const size_t row_tasks =
+      (rows + _transpose_task_rows - 1) / _transpose_task_rows;
+  const size_t task_num = n / (rows * cols) * row_tasks;
+  auto task = [&](size_t t) {
+    // offsets of the slice, axes other than inner and the last one
+    size_t slice = t / row_tasks;
+    size_t src_off = 0, dst_off = 0;
+    for (size_t k = Rank - 1; k-- > 0;) {
+      if (k == inner) {
+        continue;
+      }
+      const size_t sub = slice % out_shape[k];
+      slice /= out_shape[k];
+      src_off += sub * src_strides[k];
+      dst_off += sub * out_strides[k];
+    }
+    const size_t first = t % row_tasks * _transpose_task_rows;
+    const size_t last = std::min(rows, first + _transpose_task_rows);
+    if (inner == Rank - 1) {
+      std::transform(src + src_off, src + src_off + cols, dst + dst_off,
+                     [](const FromET &e) { return static_cast<ToET>(e); });
+    } else {
+      _transpose_recursive(
+          src + src_off + first, src_strides[Rank - 1],
+          dst + dst_off + first * out_strides[inner], out_strides[inner],
+          last - first, cols, const_bool<std::is_same<ToET, FromET>::value>());
+    }
+  };
+  if (n < parallel_threshold() || task_num == 1) {
+    for (size_t t = 0; t < task_num; t++) {
+      task(t);
+    }
+  } else {
+    default_thread_pool().run(task_num, task);
+  }
+}
+
+template <class ShapeT, size_t... Is>
+constexpr std::array<size_t, sizeof...(Is)>
+_shape_as_array(const ShapeT &shape, const const_ints<size_t, Is...> &) {
+  return {{static_cast<size_t>(shape.at(const_index<Is>()))...}};
+}
+
+template <class ET, class ShapeT, class T, class PermuteT>
+void _assign_permute_result(no, tensor_continuous_data_base<ET, ShapeT, T> &to,
+                            const PermuteT &from) {
+  assign_elements(static_cast<tensor_core<T> &>(to),
+                  static_cast<const tensor_core<PermuteT> &>(from));
+}
+// small static transposes are unrolled through a local buffer
+template <size_t M, size_t N, class ToET, class FromET>
+void _small_transpose(const FromET *src, ToET *dst) {
+  ToET r[M * N];
+  for_each(make_const_sequence(const_size<M * N>()), [src, &r](auto ij) {
+    constexpr size_t i = decltype(ij)::value / N, j = decltype(ij)::value % N;
+    r[j * M + i] = static_cast<ToET>(src[i * N + j]);
+  });
+  std::copy_n(r, M * N, dst);
+}
+template <class ET, class ShapeT, class T, class EleT, class PShapeT,
+          class InputT, size_t... Inds>
+void _assign_permute_result_small(
+    yes, tensor_continuous_data_base<ET, ShapeT, T> &to,
+    const permute_result<EleT, PShapeT, InputT, Inds...> &from) {
+  const auto &in = from.input;
+  using m_t = std::decay_t<decltype(in.shape().at(const_index<0>()))>;
+  using n_t = std::decay_t<decltype(in.shape().at(const_index<1>()))>;
+  decltype(auto) s = from.shape();
+  if (to.shape() != s) {
+    reserve_shape(to.derived(), s);
+  }
+  _small_transpose<m_t::value, n_t::value>(in.ptr(), to.ptr());
+}
+template <class ET, class ShapeT, class T, class EleT, class PShapeT,
+          class InputT, size_t... Inds>
+void _assign_permute_result_small(
+    no, tensor_continuous_data_base<ET, ShapeT, T> &to,
+    const permute_result<EleT, PShapeT, InputT, Inds...> &from) {
+  constexpr size_t rank = sizeof...(Inds);
+  const auto &in = from.input;
+  // read the input shape before reshaping to, they may be the same tensor
+  const auto in_shape =
+      _shape_as_array(in.shape(), make_const_sequence(const_size<rank>()));
+  std::array<size_t, rank> in_strides;
+  in_strides[rank - 1] = 1;
+  for (size_t k = rank - 1; k > 0; k--) {
+    in_strides[k - 1] = in_strides[k] * in_shape[k];
+  }
+  const std::array<size_t, rank> out_shape = {{in_shape[Inds]...}};
+  const std::array<size_t, rank> src_strides = {{in_strides[Inds]...}};
+  const size_t inner = decltype(::wheels::find_first_of(
+      const_ints<size_t, Inds...>(), const_index<rank - 1>()))::value;
+
+  const auto *src = in.ptr();
+  // aliased, e.g. a = a.t()
+  const bool aliased = _may_read_from(yes(), in, to.ptr(), numel_of(to));
+  _assign_continuous(to, from.shape(), aliased, [&](ET *dst) {
+    _permute_elements(dst, src, out_shape, src_strides, inner);
+  });
+}
+template <class ET, class ShapeT, class T, class EleT, class PShapeT,
+          class InputT, size_t... Inds>
+void _assign_permute_result(
+    yes, tensor_continuous_data_base<ET, ShapeT, T> &to,
+    const permute_result<EleT, PShapeT, InputT, Inds...> &from) {
+  using in_shape_t = typename std::decay_t<InputT>::shape_type;
+  _assign_permute_result_small(
+      const_bool<std::is_same<const_ints<size_t, Inds...>,
+                              const_ints<size_t, 1, 0>>::value &&
+                 _is_small_static_shape<in_shape_t>::value>(),
+      to, from);
+}
+}
+template <class ET, class ShapeT, class T, class EleT, class PShapeT,
+          class InputT, size_t... Inds>
+void assign_elements(
+    tensor_continuous_data_base<ET, ShapeT, T> &to,
+    const permute_result<EleT, PShapeT, InputT, Inds...> &from) {
+  static_assert(ShapeT::rank == PShapeT::rank, "shape ranks mismatch!");
+  detail::_assign_permute_result(
+      decltype(detail::_is_continuous_data(from.input))(), to, from);
+}
+
 namespace detail {
 template <class ET, class ShapeT, class T, size_t... Inds>
 constexpr permute_result<ET, ShapeT, T, Inds...>
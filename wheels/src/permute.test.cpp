@@ -29,4 +29,45 @@ TEST(tensor, transpose) {
   ASSERT_TRUE(m.t() == m.t());
   ASSERT_TRUE(m.t().t() == m);
   ASSERT_TRUE(type_of(m.t().t()) == type_of(m));
-}
\ No newline at end of file
+}
+TEST(tensor, permute_blocked) {
+  std::default_random_engine rng;
+  for (auto mn : {std::make_pair(1, 1), std::make_pair(3, 7),
+                  std::make_pair(33, 65), std::make_pair(257, 130)}) {
+    auto m = rand(make_shape(mn.first, mn.second), rng);
+    matx mt = m.t();
+    matx_<float> mtf(m.t()), mf(m);
+    matx_<float> mft = mf.t();
+    matx_<int> mi(m * 100.0);
+    matx_<int> mit = mi.t();
+    for (int i = 0; i < mn.first; i++) {
+      for (int j = 0; j < mn.second; j++) {
+        ASSERT_EQ(mt(j, i), m(i, j));
+        ASSERT_EQ(mft(j, i), mf(i, j));
+        ASSERT_EQ(mit(j, i), mi(i, j));
+      }
+    }
+    ASSERT_TRUE(mtf == mft);
+  }
+
+  auto t = rand(make_shape(3, 20, 5, 40), rng);
+  tensor<double, decltype(make_shape(40, 3, 5, 20))> p1 =
+      t.permuted(3_c, 0_c, 2_c, 1_c);
+  tensor<double, decltype(make_shape(20, 3, 5, 40))> p2 =
+      t.permuted(1_c, 0_c, 2_c, 3_c);
+  for_each_subscript(t.shape(), [&](auto s0, auto s1, auto s2, auto s3) {
+    ASSERT_EQ(t(s0, s1, s2, s3), p1(s3, s0, s2, s1));
+    ASSERT_EQ(t(s0, s1, s2, s3), p2(s1, s0, s2, s3));
+  });
+
+  // aliased destination
+  auto a = rand(make_shape(50, 50), rng);
+  matx at = a.t();
+  a = a.t();
+  ASSERT_TRUE(a == at);
+  matx b = rand(make_shape(3, 5), rng);
+  matx bt = b.t();
+  b = b.t();
+  ASSERT_TRUE(b.shape() == make_shape(5, 3));
+  ASSERT_TRUE(b == bt);
+}
@@ -0,0 +1,50 @@
+#include <benchmark/benchmark.h>
+
+#include "reduce.hpp"
+#include "tensor.hpp"
+
+using namespace wheels;
+using namespace wheels::literals;
+
+static void image_sides(benchmark::internal::Benchmark *b) {
+  b->RangeMultiplier(4)->Range(4, 4096);
+}
+
+// per-row sums
+static void reduce_sum_rows(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx_<float> a(make_shape(n, n), 1.0f);
+  vecx_<float> r(make_shape(n));
+  for (auto _ : state) {
+    r = sum_along(a, 1_c);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * n * n * sizeof(float));
+}
+BENCHMARK(reduce_sum_rows)->Apply(image_sides);
+
+// per-column sums
+static void reduce_sum_cols(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx_<float> a(make_shape(n, n), 1.0f);
+  vecx_<float> r(make_shape(n));
+  for (auto _ : state) {
+    r = sum_along(a, 0_c);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * n * n * sizeof(float));
+}
+BENCHMARK(reduce_sum_cols)->Apply(image_sides);
+
+// per-column argmax
+static void reduce_argmax_cols(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx_<float> a(make_shape(n, n), 1.0f);
+  vecx_<size_t> r(make_shape(n));
+  for (auto _ : state) {
+    r = argmax_along(a, 0_c);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * n * n * sizeof(float));
+}
+BENCHMARK(reduce_argmax_cols)->Apply(image_sides);
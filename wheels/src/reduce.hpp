@@ -0,0 +1,418 @@
+/* * *
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Hao Yang (yangh2007@gmail.com)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include "alias.hpp"
+#include "simd.hpp"
+#include "tensor_base.hpp"
+
+#include "reduce_fwd.hpp"
+
+namespace wheels {
+
+// reducers
+// - fold the elements along an axis in ascending order:
+//   a = r.first(e0), r.next(a, ek, k) for k in [1, n), then r.result(a, n)
+// - sum, mean, min and max also merge partial results with combine(a, b)
+//   and simd packs with combine_packs, so that they can be vectorized
+namespace detail {
+template <class OpT> struct _op_reducer {
+  template <class E> using acc_type = E;
+  template <class E> using result_type = E;
+  template <class E> E first(const E &e) const { return e; }
+  template <class E> void next(E &a, const E &e, size_t) const {
+    a = op(a, e);
+  }
+  template <class E> E result(const E &a, size_t) const { return a; }
+  OpT op;
+};
+struct _sum_reducer {
+  template <class E> using acc_type = E;
+  template <class E> using result_type = E;
+  template <class E> E first(const E &e) const { return e; }
+  template <class E> void next(E &a, const E &e, size_t) const { a += e; }
+  template <class E> E result(const E &a, size_t) const { return a; }
+  template <class E> static E combine(const E &a, const E &b) { return a + b; }
+  template <class PackT>
+  static typename PackT::type combine_packs(const typename PackT::type &a,
+                                            const typename PackT::type &b) {
+    return PackT::add(a, b);
+  }
+};
+struct _mean_reducer : _sum_reducer {
+  template <class E> E result(const E &a, size_t n) const {
+    return a / static_cast<E>(n);
+  }
+};
+struct _min_reducer {
+  template <class E> using acc_type = E;
+  template <class E> using result_type = E;
+  template <class E> E first(const E &e) const { return e; }
+  template <class E> void next(E &a, const E &e, size_t) const {
+    a = combine(a, e);
+  }
+  template <class E> E result(const E &a, size_t) const { return a; }
+  template <class E> static E combine(const E &a, const E &b) {
+    return b < a ? b : a;
+  }
+  template <class PackT>
+  static typename PackT::type combine_packs(const typename PackT::type &a,
+                                            const typename PackT::type &b) {
+    return PackT::min(a, b);
+  }
+};
+struct _max_reducer {
+  template <class E> using acc_type = E;
+  template <class E> using result_type = E;
+  template <class E> E first(const E &e) const { return e; }
+  template <class E> void next(E &a, const E &e, size_t) const {
+    a = combine(a, e);
+  }
+  template <class E> E result(const E &a, size_t) const { return a; }
+  template <class E> static E combine(const E &a, const E &b) {
+    return a < b ? b : a;
+  }
+  template <class PackT>
+  static typename PackT::type combine_packs(const typename PackT::type &a,
+                                            const typename PackT::type &b) {
+    return PackT::max(a, b);
+  }
+};
+struct _argmin_reducer {
+  template <class E> using acc_type = std::pair<E, size_t>;
+  template <class E> using result_type = size_t;
+  template <class E> std::pair<E, size_t> first(const E &e) const {
+    return std::make_pair(e, size_t(0));
+  }
+  template <class E>
+  void next(std::pair<E, size_t> &a, const E &e, size_t k) const {
+    if (e < a.first) {
+      a = std::make_pair(e, k);
+    }
+  }
+  template <class E>
+  size_t result(const std::pair<E, size_t> &a, size_t) const {
+    return a.second;
+  }
+};
+struct _argmax_reducer {
+  template <class E> using acc_type = std::pair<E, size_t>;
+  template <class E> using result_type = size_t;
+  template <class E> std::pair<E, size_t> first(const E &e) const {
+    return std::make_pair(e, size_t(0));
+  }
+  template <class E>
+  void next(std::pair<E, size_t> &a, const E &e, size_t k) const {
+    if (a.first < e) {
+      a = std::make_pair(e, k);
+    }
+  }
+  template <class E>
+  size_t result(const std::pair<E, size_t> &a, size_t) const {
+    return a.second;
+  }
+};
+
+// whether reducing elements of E with ReducerT is vectorized
+template <class ReducerT, class E> struct _is_simd_reducer : no {};
+template <class E>
+struct _is_simd_reducer<_sum_reducer, E>
+    : const_bool<(simd_pack<E>::size > 1)> {};
+template <class E>
+struct _is_simd_reducer<_mean_reducer, E>
+    : const_bool<(simd_pack<E>::size > 1)> {};
+template <class E>
+struct _is_simd_reducer<_min_reducer, E>
+    : const_bool<(simd_pack<E>::size > 1)> {};
+template <class E>
+struct _is_simd_reducer<_max_reducer, E>
+    : const_bool<(simd_pack<E>::size > 1)> {};
+}
+
+// reduce_along_result
+template <class ET, class ShapeT, class ReducerT, class T, size_t Axis>
+class reduce_along_result
+    : public tensor_base<ET, ShapeT,
+                         reduce_along_result<ET, ShapeT, ReducerT, T, Axis>> {
+public:
+  using value_type = ET;
+  using shape_type = ShapeT;
+  constexpr reduce_along_result(T &&in, const ShapeT &s, ReducerT r)
+      : input(std::forward<T>(in)), reducer(r), _shape(s) {}
+  constexpr const ShapeT &shape() const { return _shape; }
+
+public:
+  T input;
+  ReducerT reducer;
+
+private:
+  ShapeT _shape;
+};
+
+// shape_of
+template <class ET, class ShapeT, class ReducerT, class T, size_t Axis>
+constexpr decltype(auto)
+shape_of(const reduce_along_result<ET, ShapeT, ReducerT, T, Axis> &r) {
+  return r.shape();
+}
+
+// element_at
+// - folds the elements along the axis one by one
+namespace detail {
+template <size_t Axis, class InputT, size_t N, size_t... Is>
+constexpr decltype(auto)
+_element_along(const InputT &in, size_t k, const std::array<size_t, N> &subs,
+               const const_ints<size_t, Is...> &) {
+  return element_at(in, (Is == Axis ? k : subs[Is - (Is > Axis ? 1 : 0)])...);
+}
+}
+template <class ET, class ShapeT, class ReducerT, class T, size_t Axis,
+          class... SubTs>
+ET element_at(const reduce_along_result<ET, ShapeT, ReducerT, T, Axis> &r,
+              const SubTs &... subs) {
+  assert(subscripts_are_valid(r.shape(), subs...));
+  using in_t = std::decay_t<T>;
+  using in_ele_t = typename in_t::value_type;
+  const size_t n = r.input.shape().at(const_index<Axis>());
+  if (n == 0) {
+    return ET();
+  }
+  const std::array<size_t, sizeof...(SubTs)> s = {{size_t(subs)...}};
+  const auto seq = make_const_sequence(const_size<sizeof...(SubTs) + 1>());
+  auto a = r.reducer.first(
+      static_cast<in_ele_t>(detail::_element_along<Axis>(r.input, 0, s, seq)));
+  for (size_t k = 1; k < n; k++) {
+    r.reducer.next(a, static_cast<in_ele_t>(detail::_element_along<Axis>(
+                          r.input, k, s, seq)),
+                   k);
+  }
+  return r.reducer.result(a, n);
+}
+
+// assign_elements(to, reduce_along_result)
+// - continuous inputs are viewed as [outer, n, inner] where n is the size of
+//   the reduced axis
+// - if inner == 1 each output reduces a contiguous row of n elements, with
+//   several independent simd accumulators when possible
+// - otherwise the rows of n are streamed one after another into a block of
+//   inner accumulators that stays in cache
+// - both are split across the thread pool on the kept axes
+namespace detail {
+static constexpr size_t _reduce_block = 256;
+
+// _reduce_row: reduces row[0, n), n > 0
+template <class ReducerT, class E>
+auto _reduce_row(no, const ReducerT &r, const E *row, size_t n) {
+  auto a = r.first(row[0]);
+  for (size_t k = 1; k < n; k++) {
+    r.next(a, row[k], k);
+  }
+  return a;
+}
+template <class ReducerT, class E>
+E _reduce_row(yes, const ReducerT &r, const E *row, size_t n) {
+  using pack = simd_pack<E>;
+  constexpr size_t w = pack::size;
+  if (n < 4 * w) {
+    return _reduce_row(no(), r, row, n);
+  }
+  typename pack::type acc[4] = {pack::load(row), pack::load(row + w),
+                                pack::load(row + 2 * w),
+                                pack::load(row + 3 * w)};
+  size_t k = 4 * w;
+  for (; k + 4 * w <= n; k += 4 * w) {
+    for (size_t j = 0; j < 4; j++) {
+      acc[j] = ReducerT::template combine_packs<pack>(
+          acc[j], pack::load(row + k + j * w));
+    }
+  }
+  acc[0] = ReducerT::template combine_packs<pack>(acc[0], acc[1]);
+  acc[2] = ReducerT::template combine_packs<pack>(acc[2], acc[3]);
+  acc[0] = ReducerT::template combine_packs<pack>(acc[0], acc[2]);
+  E lanes[w];
+  pack::store(lanes, acc[0]);
+  E a = lanes[0];
+  for (size_t j = 1; j < w; j++) {
+    a = ReducerT::combine(a, lanes[j]);
+  }
+  for (; k < n; k++) {
+    a = ReducerT::combine(a, row[k]);
+  }
+  return a;
+}
+
+// _reduce_rows: acc[j] folds src[k * inner + j] for k in [0, n), j < m
+template <class ReducerT, class E, class AccT>
+void _reduce_rows(no, const ReducerT &r, const E *src, size_t n, size_t inner,
+                  size_t m, AccT *acc) {
+  for (size_t j = 0; j < m; j++) {
+    acc[j] = r.first(src[j]);
+  }
+  for (size_t k = 1; k < n; k++) {
+    const E *row = src + k * inner;
+    for (size_t j = 0; j < m; j++) {
+      r.next(acc[j], row[j], k);
+    }
+  }
+}
+template <class ReducerT, class E>
+void _reduce_rows(yes, const ReducerT &, const E *src, size_t n, size_t inner,
+                  size_t m, E *acc) {
+  using pack = simd_pack<E>;
+  constexpr size_t w = pack::size;
+  std::copy(src, src + m, acc);
+  for (size_t k = 1; k < n; k++) {
+    const E *row = src + k * inner;
+    size_t j = 0;
+    for (; j + w <= m; j += w) {
+      pack::store(acc + j, ReducerT::template combine_packs<pack>(
+                               pack::load(acc + j), pack::load(row + j)));
+    }
+    for (; j < m; j++) {
+      acc[j] = ReducerT::combine(acc[j], row[j]);
+    }
+  }
+}
+
+template <class ToET, class E, class ReducerT>
+void _reduce_along_elements(ToET *dst, const E *src, const ReducerT &r,
+                            size_t outer, size_t n, size_t inner) {
+  using simd_t = const_bool<_is_simd_reducer<ReducerT, E>::value>;
+  using acc_t = typename ReducerT::template acc_type<E>;
+  const size_t m = outer * inner;
+  if (m == 0) {
+    return;
+  }
+  if (n == 0) {
+    std::fill(dst, dst + m, ToET());
+    return;
+  }
+  auto &pool = default_thread_pool();
+  const bool parallel = m > 1 && m * n >= parallel_threshold();
+  const size_t chunk_num = parallel ? (pool.worker_num() + 1) * 4 : 1;
+  if (inner == 1) {
+    const size_t chunk_size = (outer + chunk_num - 1) / chunk_num;
+    auto task = [=, &r](size_t c) {
+      const size_t last = std::min(outer, (c + 1) * chunk_size);
+      for (size_t o = c * chunk_size; o < last; o++) {
+        dst[o] = static_cast<ToET>(
+            r.result(_reduce_row(simd_t(), r, src + o * n, n), n));
+      }
+    };
+    pool.run((outer + chunk_size - 1) / chunk_size, task,
+             parallel ? 0 : 1);
+    return;
+  }
+  const size_t block_num = (inner + _reduce_block - 1) / _reduce_block;
+  auto task = [=, &r](size_t t) {
+    const size_t o = t / block_num;
+    const size_t first = (t % block_num) * _reduce_block;
+    const size_t len = std::min(_reduce_block, inner - first);
+    std::array<acc_t, _reduce_block> acc;
+    _reduce_rows(simd_t(), r, src + o * n * inner + first, n, inner, len,
+                 acc.data());
+    ToET *out = dst + o * inner + first;
+    for (size_t j = 0; j < len; j++) {
+      out[j] = static_cast<ToET>(r.result(acc[j], n));
+    }
+  };
+  pool.run(outer * block_num, task, parallel ? 0 : 1);
+}
+
+template <class ShapeT, size_t... Is>
+constexpr size_t _shape_mag_between(const ShapeT &shape,
+                                    const const_ints<size_t, Is...> &) {
+  size_t mags[] = {size_t(1), static_cast<size_t>(shape.at(const_index<Is>()))...};
+  size_t m = 1;
+  for (size_t s : mags) {
+    m *= s;
+  }
+  return m;
+}
+
+template <class ET, class ShapeT, class T, class ReduceT>
+void _assign_reduce_along_result(no, tensor_continuous_data_base<ET, ShapeT, T> &to,
+                                 const ReduceT &from) {
+  assign_elements(static_cast<tensor_core<T> &>(to),
+                  static_cast<const tensor_core<ReduceT> &>(from));
+}
+template <class ET, class ShapeT, class T, class EleT, class RShapeT,
+          class ReducerT, class InputT, size_t Axis>
+void _assign_reduce_along_result(
+    yes, tensor_continuous_data_base<ET, ShapeT, T> &to,
+    const reduce_along_result<EleT, RShapeT, ReducerT, InputT, Axis> &from) {
+  const auto &in = from.input;
+  constexpr size_t rank = std::decay_t<decltype(in.shape())>::rank;
+  const size_t outer = _shape_mag_between(
+      in.shape(), make_const_range(const_size<0>(), const_size<Axis>()));
+  const size_t inner = _shape_mag_between(
+      in.shape(), make_const_range(const_size<Axis + 1>(), const_size<rank>()));
+  const size_t n = in.shape().at(const_index<Axis>());
+  const auto *src = in.ptr();
+  // aliased, e.g. through a tensor_map of the input
+  const bool aliased = _may_read_from(yes(), in, to.ptr(), numel_of(to));
+  _assign_continuous(to, from.shape(), aliased, [&](ET *dst) {
+    _reduce_along_elements(dst, src, from.reducer, outer, n, inner);
+  });
+}
+}
+template <class ET, class ShapeT, class T, class EleT, class RShapeT,
+          class ReducerT, class InputT, size_t Axis>
+void assign_elements(
+    tensor_continuous_data_base<ET, ShapeT, T> &to,
+    const reduce_along_result<EleT, RShapeT, ReducerT, InputT, Axis> &from) {
+  static_assert(ShapeT::rank == RShapeT::rank, "shape ranks mismatch!");
+  detail::_assign_reduce_along_result(
+      decltype(detail::_is_continuous_data(from.input))(), to, from);
+}
+
+// reduce_along
+namespace detail {
+template <class ShapeT, size_t... Is>
+constexpr auto _shape_of_axes(const ShapeT &shape,
+                              const const_ints<size_t, Is...> &) {
+  return make_shape(shape.at(const_index<Is>())...);
+}
+template <class ET, class ShapeT, class T, class TT, class K, K Axis,
+          class ReducerT>
+constexpr auto _reduce_along(const tensor_base<ET, ShapeT, T> &, TT &&t,
+                             const const_ints<K, Axis> &, ReducerT r) {
+  static_assert(Axis >= 0 && (size_t)Axis < ShapeT::rank, "invalid axis");
+  constexpr size_t axis = Axis;
+  const auto kept =
+      cat2(make_const_range(const_size<0>(), const_size<axis>()),
+           make_const_range(const_size<axis + 1>(), const_size<ShapeT::rank>()));
+  using shape_t = decltype(_shape_of_axes(t.shape(), kept));
+  using result_t = typename ReducerT::template result_type<ET>;
+  const shape_t s = _shape_of_axes(t.shape(), kept);
+  return reduce_along_result<result_t, shape_t, ReducerT, TT, axis>(
+      std::forward<TT>(t), s, r);
+}
+}
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include "ewise.hpp"
+#include "reduce.hpp"
+#include "tensor.hpp"
+
+using namespace wheels;
+using namespace wheels::literals;
+
+TEST(tensor, reduce_along) {
+  std::default_random_engine rng;
+  for (auto mn : {std::make_pair(1, 1), std::make_pair(3, 7),
+                  std::make_pair(33, 65), std::make_pair(300, 1000)}) {
+    const size_t m = mn.first, n = mn.second;
+    matx_<float> a(rand(make_shape(m, n), rng));
+    vecx_<float> rows = sum_along(a, 1_c), cols = sum_along(a, 0_c);
+    vecx_<float> row_means = mean_along(a, 1_c);
+    vecx_<float> col_mins = min_along(a, 0_c), row_maxs = max_along(a, 1_c);
+    vecx_<size_t> col_argmaxs = argmax_along(a, 0_c);
+    vecx_<size_t> row_argmins = argmin_along(a, 1_c);
+    ASSERT_EQ(rows.numel(), m);
+    ASSERT_EQ(cols.numel(), n);
+    for (size_t i = 0; i < m; i++) {
+      double s = 0;
+      float mx = a(i, 0);
+      size_t amin = 0;
+      for (size_t j = 0; j < n; j++) {
+        s += a(i, j);
+        mx = std::max(mx, a(i, j));
+        if (a(i, j) < a(i, amin)) {
+          amin = j;
+        }
+      }
+      ASSERT_NEAR(rows[i], s, 1e-3 * n);
+      ASSERT_NEAR(row_means[i], s / n, 1e-3);
+      ASSERT_NEAR(sum_along(a, 1_c)(i), s, 1e-3 * n); // lazy
+      ASSERT_NEAR(a.sum_along(1_c)(i), s, 1e-3 * n);
+      ASSERT_EQ(row_maxs[i], mx);
+      ASSERT_EQ(row_argmins[i], amin);
+    }
+    for (size_t j = 0; j < n; j++) {
+      double s = 0;
+      float mn = a(0, j);
+      size_t amax = 0;
+      for (size_t i = 0; i < m; i++) {
+        s += a(i, j);
+        mn = std::min(mn, a(i, j));
+        if (a(amax, j) < a(i, j)) {
+          amax = i;
+        }
+      }
+      ASSERT_NEAR(cols[j], s, 1e-3 * m);
+      ASSERT_EQ(col_mins[j], mn);
+      ASSERT_EQ(col_argmaxs[j], amax);
+    }
+  }
+
+  // middle axis of a rank 3 tensor, user op, non continuous input
+  tensor<int, tensor_shape<size_t, size_t, size_t, size_t>> t(
+      make_shape(4, 5, 300));
+  for (size_t i = 0; i < t.numel(); i++) {
+    t[i] = int(i % 7);
+  }
+  auto prod = [](int a, int b) { return a * 3 + b; };
+  // op is not associative, elements are folded in order
+  matx_<int> r = reduce_along(t, 1_c, prod);
+  matx_<int> re = reduce_along(t.ewised() + 0, 1_c, prod);
+  ASSERT_TRUE(r == re);
+  ASSERT_TRUE(r == t.reduce_along(1_c, prod));
+  ASSERT_TRUE(max_along(t, 2_c) == t.max_along(2_c));
+  ASSERT_TRUE(argmin_along(t, 0_c) == (t.ewised() + 0).argmin_along(0_c));
+  for (size_t i = 0; i < 4; i++) {
+    for (size_t k = 0; k < 300; k++) {
+      int e = t(i, 0, k);
+      for (size_t j = 1; j < 5; j++) {
+        e = prod(e, t(i, j, k));
+      }
+      ASSERT_EQ(r(i, k), e);
+    }
+  }
+  matx_<double> empty(make_shape(3, 0));
+  vecx rs = sum_along(empty, 1_c);
+  ASSERT_EQ(rs.numel(), 3);
+  ASSERT_EQ(rs[2], 0.0);
+}
@@ -0,0 +1,121 @@
+/* * *
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Hao Yang (yangh2007@gmail.com)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * */
+
+#pragma once
+
+#include "tensor_base_fwd.hpp"
+
+namespace wheels {
+
+// reduce_along_result
+template <class ET, class ShapeT, class ReducerT, class T, size_t Axis>
+class reduce_along_result;
+
+namespace detail {
+// reducers, see reduce.hpp
+template <class OpT> struct _op_reducer;
+struct _sum_reducer;
+struct _mean_reducer;
+struct _min_reducer;
+struct _max_reducer;
+struct _argmin_reducer;
+struct _argmax_reducer;
+
+template <class ET, class ShapeT, class T, class TT, class K, K Axis,
+          class ReducerT>
+constexpr auto _reduce_along(const tensor_base<ET, ShapeT, T> &, TT &&t,
+                             const const_ints<K, Axis> &, ReducerT r);
+}
+
+// reduce_along(t, axis, op)
+// - reduces the axis-th axis of t with op, the result keeps the other axes
+//   of t
+// - the elements along the axis are folded in ascending order,
+//   a = op(a, e) starting from the first one, so op need not be associative,
+//   only the kept axes are split across threads
+// - elements along an empty axis reduce to value_type()
+template <class T, class K, K Axis, class OpT>
+constexpr auto reduce_along(T &&t, const const_ints<K, Axis> &axis, OpT op)
+    -> decltype(detail::_reduce_along(t, std::forward<T>(t), axis,
+                                      detail::_op_reducer<OpT>{op})) {
+  return detail::_reduce_along(t, std::forward<T>(t), axis,
+                               detail::_op_reducer<OpT>{op});
+}
+
+// sum_along(t, axis)
+template <class T, class K, K Axis>
+constexpr auto sum_along(T &&t, const const_ints<K, Axis> &axis)
+    -> decltype(detail::_reduce_along(t, std::forward<T>(t), axis,
+                                      detail::_sum_reducer())) {
+  return detail::_reduce_along(t, std::forward<T>(t), axis,
+                               detail::_sum_reducer());
+}
+
+// mean_along(t, axis)
+template <class T, class K, K Axis>
+constexpr auto mean_along(T &&t, const const_ints<K, Axis> &axis)
+    -> decltype(detail::_reduce_along(t, std::forward<T>(t), axis,
+                                      detail::_mean_reducer())) {
+  return detail::_reduce_along(t, std::forward<T>(t), axis,
+                               detail::_mean_reducer());
+}
+
+// min_along(t, axis)
+template <class T, class K, K Axis>
+constexpr auto min_along(T &&t, const const_ints<K, Axis> &axis)
+    -> decltype(detail::_reduce_along(t, std::forward<T>(t), axis,
+                                      detail::_min_reducer())) {
+  return detail::_reduce_along(t, std::forward<T>(t), axis,
+                               detail::_min_reducer());
+}
+
+// max_along(t, axis)
+template <class T, class K, K Axis>
+constexpr auto max_along(T &&t, const const_ints<K, Axis> &axis)
+    -> decltype(detail::_reduce_along(t, std::forward<T>(t), axis,
+                                      detail::_max_reducer())) {
+  return detail::_reduce_along(t, std::forward<T>(t), axis,
+                               detail::_max_reducer());
+}
+
+// argmin_along(t, axis)
+// - subscripts along axis of the first minimum, as size_t
+template <class T, class K, K Axis>
+constexpr auto argmin_along(T &&t, const const_ints<K, Axis> &axis)
+    -> decltype(detail::_reduce_along(t, std::forward<T>(t), axis,
+                                      detail::_argmin_reducer())) {
+  return detail::_reduce_along(t, std::forward<T>(t), axis,
+                               detail::_argmin_reducer());
+}
+
+// argmax_along(t, axis)
+// - subscripts along axis of the first maximum, as size_t
+template <class T, class K, K Axis>
+constexpr auto argmax_along(T &&t, const const_ints<K, Axis> &axis)
+    -> decltype(detail::_reduce_along(t, std::forward<T>(t), axis,
+                                      detail::_argmax_reducer())) {
+  return detail::_reduce_along(t, std::forward<T>(t), axis,
+                               detail::_argmax_reducer());
+}
+}
@@ -0,0 +1,48 @@
+#include <benchmark/benchmark.h>
+
+#include "remap.hpp"
+#include "tensor.hpp"
+
+using namespace wheels;
+
+// side lengths of square images, 16 to ~10^8 pixels
+static void image_sides(benchmark::internal::Benchmark *b) {
+  b->RangeMultiplier(4)->Range(4, 8192);
+}
+
+// resample
+static void remap_resample_down(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx_<float> im(make_shape(n, n), 1.0f), out(make_shape(n / 2, n / 2));
+  for (auto _ : state) {
+    out = resample(im, make_shape(n / 2, n / 2));
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * n * n);
+}
+BENCHMARK(remap_resample_down)->Apply(image_sides);
+
+static void remap_resample_up(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx_<float> im(make_shape(n / 2, n / 2), 1.0f), out(make_shape(n, n));
+  for (auto _ : state) {
+    out = resample(im, make_shape(n, n));
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * n * n);
+}
+BENCHMARK(remap_resample_up)->Apply(image_sides);
+
+// remap with a custom map
+static void remap_shift(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx_<float> im(make_shape(n, n), 1.0f), out(make_shape(n, n));
+  for (auto _ : state) {
+    out = remap(im, make_shape(n, n), [](size_t i, size_t j) {
+      return std::array<double, 2>{{i + 0.5, j + 0.5}};
+    });
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * n * n);
+}
+BENCHMARK(remap_shift)->Apply(image_sides);
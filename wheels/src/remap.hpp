@@ -24,6 +24,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "simd.hpp"
 #include "tensor_base.hpp"
 #include "tensor.hpp"
 
@@ -184,9 +191,11 @@ template <class FromShapeT, class ToShapeT> struct _resample_map_functor {
   constexpr auto _invoke_seq(NewSubsTupleT &&new_subs,
                              const const_ints<size_t, Is...> &) const {
     return std::array<double, sizeof...(Is)>{
-        {static_cast<double>(std::get<Is>(new_subs)) *
-         (from_shape.at(const_index<Is>()) - 1.0) /
-         (to_shape.at(const_index<Is>()) - 1.0)...}};
+        {(to_shape.at(const_index<Is>()) > 1
+              ? static_cast<double>(std::get<Is>(new_subs)) *
+                    (from_shape.at(const_index<Is>()) - 1.0) /
+                    (to_shape.at(const_index<Is>()) - 1.0)
+              : 0.0)...}};
   }
   template <class... SubTs> constexpr auto operator()(SubTs... new_subs) const {
     static_assert(FromShapeT::rank == sizeof...(new_subs),
@@ -203,4 +212,339 @@ _make_resample_map_functor(const FromShapeT &from_shape,
 }
 }
 
+// assign_elements(to, resample(t, shape))
+// - linear resampling of continuous tensors whose elements are arithmetic
+//   (or vec_ pixels of them) runs as one separable pass per resized axis,
+//   each pass blends two rows picked by a precomputed index/weight table and
+//   row ranges are spread over the thread pool
+// - 8-bit elements are blended in 11-bit fixed point and rounded, others in
+//   floating point and converted as the element-wise path does
+namespace detail {
+static constexpr int _resample_fixed_bits = 11;
+
+// _resample_pixel
+template <class ET, class = void> struct _resample_pixel : no {};
+template <class ET>
+struct _resample_pixel<ET, std::enable_if_t<std::is_arithmetic<ET>::value &&
+                                            !std::is_same<ET, bool>::value>>
+    : yes {
+  using scalar_type = ET;
+  static constexpr size_t channels = 1;
+};
+template <class T, class ST, size_t C>
+struct _resample_pixel<
+    tensor<T, tensor_shape<ST, const_size<C>>>,
+    std::enable_if_t<_resample_pixel<T>::value &&
+                     sizeof(tensor<T, tensor_shape<ST, const_size<C>>>) ==
+                         sizeof(T) * C>> : yes {
+  using scalar_type = T;
+  static constexpr size_t channels = C;
+};
+
+// _resample_blend_t: type of intermediate values
+template <class T>
+using _resample_blend_t = std::conditional_t<
+    std::is_integral<T>::value && sizeof(T) == 1, int32_t,
+    std::conditional_t<std::is_same<T, float>::value, float, double>>;
+
+// _resample_axis
+template <class WeightT> struct _resample_axis {
+  size_t axis;
+  std::vector<size_t> lo, hi;
+  std::vector<WeightT> w; // weight of hi
+};
+template <class WeightT>
+_resample_axis<WeightT> _make_resample_axis(size_t axis, size_t from,
+                                            size_t to) {
+  _resample_axis<WeightT> a;
+  a.axis = axis;
+  a.lo.resize(to);
+  a.hi.resize(to);
+  a.w.resize(to);
+  for (size_t i = 0; i < to; i++) {
+    const double x = to > 1 ? i * (from - 1.0) / (to - 1.0) : 0.0;
+    const size_t lo = std::min(static_cast<size_t>(x), from - 1);
+    const double w = x - lo;
+    a.lo[i] = lo;
+    a.hi[i] = std::min(lo + 1, from - 1);
+    a.w[i] = std::is_integral<WeightT>::value
+                 ? static_cast<WeightT>(w * (1 << _resample_fixed_bits) + 0.5)
+                 : static_cast<WeightT>(w);
+  }
+  return a;
+}
+
+// _resample_lerp
+template <class T> struct _resample_lerp {
+  template <class E> T operator()(const E &a, const E &b, T w) const {
+    return a * (T(1) - w) + b * w;
+  }
+};
+// _resample_fixed_lerp
+// - a, b carry InBits fractional bits, the result carries OutBits
+template <int InBits, int OutBits> struct _resample_fixed_lerp {
+  static constexpr int shift = InBits + _resample_fixed_bits - OutBits;
+  int32_t operator()(int32_t a, int32_t b, int32_t w) const {
+    const int32_t acc = a * ((1 << _resample_fixed_bits) - w) + b * w;
+    return shift == 0 ? acc : (acc + ((1 << shift) >> 1)) >> shift;
+  }
+};
+
+// _resample_row
+template <class ToT, class FromT, class WeightT, class LerpT>
+void _resample_row(ToT *dst, const FromT *a, const FromT *b, size_t n,
+                   WeightT w, const LerpT &lerp) {
+  for (size_t x = 0; x < n; x++) {
+    dst[x] = static_cast<ToT>(lerp(a[x], b[x], w));
+  }
+}
+template <class T>
+void _resample_row(T *dst, const T *a, const T *b, size_t n, T w,
+                   const _resample_lerp<T> &lerp) {
+  using pack_t = simd_pack<T>;
+  const auto wa = pack_t::set1(T(1) - w), wb = pack_t::set1(w);
+  size_t x = 0;
+  for (; x + pack_t::size <= n; x += pack_t::size) {
+    pack_t::store(dst + x, pack_t::fma(pack_t::load(b + x), wb,
+                                       pack_t::mul(pack_t::load(a + x), wa)));
+  }
+  for (; x < n; x++) {
+    dst[x] = lerp(a[x], b[x], w);
+  }
+}
+
+// _resample_pass
+// - resamples the middle axis of an (outer, from, inner) block into
+//   (outer, to, inner)
+template <class ToT, class FromT, class WeightT, class LerpT>
+void _resample_pass(ToT *dst, const FromT *src, size_t outer, size_t from,
+                    size_t inner, const _resample_axis<WeightT> &axis,
+                    const LerpT &lerp) {
+  const size_t to = axis.lo.size();
+  const size_t rows = outer * to;
+  auto rows_in = [&](size_t first, size_t last) {
+    size_t o = first / to, i = first % to;
+    for (size_t r = first; r < last; r++) {
+      const FromT *block = src + o * from * inner;
+      _resample_row(dst + r * inner, block + axis.lo[i] * inner,
+                    block + axis.hi[i] * inner, inner, axis.w[i], lerp);
+      if (++i == to) {
+        i = 0;
+        o++;
+      }
+    }
+  };
+  if (rows * inner < parallel_threshold() || rows == 1) {
+    rows_in(0, rows);
+    return;
+  }
+  auto &pool = default_thread_pool();
+  const size_t chunk_num = std::min(rows, (pool.worker_num() + 1) * 4);
+  const size_t chunk_size = (rows + chunk_num - 1) / chunk_num;
+  pool.run((rows + chunk_size - 1) / chunk_size, [&](size_t c) {
+    rows_in(c * chunk_size, std::min(rows, (c + 1) * chunk_size));
+  });
+}
+
+// _resample_lerps
+template <class BlendT> struct _resample_lerps {
+  using first_t = _resample_lerp<BlendT>;
+  using middle_t = _resample_lerp<BlendT>;
+  using last_t = _resample_lerp<BlendT>;
+  using only_t = _resample_lerp<BlendT>;
+};
+template <> struct _resample_lerps<int32_t> {
+  static constexpr int bits = _resample_fixed_bits;
+  using first_t = _resample_fixed_lerp<0, bits>;
+  using middle_t = _resample_fixed_lerp<bits, bits>;
+  using last_t = _resample_fixed_lerp<bits, 0>;
+  using only_t = _resample_fixed_lerp<0, 0>;
+};
+
+// _resample_rows_fused
+// - resamples both axes of a (rows, cols, channels) image in one sweep over
+//   the output rows, keeping the two horizontally resampled source rows that
+//   the current output row blends
+template <class T, class BlendT>
+void _resample_rows_fused(T *dst, const T *src, size_t cols_from,
+                          size_t channels, const _resample_axis<BlendT> &rows,
+                          const _resample_axis<BlendT> &cols) {
+  using lerps_t = _resample_lerps<BlendT>;
+  const size_t rows_to = rows.lo.size();
+  const size_t in_row = cols_from * channels;
+  const size_t out_row = cols.lo.size() * channels;
+  auto rows_in = [&](size_t first, size_t last) {
+    std::unique_ptr<BlendT[]> buf(new BlendT[out_row * 2]);
+    size_t held[2] = {size_t(-1), size_t(-1)};
+    // returns the slot holding source row r, keeps the one holding keep
+    auto row_at = [&](size_t r, size_t keep) -> const BlendT * {
+      for (int s = 0; s < 2; s++) {
+        if (held[s] == r) {
+          return buf.get() + s * out_row;
+        }
+      }
+      const int s = held[0] == keep ? 1 : 0;
+      BlendT *out = buf.get() + s * out_row;
+      const T *in = src + r * in_row;
+      for (size_t j = 0; j < cols.lo.size(); j++) {
+        _resample_row(out + j * channels, in + cols.lo[j] * channels,
+                      in + cols.hi[j] * channels, channels, cols.w[j],
+                      typename lerps_t::first_t());
+      }
+      held[s] = r;
+      return out;
+    };
+    for (size_t i = first; i < last; i++) {
+      const BlendT *lo = row_at(rows.lo[i], rows.hi[i]);
+      const BlendT *hi = row_at(rows.hi[i], rows.lo[i]);
+      _resample_row(dst + i * out_row, lo, hi, out_row, rows.w[i],
+                    typename lerps_t::last_t());
+    }
+  };
+  if (rows_to * out_row < parallel_threshold() || rows_to == 1) {
+    rows_in(0, rows_to);
+    return;
+  }
+  auto &pool = default_thread_pool();
+  const size_t chunk_num = std::min(rows_to, (pool.worker_num() + 1) * 4);
+  const size_t chunk_size = (rows_to + chunk_num - 1) / chunk_num;
+  pool.run((rows_to + chunk_size - 1) / chunk_size, [&](size_t c) {
+    rows_in(c * chunk_size, std::min(rows_to, (c + 1) * chunk_size));
+  });
+}
+
+// _resample_separable
+template <class T, size_t Rank>
+void _resample_separable(T *dst, const T *src,
+                         const std::array<size_t, Rank> &from,
+                         const std::array<size_t, Rank> &to, size_t channels) {
+  using blend_t = _resample_blend_t<T>;
+  using axis_t = _resample_axis<blend_t>;
+  // shrinking axes first
+  std::vector<axis_t> axes;
+  for (size_t k = 0; k < Rank; k++) {
+    if (from[k] != to[k]) {
+      axes.push_back(_make_resample_axis<blend_t>(k, from[k], to[k]));
+    }
+  }
+  std::sort(axes.begin(), axes.end(), [&](const axis_t &a, const axis_t &b) {
+    return to[a.axis] * from[b.axis] < to[b.axis] * from[a.axis];
+  });
+
+  size_t n = channels;
+  for (size_t k = 0; k < Rank; k++) {
+    n *= to[k];
+  }
+  if (axes.empty()) {
+    std::copy(src, src + n, dst);
+    return;
+  }
+  if (Rank == 2 && axes.size() == 2) {
+    const bool rows_first = axes[0].axis == 0;
+    _resample_rows_fused(dst, src, from[Rank - 1], channels,
+                         axes[rows_first ? 0 : 1], axes[rows_first ? 1 : 0]);
+    return;
+  }
+
+  std::array<size_t, Rank> cur = from;
+  std::unique_ptr<blend_t[]> bufs[2];
+  const blend_t *in = nullptr;
+  for (size_t p = 0; p < axes.size(); p++) {
+    const size_t k = axes[p].axis;
+    size_t outer = 1, inner = channels;
+    for (size_t j = 0; j < k; j++) {
+      outer *= cur[j];
+    }
+    for (size_t j = k + 1; j < Rank; j++) {
+      inner *= cur[j];
+    }
+    const bool first = p == 0, last = p + 1 == axes.size();
+    using lerps_t = _resample_lerps<blend_t>;
+    blend_t *out = nullptr;
+    if (!last) {
+      bufs[p % 2].reset(new blend_t[outer * to[k] * inner]);
+      out = bufs[p % 2].get();
+    }
+    if (first && last) {
+      _resample_pass(dst, src, outer, cur[k], inner, axes[p],
+                     typename lerps_t::only_t());
+    } else if (first) {
+      _resample_pass(out, src, outer, cur[k], inner, axes[p],
+                     typename lerps_t::first_t());
+    } else if (last) {
+      _resample_pass(dst, in, outer, cur[k], inner, axes[p],
+                     typename lerps_t::last_t());
+    } else {
+      _resample_pass(out, in, outer, cur[k], inner, axes[p],
+                     typename lerps_t::middle_t());
+    }
+    in = out;
+    cur[k] = to[k];
+  }
+}
+
+template <class ShapeT, size_t... Is>
+std::array<size_t, sizeof...(Is)>
+_resample_shape_array(const ShapeT &shape, const const_ints<size_t, Is...> &) {
+  return {{static_cast<size_t>(shape.at(const_index<Is>()))...}};
+}
+
+template <class ET, class ShapeT, class T, class RemapT>
+void _assign_resample_result(no, tensor_continuous_data_base<ET, ShapeT, T> &to,
+                             const RemapT &from) {
+  assign_elements(static_cast<tensor_core<T> &>(to),
+                  static_cast<const tensor_core<RemapT> &>(from));
+}
+template <class ET, class ShapeT, class T, class RemapT>
+void _assign_resample_result(yes,
+                             tensor_continuous_data_base<ET, ShapeT, T> &to,
+                             const RemapT &from) {
+  using pixel_t = _resample_pixel<ET>;
+  using scalar_t = typename pixel_t::scalar_type;
+  constexpr size_t rank = ShapeT::rank;
+  const auto seq = make_const_sequence(const_size<rank>());
+  const auto in_shape = _resample_shape_array(from.input().shape(), seq);
+  const auto out_shape = _resample_shape_array(from.shape(), seq);
+  const size_t in_n = numel_of(from.input()), out_n = numel_of(from);
+  if (in_n == 0 || out_n == 0) {
+    reserve_shape(to.derived(), from.shape());
+    return;
+  }
+  const ET *src = from.input().ptr();
+  const ET *old_dst = to.ptr();
+  if (old_dst != nullptr && src < old_dst + numel_of(to) &&
+      old_dst < src + in_n) {
+    // aliased, e.g. im = im.resampled(s)
+    std::unique_ptr<scalar_t[]> result(new scalar_t[out_n * pixel_t::channels]);
+    _resample_separable(result.get(),
+                        reinterpret_cast<const scalar_t *>(src), in_shape,
+                        out_shape, pixel_t::channels);
+    if (to.shape() != from.shape()) {
+      reserve_shape(to.derived(), from.shape());
+    }
+    std::copy(result.get(), result.get() + out_n * pixel_t::channels,
+              reinterpret_cast<scalar_t *>(to.ptr()));
+    return;
+  }
+  if (to.shape() != from.shape()) {
+    reserve_shape(to.derived(), from.shape());
+  }
+  _resample_separable(reinterpret_cast<scalar_t *>(to.ptr()),
+                      reinterpret_cast<const scalar_t *>(src), in_shape,
+                      out_shape, pixel_t::channels);
+}
+}
+template <class ET, class ShapeT, class T, class RShapeT, class InputT,
+          class FromShapeT, class ToShapeT>
+void assign_elements(
+    tensor_continuous_data_base<ET, ShapeT, T> &to,
+    const remap_result<ET, RShapeT, InputT,
+                       detail::_resample_map_functor<FromShapeT, ToShapeT>,
+                       linear_interpolate> &from) {
+  static_assert(ShapeT::rank == RShapeT::rank, "shape ranks mismatch!");
+  using use_separable_t = const_bool<
+      detail::_resample_pixel<ET>::value &&
+      decltype(detail::_is_continuous_data(from.input()))::value>;
+  detail::_assign_resample_result(use_separable_t(), to, from);
+}
 }
\ No newline at end of file
@@ -18,4 +18,48 @@ TEST(tensor, resample) {
   auto zz2re = resample(zz2, make_shape((size_t)100, (size_t)150)).eval();
   auto zz2re2 = resample(zz2, make_shape((size_t)400, (size_t)600)).eval();
   println(zz2re2.shape());
-}
\ No newline at end of file
+}
+TEST(tensor, resample_separable) {
+  std::default_random_engine rng;
+  auto zz = rand(make_shape(37, 53), rng);
+  for (auto s : {make_shape(37, 53), make_shape(20, 81), make_shape(80, 9),
+                 make_shape(1, 30), make_shape(64, 1)}) {
+    auto r = resample(zz, s);
+    matx zzre = r;
+    matx_<float> zzfre = resample(matx_<float>(zz), s);
+    ASSERT_TRUE(zzre.shape() == s);
+    for_each_subscript(s, [&](auto i, auto j) {
+      ASSERT_NEAR(zzre(i, j), r(i, j), 1e-9);
+      ASSERT_NEAR(zzfre(i, j), r(i, j), 1e-5);
+    });
+  }
+
+  // 8-bit pixels in fixed point
+  tensor<vec_<uint8_t, 3>, decltype(make_shape(45, 61))> im(make_shape(45, 61));
+  std::uniform_int_distribution<int> byte(0, 255);
+  for (auto &p : im) {
+    p = vec_<uint8_t, 3>(byte(rng), byte(rng), byte(rng));
+  }
+  auto s = make_shape(100, 29);
+  auto r = resample(im, s);
+  decltype(im) imre = r;
+  for_each_subscript(s, [&](auto i, auto j) {
+    for (int c = 0; c < 3; c++) {
+      ASSERT_LE(std::abs(int(imre(i, j)[c]) - int(r(i, j)[c])), 1);
+    }
+  });
+
+  // rank 3
+  auto vol = rand(make_shape(6, 7, 8), rng);
+  auto vs = make_shape(11, 4, 8);
+  auto rv = resample(vol, vs);
+  tensor<double, decltype(vs)> volre = rv;
+  for_each_subscript(vs, [&](auto i, auto j, auto k) {
+    ASSERT_NEAR(volre(i, j, k), rv(i, j, k), 1e-9);
+  });
+
+  // aliased destination
+  matx a = zz;
+  a = resample(a, make_shape(10, 10));
+  ASSERT_TRUE(a == resample(zz, make_shape(10, 10)).eval());
+}
@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include <array>
+
 #include "const_ints.hpp"
 #include "utility.hpp"
 
@@ -176,6 +178,23 @@ public:
     return mag_at(const_index<Idx>());
   }
 
+  // stride_at
+  // - distance between linear indices of neighboring subscripts at Idx, it
+  //   is a const_ints when all the following sizes are static, otherwise it
+  //   is read from the cached magnitude of the following dynamic size
+  template <size_t Idx>
+  constexpr auto stride_at(const const_index<Idx> &) const {
+    static_assert(Idx < rank, "Idx too large");
+    return rest().stride_at(const_index<Idx - 1>());
+  }
+  constexpr auto stride_at(const const_index<0> &) const {
+    return rest().magnitude();
+  }
+  template <class K, K Idx, wheels_enable_if(!(std::is_same<K, size_t>::value))>
+  constexpr auto stride_at(const const_ints<K, Idx> &) const {
+    return stride_at(const_index<Idx>());
+  }
+
   template <class Archive> void serialize(Archive &ar) {
     T val = value(), mag = magnitude();
     ar(val, mag);
@@ -292,6 +311,23 @@ public:
     return mag_at(const_index<Idx>());
   }
 
+  // stride_at
+  // - distance between linear indices of neighboring subscripts at Idx, it
+  //   is a const_ints when all the following sizes are static, otherwise it
+  //   is read from the cached magnitude of the following dynamic size
+  template <size_t Idx>
+  constexpr auto stride_at(const const_index<Idx> &) const {
+    static_assert(Idx < rank, "Idx too large");
+    return rest().stride_at(const_index<Idx - 1>());
+  }
+  constexpr auto stride_at(const const_index<0> &) const {
+    return rest().magnitude();
+  }
+  template <class K, K Idx, wheels_enable_if(!(std::is_same<K, size_t>::value))>
+  constexpr auto stride_at(const const_ints<K, Idx> &) const {
+    return stride_at(const_index<Idx>());
+  }
+
   template <class Archive> void serialize(Archive &ar) {
     ar(_val, _mag);
     ar(rest());
@@ -343,7 +379,8 @@ constexpr T sub2ind(const tensor_shape<T, SizeT, SizeTs...> &) {
 template <class T, class SizeT, class... SizeTs, class K, class... Ks>
 constexpr T sub2ind(const tensor_shape<T, SizeT, SizeTs...> &shape, K sub,
                     Ks... subs) {
-  return (T)(sub * shape.rest().magnitude() + sub2ind(shape.rest(), subs...));
+  return (T)(sub * shape.stride_at(const_index<0>()) +
+             sub2ind(shape.rest(), subs...));
 }
 
 // ind2sub
@@ -355,9 +392,9 @@ template <class T, class IndexT, class SizeT, class... SizeTs, class K,
           class... Ks>
 void ind2sub(const tensor_shape<T, SizeT, SizeTs...> &shape, const IndexT &ind,
              K &sub, Ks &... subs) {
-  const auto lm = shape.rest().magnitude();
-  sub = ind / lm;
-  ind2sub(shape.rest(), ind % lm, subs...);
+  const auto stride = shape.stride_at(const_index<0>());
+  sub = ind / stride;
+  ind2sub(shape.rest(), ind - sub * stride, subs...);
 }
 
 // sub2ind_by_iter
@@ -370,7 +407,7 @@ T sub2ind_by_iter(const tensor_shape<T, SizeT, SizeTs...> &shape,
                   SubsIterT subs_iter) {
   const auto cur_sub = *subs_iter;
   ++subs_iter;
-  return cur_sub * shape.rest().magnitude() +
+  return cur_sub * shape.stride_at(const_index<0>()) +
          sub2ind_by_iter(shape.rest(), subs_iter);
 }
 
@@ -381,9 +418,10 @@ void ind2sub_by_iter(const tensor_shape<T> &, const IndexT &ind,
 template <class SubsIterT, class IndexT, class T, class SizeT, class... SizeTs>
 void ind2sub_by_iter(const tensor_shape<T, SizeT, SizeTs...> &shape,
                      const IndexT &ind, SubsIterT subs_iter) {
-  const auto lm = shape.rest().magnitude();
-  *subs_iter = ind / lm;
-  ind2sub_by_iter(shape.rest(), ind % lm, ++subs_iter);
+  const auto stride = shape.stride_at(const_index<0>());
+  const auto sub = ind / stride;
+  *subs_iter = sub;
+  ind2sub_by_iter(shape.rest(), ind - sub * stride, ++subs_iter);
 }
 
 // invoke_with_subs
@@ -398,9 +436,11 @@ template <class T, class IndexT, class FunT, class SizeT, class... SizeTs,
 constexpr decltype(auto)
 invoke_with_subs(const tensor_shape<T, SizeT, SizeTs...> &shape,
                  const IndexT &ind, FunT &&fun, const SubTs &... subs) {
-  return invoke_with_subs(shape.rest(), ind % shape.rest().magnitude(),
-                          std::forward<FunT>(fun), subs...,
-                          ind / shape.rest().magnitude());
+  // one division per dimension, the remainder is recovered by a multiply
+  const auto stride = shape.stride_at(const_index<0>());
+  const auto sub = ind / stride;
+  return invoke_with_subs(shape.rest(), ind - sub * stride,
+                          std::forward<FunT>(fun), subs..., sub);
 }
 
 // for_each_subscript
@@ -417,6 +457,79 @@ void for_each_subscript(const tensor_shape<T, SizeT, SizeTs...> &shape,
   }
 }
 
+// subscript_cursor
+// - walks the linear indices of a shape in ascending order together with
+//   their subscripts, the subscripts are decoded once and then carried
+//   forward, so stepping costs no division
+// - stepping past the last index leaves the leading subscript at its size,
+//   which is what ind2sub gives for magnitude()
+template <class ShapeT> class subscript_cursor {
+public:
+  using value_type = typename ShapeT::value_type;
+  static constexpr size_t rank = ShapeT::rank;
+
+  subscript_cursor(const ShapeT &shape, size_t ind) : _ind(ind) {
+    _init(shape, make_const_sequence(const_size<rank>()));
+  }
+
+  size_t index() const { return _ind; }
+  const std::array<value_type, rank> &subs() const { return _subs; }
+
+  subscript_cursor &operator++() {
+    ++_ind;
+    for (size_t k = rank; k-- > 0;) {
+      if (++_subs[k] < _sizes[k] || k == 0) {
+        break;
+      }
+      _subs[k] = 0;
+    }
+    return *this;
+  }
+
+  // invoke
+  template <class FunT> decltype(auto) invoke(FunT &&fun) const {
+    return _invoke(std::forward<FunT>(fun),
+                   make_const_sequence(const_size<rank>()));
+  }
+
+private:
+  template <size_t... Is>
+  void _init(const ShapeT &shape, const const_ints<size_t, Is...> &) {
+    _sizes = {{(value_type)shape.at(const_index<Is>())...}};
+    ind2sub(shape, _ind, _subs[Is]...);
+  }
+  template <class FunT, size_t... Is>
+  decltype(auto) _invoke(FunT &&fun, const const_ints<size_t, Is...> &) const {
+    return std::forward<FunT>(fun)(_subs[Is]...);
+  }
+
+private:
+  size_t _ind;
+  std::array<value_type, rank> _sizes;
+  std::array<value_type, rank> _subs;
+};
+
+// make_subscript_cursor
+template <class T, class... SizeTs>
+subscript_cursor<tensor_shape<T, SizeTs...>>
+make_subscript_cursor(const tensor_shape<T, SizeTs...> &shape, size_t ind) {
+  return subscript_cursor<tensor_shape<T, SizeTs...>>(shape, ind);
+}
+
+// for_each_subscript_in_range
+// - visits subscripts of linear indices [first, last) in ascending order
+template <class T, class... SizeTs, class FunT>
+void for_each_subscript_in_range(const tensor_shape<T, SizeTs...> &shape,
+                                 size_t first, size_t last, FunT &&fun) {
+  if (first >= last) {
+    return;
+  }
+  auto cursor = make_subscript_cursor(shape, first);
+  for (size_t ind = first; ind < last; ind++, ++cursor) {
+    cursor.invoke(fun);
+  }
+}
+
 // for_each_subscript_if
 template <class T, class FunT, class... Ts>
 constexpr bool for_each_subscript_if(const tensor_shape<T> &, FunT &&fun,
@@ -653,6 +766,20 @@ constexpr auto permute(const tensor_shape<T, SizeTs...> &shape,
   return make_shape(shape.at(inds)...);
 }
 
+// _is_small_static_shape
+// - static shapes of rank 1 or 2 with at most _small_static_size along every
+//   axis, products, transposes and ewise ops on them are fully unrolled
+namespace detail {
+static constexpr size_t _small_static_size = 4;
+template <class ShapeT> struct _is_small_static_shape : no {};
+template <class T, T... Ss>
+struct _is_small_static_shape<tensor_shape<T, const_ints<T, Ss>...>>
+    : const_bool<(sizeof...(Ss) == 1 || sizeof...(Ss) == 2) &&
+                 decltype(const_ints<bool, true, (Ss >= 1 &&
+                                                  Ss <= _small_static_size)...>::
+                              all())::value> {};
+}
+
 // stream
 namespace detail {
 template <class ShapeT, size_t... Is>
@@ -84,4 +84,33 @@ TEST(tensor, shape) {
   ASSERT_TRUE(subscripts_are_valid(make_shape(1_c, 2_c, 3_c), 0_c, 1_c, 2_c));
   ASSERT_TRUE(!subscripts_are_valid(make_shape(1_c, 2_c, 3_c), 1_c, 1_c, 2_c));
   ASSERT_TRUE(!subscripts_are_valid(make_shape(1_c, 2_c, 3_c), 0_c, 1_c, 3_c));
-}
\ No newline at end of file
+
+  auto shape4 = make_shape(2, 3_c, 4, 5);
+  for (size_t first : {0, 7, 59}) {
+    size_t ind = first;
+    for_each_subscript_in_range(shape4, first, 113,
+                                [&](int a, int b, int c, int d) {
+                                  ASSERT_EQ(sub2ind(shape4, a, b, c, d), ind);
+                                  ind++;
+                                });
+    ASSERT_EQ(ind, 113);
+  }
+
+  // strides
+  static_assert(
+      decltype(make_shape(2, 3_c, 4_c, 5_c).stride_at(1_c))::value == 20, "");
+  ASSERT_EQ(shape4.stride_at(0_c), 60);
+  ASSERT_EQ(shape4.stride_at(1_c), 20);
+  ASSERT_EQ(shape4.stride_at(2_c), 5);
+  ASSERT_EQ(shape4.stride_at(3_c), 1);
+
+  // subscript_cursor
+  auto cursor = make_subscript_cursor(shape4, 0);
+  for (size_t ind = 0; ind < shape4.magnitude(); ind++, ++cursor) {
+    ASSERT_EQ(cursor.index(), ind);
+    int a, b, c, d;
+    ind2sub(shape4, ind, a, b, c, d);
+    ASSERT_TRUE(cursor.subs() == (std::array<int, 4>{{a, b, c, d}}));
+  }
+  ASSERT_EQ(cursor.subs()[0], 2);
+}
@@ -0,0 +1,539 @@
+/* * *
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Hao Yang (yangh2007@gmail.com)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64) ||              \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define wheels_simd_x86
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define wheels_simd_neon
+#endif
+
+// wheels_simd_bytes: width of the widest vector register in use
+#if defined(__AVX512F__)
+#define wheels_simd_bytes 64
+#elif defined(__AVX__)
+#define wheels_simd_bytes 32
+#else
+#define wheels_simd_bytes 16
+#endif
+
+// wheels_prefetch(p): hints that *p will be read soon
+#if defined(__GNUC__) || defined(__clang__)
+#define wheels_prefetch(p) __builtin_prefetch(p)
+#elif defined(wheels_simd_x86)
+#define wheels_prefetch(p)                                                     \
+  _mm_prefetch(reinterpret_cast<const char *>(p), _MM_HINT_T0)
+#else
+#define wheels_prefetch(p) ((void)0)
+#endif
+
+namespace wheels {
+
+// simd_pack<T>
+// - a thin wrapper over the vector registers of the target instruction set,
+//   selected at compile time (AVX-512, AVX/AVX2+FMA, SSE2, NEON), kernels are
+//   written once on top of it and fall back to scalar code (size == 1) for
+//   element types without a vector representation
+// - all loads and stores are unaligned
+template <class T> struct simd_pack {
+  using value_type = T;
+  using type = T;
+  static constexpr size_t size = 1;
+  static type zero() { return T(0); }
+  static type set1(const T &v) { return v; }
+  static type load(const T *p) { return *p; }
+  static void store(T *p, const type &v) { *p = v; }
+  static type add(const type &a, const type &b) { return a + b; }
+  static type sub(const type &a, const type &b) { return a - b; }
+  static type mul(const type &a, const type &b) { return a * b; }
+  static type div(const type &a, const type &b) { return a / b; }
+  static type min(const type &a, const type &b) { return b < a ? b : a; }
+  static type max(const type &a, const type &b) { return a < b ? b : a; }
+  static type fma(const type &a, const type &b, const type &c) {
+    return a * b + c;
+  }
+  static type abs(const type &a) { return a < T(0) ? -a : a; }
+  static type sqrt(const type &a) {
+    using std::sqrt;
+    return sqrt(a);
+  }
+  static T sum(const type &a) { return a; }
+};
+
+#if defined(__AVX512F__)
+
+template <> struct simd_pack<double> {
+  using value_type = double;
+  using type = __m512d;
+  static constexpr size_t size = 8;
+  static type zero() { return _mm512_setzero_pd(); }
+  static type set1(double v) { return _mm512_set1_pd(v); }
+  static type load(const double *p) { return _mm512_loadu_pd(p); }
+  static void store(double *p, type v) { _mm512_storeu_pd(p, v); }
+  static type add(type a, type b) { return _mm512_add_pd(a, b); }
+  static type sub(type a, type b) { return _mm512_sub_pd(a, b); }
+  static type mul(type a, type b) { return _mm512_mul_pd(a, b); }
+  static type div(type a, type b) { return _mm512_div_pd(a, b); }
+  static type min(type a, type b) { return _mm512_min_pd(b, a); }
+  static type max(type a, type b) { return _mm512_max_pd(b, a); }
+  static type fma(type a, type b, type c) { return _mm512_fmadd_pd(a, b, c); }
+  static type abs(type a) {
+    return _mm512_castsi512_pd(_mm512_and_si512(
+        _mm512_castpd_si512(a), _mm512_set1_epi64(0x7fffffffffffffffLL)));
+  }
+  static type sqrt(type a) { return _mm512_sqrt_pd(a); }
+  static double sum(type a) { return _mm512_reduce_add_pd(a); }
+};
+
+template <> struct simd_pack<float> {
+  using value_type = float;
+  using type = __m512;
+  static constexpr size_t size = 16;
+  static type zero() { return _mm512_setzero_ps(); }
+  static type set1(float v) { return _mm512_set1_ps(v); }
+  static type load(const float *p) { return _mm512_loadu_ps(p); }
+  static void store(float *p, type v) { _mm512_storeu_ps(p, v); }
+  static type add(type a, type b) { return _mm512_add_ps(a, b); }
+  static type sub(type a, type b) { return _mm512_sub_ps(a, b); }
+  static type mul(type a, type b) { return _mm512_mul_ps(a, b); }
+  static type div(type a, type b) { return _mm512_div_ps(a, b); }
+  static type min(type a, type b) { return _mm512_min_ps(b, a); }
+  static type max(type a, type b) { return _mm512_max_ps(b, a); }
+  static type fma(type a, type b, type c) { return _mm512_fmadd_ps(a, b, c); }
+  static type abs(type a) {
+    return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a),
+                                                _mm512_set1_epi32(0x7fffffff)));
+  }
+  static type sqrt(type a) { return _mm512_sqrt_ps(a); }
+  static float sum(type a) { return _mm512_reduce_add_ps(a); }
+};
+
+#elif defined(__AVX__)
+
+template <> struct simd_pack<double> {
+  using value_type = double;
+  using type = __m256d;
+  static constexpr size_t size = 4;
+  static type zero() { return _mm256_setzero_pd(); }
+  static type set1(double v) { return _mm256_set1_pd(v); }
+  static type load(const double *p) { return _mm256_loadu_pd(p); }
+  static void store(double *p, type v) { _mm256_storeu_pd(p, v); }
+  static type add(type a, type b) { return _mm256_add_pd(a, b); }
+  static type sub(type a, type b) { return _mm256_sub_pd(a, b); }
+  static type mul(type a, type b) { return _mm256_mul_pd(a, b); }
+  static type div(type a, type b) { return _mm256_div_pd(a, b); }
+  static type min(type a, type b) { return _mm256_min_pd(b, a); }
+  static type max(type a, type b) { return _mm256_max_pd(b, a); }
+  static type fma(type a, type b, type c) {
+#if defined(__FMA__)
+    return _mm256_fmadd_pd(a, b, c);
+#else
+    return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+  }
+  static type abs(type a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+  static type sqrt(type a) { return _mm256_sqrt_pd(a); }
+  static double sum(type a) {
+    __m128d s = _mm_add_pd(_mm256_castpd256_pd128(a),
+                           _mm256_extractf128_pd(a, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+  }
+};
+
+template <> struct simd_pack<float> {
+  using value_type = float;
+  using type = __m256;
+  static constexpr size_t size = 8;
+  static type zero() { return _mm256_setzero_ps(); }
+  static type set1(float v) { return _mm256_set1_ps(v); }
+  static type load(const float *p) { return _mm256_loadu_ps(p); }
+  static void store(float *p, type v) { _mm256_storeu_ps(p, v); }
+  static type add(type a, type b) { return _mm256_add_ps(a, b); }
+  static type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+  static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+  static type div(type a, type b) { return _mm256_div_ps(a, b); }
+  static type min(type a, type b) { return _mm256_min_ps(b, a); }
+  static type max(type a, type b) { return _mm256_max_ps(b, a); }
+  static type fma(type a, type b, type c) {
+#if defined(__FMA__)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+  }
+  static type abs(type a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+  static type sqrt(type a) { return _mm256_sqrt_ps(a); }
+  static float sum(type a) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+  }
+};
+
+#elif defined(wheels_simd_x86)
+
+template <> struct simd_pack<double> {
+  using value_type = double;
+  using type = __m128d;
+  static constexpr size_t size = 2;
+  static type zero() { return _mm_setzero_pd(); }
+  static type set1(double v) { return _mm_set1_pd(v); }
+  static type load(const double *p) { return _mm_loadu_pd(p); }
+  static void store(double *p, type v) { _mm_storeu_pd(p, v); }
+  static type add(type a, type b) { return _mm_add_pd(a, b); }
+  static type sub(type a, type b) { return _mm_sub_pd(a, b); }
+  static type mul(type a, type b) { return _mm_mul_pd(a, b); }
+  static type div(type a, type b) { return _mm_div_pd(a, b); }
+  static type min(type a, type b) { return _mm_min_pd(b, a); }
+  static type max(type a, type b) { return _mm_max_pd(b, a); }
+  static type fma(type a, type b, type c) {
+    return _mm_add_pd(_mm_mul_pd(a, b), c);
+  }
+  static type abs(type a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+  static type sqrt(type a) { return _mm_sqrt_pd(a); }
+  static double sum(type a) {
+    return _mm_cvtsd_f64(_mm_add_sd(a, _mm_unpackhi_pd(a, a)));
+  }
+};
+
+template <> struct simd_pack<float> {
+  using value_type = float;
+  using type = __m128;
+  static constexpr size_t size = 4;
+  static type zero() { return _mm_setzero_ps(); }
+  static type set1(float v) { return _mm_set1_ps(v); }
+  static type load(const float *p) { return _mm_loadu_ps(p); }
+  static void store(float *p, type v) { _mm_storeu_ps(p, v); }
+  static type add(type a, type b) { return _mm_add_ps(a, b); }
+  static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+  static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+  static type div(type a, type b) { return _mm_div_ps(a, b); }
+  static type min(type a, type b) { return _mm_min_ps(b, a); }
+  static type max(type a, type b) { return _mm_max_ps(b, a); }
+  static type fma(type a, type b, type c) {
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+  }
+  static type abs(type a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+  static type sqrt(type a) { return _mm_sqrt_ps(a); }
+  static float sum(type a) {
+    __m128 s = _mm_add_ps(a, _mm_movehl_ps(a, a));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+  }
+};
+
+#elif defined(wheels_simd_neon)
+
+template <> struct simd_pack<double> {
+  using value_type = double;
+  using type = float64x2_t;
+  static constexpr size_t size = 2;
+  static type zero() { return vdupq_n_f64(0.0); }
+  static type set1(double v) { return vdupq_n_f64(v); }
+  static type load(const double *p) { return vld1q_f64(p); }
+  static void store(double *p, type v) { vst1q_f64(p, v); }
+  static type add(type a, type b) { return vaddq_f64(a, b); }
+  static type sub(type a, type b) { return vsubq_f64(a, b); }
+  static type mul(type a, type b) { return vmulq_f64(a, b); }
+  static type div(type a, type b) { return vdivq_f64(a, b); }
+  static type min(type a, type b) { return vminq_f64(a, b); }
+  static type max(type a, type b) { return vmaxq_f64(a, b); }
+  static type fma(type a, type b, type c) { return vfmaq_f64(c, a, b); }
+  static type abs(type a) { return vabsq_f64(a); }
+  static type sqrt(type a) { return vsqrtq_f64(a); }
+  static double sum(type a) { return vaddvq_f64(a); }
+};
+
+template <> struct simd_pack<float> {
+  using value_type = float;
+  using type = float32x4_t;
+  static constexpr size_t size = 4;
+  static type zero() { return vdupq_n_f32(0.0f); }
+  static type set1(float v) { return vdupq_n_f32(v); }
+  static type load(const float *p) { return vld1q_f32(p); }
+  static void store(float *p, type v) { vst1q_f32(p, v); }
+  static type add(type a, type b) { return vaddq_f32(a, b); }
+  static type sub(type a, type b) { return vsubq_f32(a, b); }
+  static type mul(type a, type b) { return vmulq_f32(a, b); }
+  static type div(type a, type b) { return vdivq_f32(a, b); }
+  static type min(type a, type b) { return vminq_f32(a, b); }
+  static type max(type a, type b) { return vmaxq_f32(a, b); }
+  static type fma(type a, type b, type c) { return vfmaq_f32(c, a, b); }
+  static type abs(type a) { return vabsq_f32(a); }
+  static type sqrt(type a) { return vsqrtq_f32(a); }
+  static float sum(type a) { return vaddvq_f32(a); }
+};
+
+#endif
+
+// simd_transpose<T>
+// - transposes a size x size tile in registers,
+//   dst[i * ldd + j] = src[j * lds + i] for i, j < size
+template <class T> struct simd_transpose {
+  static constexpr size_t size = 1;
+  static void run(const T *src, size_t, T *dst, size_t) { *dst = *src; }
+};
+
+#if defined(__AVX__)
+
+template <> struct simd_transpose<double> {
+  static constexpr size_t size = 4;
+  static void run(const double *src, size_t lds, double *dst, size_t ldd) {
+    __m256d r0 = _mm256_loadu_pd(src), r1 = _mm256_loadu_pd(src + lds),
+            r2 = _mm256_loadu_pd(src + 2 * lds),
+            r3 = _mm256_loadu_pd(src + 3 * lds);
+    __m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1),
+            t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+    _mm256_storeu_pd(dst, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(dst + ldd, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(dst + 2 * ldd, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(dst + 3 * ldd, _mm256_permute2f128_pd(t1, t3, 0x31));
+  }
+};
+
+template <> struct simd_transpose<float> {
+  static constexpr size_t size = 8;
+  static void run(const float *src, size_t lds, float *dst, size_t ldd) {
+    __m256 r[8], t[8], u[8];
+    for (int k = 0; k < 8; k++) {
+      r[k] = _mm256_loadu_ps(src + k * lds);
+    }
+    for (int k = 0; k < 8; k += 2) {
+      t[k] = _mm256_unpacklo_ps(r[k], r[k + 1]);
+      t[k + 1] = _mm256_unpackhi_ps(r[k], r[k + 1]);
+    }
+    for (int k = 0; k < 8; k += 4) {
+      u[k] = _mm256_shuffle_ps(t[k], t[k + 2], _MM_SHUFFLE(1, 0, 1, 0));
+      u[k + 1] = _mm256_shuffle_ps(t[k], t[k + 2], _MM_SHUFFLE(3, 2, 3, 2));
+      u[k + 2] =
+          _mm256_shuffle_ps(t[k + 1], t[k + 3], _MM_SHUFFLE(1, 0, 1, 0));
+      u[k + 3] =
+          _mm256_shuffle_ps(t[k + 1], t[k + 3], _MM_SHUFFLE(3, 2, 3, 2));
+    }
+    for (int k = 0; k < 4; k++) {
+      _mm256_storeu_ps(dst + k * ldd,
+                       _mm256_permute2f128_ps(u[k], u[k + 4], 0x20));
+      _mm256_storeu_ps(dst + (k + 4) * ldd,
+                       _mm256_permute2f128_ps(u[k], u[k + 4], 0x31));
+    }
+  }
+};
+
+#elif defined(wheels_simd_x86)
+
+template <> struct simd_transpose<double> {
+  static constexpr size_t size = 2;
+  static void run(const double *src, size_t lds, double *dst, size_t ldd) {
+    __m128d r0 = _mm_loadu_pd(src), r1 = _mm_loadu_pd(src + lds);
+    _mm_storeu_pd(dst, _mm_unpacklo_pd(r0, r1));
+    _mm_storeu_pd(dst + ldd, _mm_unpackhi_pd(r0, r1));
+  }
+};
+
+template <> struct simd_transpose<float> {
+  static constexpr size_t size = 4;
+  static void run(const float *src, size_t lds, float *dst, size_t ldd) {
+    __m128 r0 = _mm_loadu_ps(src), r1 = _mm_loadu_ps(src + lds),
+           r2 = _mm_loadu_ps(src + 2 * lds), r3 = _mm_loadu_ps(src + 3 * lds);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(dst, r0);
+    _mm_storeu_ps(dst + ldd, r1);
+    _mm_storeu_ps(dst + 2 * ldd, r2);
+    _mm_storeu_ps(dst + 3 * ldd, r3);
+  }
+};
+
+#elif defined(wheels_simd_neon)
+
+template <> struct simd_transpose<double> {
+  static constexpr size_t size = 2;
+  static void run(const double *src, size_t lds, double *dst, size_t ldd) {
+    float64x2_t r0 = vld1q_f64(src), r1 = vld1q_f64(src + lds);
+    vst1q_f64(dst, vtrn1q_f64(r0, r1));
+    vst1q_f64(dst + ldd, vtrn2q_f64(r0, r1));
+  }
+};
+
+template <> struct simd_transpose<float> {
+  static constexpr size_t size = 4;
+  static void run(const float *src, size_t lds, float *dst, size_t ldd) {
+    float32x4_t r0 = vld1q_f32(src), r1 = vld1q_f32(src + lds),
+                r2 = vld1q_f32(src + 2 * lds), r3 = vld1q_f32(src + 3 * lds);
+    float64x2_t t0 = vreinterpretq_f64_f32(vtrn1q_f32(r0, r1)),
+                t1 = vreinterpretq_f64_f32(vtrn2q_f32(r0, r1)),
+                t2 = vreinterpretq_f64_f32(vtrn1q_f32(r2, r3)),
+                t3 = vreinterpretq_f64_f32(vtrn2q_f32(r2, r3));
+    vst1q_f32(dst, vreinterpretq_f32_f64(vtrn1q_f64(t0, t2)));
+    vst1q_f32(dst + ldd, vreinterpretq_f32_f64(vtrn1q_f64(t1, t3)));
+    vst1q_f32(dst + 2 * ldd, vreinterpretq_f32_f64(vtrn2q_f64(t0, t2)));
+    vst1q_f32(dst + 3 * ldd, vreinterpretq_f32_f64(vtrn2q_f64(t1, t3)));
+  }
+};
+
+#endif
+
+// simd_gather<T>
+// - loads size elements at element offsets from base,
+//   dst[i] = base[offsets[i]] for i < size
+template <class T> struct simd_gather {
+  static constexpr size_t size = 1;
+  template <class IndexT>
+  static void run(const T *base, const IndexT *offsets, T *dst) {
+    *dst = base[*offsets];
+  }
+};
+
+#if defined(__AVX512F__)
+
+template <> struct simd_gather<double> {
+  static constexpr size_t size = 8;
+  static void run(const double *base, const int64_t *offsets, double *dst) {
+    _mm512_storeu_pd(dst, _mm512_i64gather_pd(_mm512_loadu_si512(offsets),
+                                              base, sizeof(double)));
+  }
+  static void run(const double *base, const int32_t *offsets, double *dst) {
+    _mm512_storeu_pd(
+        dst, _mm512_i32gather_pd(
+                 _mm256_loadu_si256(reinterpret_cast<const __m256i *>(offsets)),
+                 base, sizeof(double)));
+  }
+};
+
+template <> struct simd_gather<float> {
+  static constexpr size_t size = 8;
+  static void run(const float *base, const int64_t *offsets, float *dst) {
+    _mm256_storeu_ps(dst, _mm512_i64gather_ps(_mm512_loadu_si512(offsets),
+                                              base, sizeof(float)));
+  }
+  static void run(const float *base, const int32_t *offsets, float *dst) {
+    _mm256_storeu_ps(
+        dst, _mm256_i32gather_ps(
+                 base,
+                 _mm256_loadu_si256(reinterpret_cast<const __m256i *>(offsets)),
+                 sizeof(float)));
+  }
+};
+
+#elif defined(__AVX2__)
+
+template <> struct simd_gather<double> {
+  static constexpr size_t size = 4;
+  static void run(const double *base, const int64_t *offsets, double *dst) {
+    _mm256_storeu_pd(
+        dst, _mm256_i64gather_pd(
+                 base,
+                 _mm256_loadu_si256(reinterpret_cast<const __m256i *>(offsets)),
+                 sizeof(double)));
+  }
+  static void run(const double *base, const int32_t *offsets, double *dst) {
+    _mm256_storeu_pd(
+        dst, _mm256_i32gather_pd(
+                 base,
+                 _mm_loadu_si128(reinterpret_cast<const __m128i *>(offsets)),
+                 sizeof(double)));
+  }
+};
+
+template <> struct simd_gather<float> {
+  static constexpr size_t size = 4;
+  static void run(const float *base, const int64_t *offsets, float *dst) {
+    _mm_storeu_ps(
+        dst, _mm256_i64gather_ps(
+                 base,
+                 _mm256_loadu_si256(reinterpret_cast<const __m256i *>(offsets)),
+                 sizeof(float)));
+  }
+  static void run(const float *base, const int32_t *offsets, float *dst) {
+    _mm_storeu_ps(
+        dst, _mm_i32gather_ps(
+                 base,
+                 _mm_loadu_si128(reinterpret_cast<const __m128i *>(offsets)),
+                 sizeof(float)));
+  }
+};
+
+#endif
+
+// simd_byte_mask
+// - bit i of run(p) is set iff p[i] != 0, for i < size
+struct simd_byte_mask {
+#if defined(__AVX2__)
+  static constexpr size_t size = 32;
+  static uint32_t run(const uint8_t *p) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    return ~uint32_t(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_setzero_si256())));
+  }
+#elif defined(wheels_simd_x86)
+  static constexpr size_t size = 16;
+  static uint32_t run(const uint8_t *p) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i z = _mm_cmpeq_epi8(v, _mm_setzero_si128());
+    return ~uint32_t(_mm_movemask_epi8(z)) & 0xffffu;
+  }
+#else
+  static constexpr size_t size = 8;
+  static uint32_t run(const uint8_t *p) {
+    uint32_t m = 0;
+    for (size_t i = 0; i < size; i++) {
+      m |= uint32_t(p[i] != 0) << i;
+    }
+    return m;
+  }
+#endif
+};
+
+// simd_popcount: number of set bits
+inline size_t simd_popcount(uint32_t m) {
+#if defined(__GNUC__) || defined(__clang__)
+  return size_t(__builtin_popcount(m));
+#else
+  size_t c = 0;
+  for (; m != 0; m &= m - 1) {
+    c++;
+  }
+  return c;
+#endif
+}
+
+// simd_lowest_bit: index of the lowest set bit, m != 0
+inline size_t simd_lowest_bit(uint32_t m) {
+#if defined(__GNUC__) || defined(__clang__)
+  return size_t(__builtin_ctz(m));
+#else
+  size_t i = 0;
+  for (; (m & 1u) == 0; m >>= 1) {
+    i++;
+  }
+  return i;
+#endif
+}
+}
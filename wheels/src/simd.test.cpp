@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include "simd.hpp"
+
+using namespace wheels;
+
+template <class T> static void check_simd_pack(std::default_random_engine &rng) {
+  using pack = simd_pack<T>;
+  constexpr size_t w = pack::size;
+  T a[w], b[w], c[w], r[w];
+  for (size_t i = 0; i < w; i++) {
+    a[i] = T(rng() % 17) - 8;
+    b[i] = T(rng() % 17) - 8;
+    c[i] = T(rng() % 17) - 8;
+  }
+  auto va = pack::load(a), vb = pack::load(b), vc = pack::load(c);
+
+  pack::store(r, pack::add(va, vb));
+  for (size_t i = 0; i < w; i++) {
+    ASSERT_EQ(r[i], a[i] + b[i]);
+  }
+  pack::store(r, pack::sub(va, vb));
+  for (size_t i = 0; i < w; i++) {
+    ASSERT_EQ(r[i], a[i] - b[i]);
+  }
+  pack::store(r, pack::mul(va, vb));
+  for (size_t i = 0; i < w; i++) {
+    ASSERT_EQ(r[i], a[i] * b[i]);
+  }
+  pack::store(r, pack::fma(va, vb, vc));
+  for (size_t i = 0; i < w; i++) {
+    ASSERT_EQ(r[i], a[i] * b[i] + c[i]);
+  }
+  pack::store(r, pack::min(va, vb));
+  for (size_t i = 0; i < w; i++) {
+    ASSERT_EQ(r[i], std::min(a[i], b[i]));
+  }
+  pack::store(r, pack::max(va, vb));
+  for (size_t i = 0; i < w; i++) {
+    ASSERT_EQ(r[i], std::max(a[i], b[i]));
+  }
+  pack::store(r, pack::abs(va));
+  for (size_t i = 0; i < w; i++) {
+    ASSERT_EQ(r[i], std::abs(a[i]));
+  }
+  pack::store(r, pack::set1(T(3)));
+  for (size_t i = 0; i < w; i++) {
+    ASSERT_EQ(r[i], T(3));
+  }
+  T s = 0;
+  for (size_t i = 0; i < w; i++) {
+    s += a[i];
+  }
+  ASSERT_EQ(pack::sum(va), s);
+}
+
+TEST(simd, pack) {
+  std::default_random_engine rng;
+  check_simd_pack<float>(rng);
+  check_simd_pack<double>(rng);
+  check_simd_pack<int>(rng);
+  static_assert(simd_pack<int>::size == 1, "");
+}
+
+TEST(simd, instruction_set) {
+#if defined(wheels_simd_x86) || defined(wheels_simd_neon)
+  static_assert(simd_pack<float>::size == wheels_simd_bytes / sizeof(float),
+                "");
+  static_assert(simd_pack<double>::size == wheels_simd_bytes / sizeof(double),
+                "");
+#endif
+#if defined(wheels_simd_expected_bytes)
+  // set by the per instruction set test targets
+  static_assert(wheels_simd_bytes == wheels_simd_expected_bytes,
+                "the target flags did not select the expected instruction set");
+#endif
+  std::cout << "simd: " << wheels_simd_bytes << " bytes, "
+            << simd_pack<float>::size << " floats per pack" << std::endl;
+}
@@ -24,11 +24,96 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#include "arena.hpp"
 #include "shape.hpp"
+#include "simd.hpp"
 
 #include "storage_fwd.hpp"
 
 namespace wheels {
+
+// aligned_allocator
+// - returns memory aligned to Align bytes (and at least to alignof(T))
+// - PadToSimd asks storages to round their capacity up to a multiple of the
+//   widest simd vector, the padding elements are value-initialized so kernels
+//   over ptr() may process whole vectors past the last element
+// - draws from the innermost scoped_arena of the calling thread if any
+template <class T, size_t Align, bool PadToSimd> class aligned_allocator {
+  static_assert(Align != 0 && (Align & (Align - 1)) == 0,
+                "Align must be a power of 2");
+
+public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using propagate_on_container_move_assignment = std::true_type;
+  using is_always_equal = std::true_type;
+  template <class U> struct rebind {
+    using other = aligned_allocator<U, Align, PadToSimd>;
+  };
+
+  static constexpr size_t alignment = Align < alignof(T) ? alignof(T) : Align;
+  static constexpr bool pad_to_simd = PadToSimd;
+
+  constexpr aligned_allocator() noexcept {}
+  template <class U>
+  constexpr aligned_allocator(
+      const aligned_allocator<U, Align, PadToSimd> &) noexcept {}
+
+  T *allocate(size_t n) {
+    if (n > size_t(-1) / sizeof(T)) {
+      wheels_throw(std::bad_alloc());
+    }
+    // never request 0 bytes, so that a live storage always owns a pointer
+    const size_t bytes = n == 0 ? alignment : n * sizeof(T);
+    return static_cast<T *>(detail::_allocate_aligned(bytes, alignment));
+  }
+  void deallocate(T *p, size_t) noexcept {
+    detail::_deallocate_aligned(p, alignment);
+  }
+};
+
+template <class T1, class T2, size_t Align, bool PadToSimd>
+constexpr bool operator==(const aligned_allocator<T1, Align, PadToSimd> &,
+                          const aligned_allocator<T2, Align, PadToSimd> &) {
+  return true;
+}
+template <class T1, class T2, size_t Align, bool PadToSimd>
+constexpr bool operator!=(const aligned_allocator<T1, Align, PadToSimd> &,
+                          const aligned_allocator<T2, Align, PadToSimd> &) {
+  return false;
+}
+
+namespace detail {
+// whether the allocator constructs elements by plain placement new
+template <class AllocT> struct _is_plain_allocator : no {};
+template <class T> struct _is_plain_allocator<std::allocator<T>> : yes {};
+template <class T, size_t Align, bool PadToSimd>
+struct _is_plain_allocator<aligned_allocator<T, Align, PadToSimd>> : yes {};
+
+// number of elements a capacity is rounded up to
+template <class AllocT> struct _storage_padding {
+  static constexpr size_t value = 1;
+};
+template <class T, size_t Align>
+struct _storage_padding<aligned_allocator<T, Align, true>> {
+  static constexpr size_t value =
+      sizeof(T) >= wheels_simd_bytes ? 1 : wheels_simd_bytes / sizeof(T);
+};
+template <class AllocT> constexpr size_t _padded_capacity(size_t n) {
+  return (n + _storage_padding<AllocT>::value - 1) /
+         _storage_padding<AllocT>::value * _storage_padding<AllocT>::value;
+}
+}
 namespace detail {
 // init_std_array
 template <class T, size_t N, size_t... Is>
@@ -47,23 +132,22 @@ namespace detail {
 template <class IterT, class DiffT, class AllocT>
 void _uninitialized_default_fill_n(IterT first, DiffT count, AllocT &alloc,
                                    no) {
+  using traits_t = std::allocator_traits<AllocT>;
   IterT next = first;
   wheels_try {
     for (; 0 < count; --count, (void)++first)
-      alloc.construct(first);
+      traits_t::construct(alloc, first);
   }
   wheels_catch_all {
     for (; next != first; ++next)
-      alloc.destroy(next);
+      traits_t::destroy(alloc, next);
     wheels_rethrow;
   }
 }
 // for scalars initialization
-template <class IterT, class DiffT>
-void _uninitialized_default_fill_n(
-    IterT first, DiffT count,
-    std::allocator<typename std::iterator_traits<IterT>::value_type> &alloc,
-    yes) {
+template <class IterT, class DiffT, class AllocT>
+void _uninitialized_default_fill_n(IterT first, DiffT count, AllocT &alloc,
+                                   yes) {
   memset(first, 0,
          count * sizeof(typename std::iterator_traits<IterT>::value_type));
 }
@@ -76,36 +160,63 @@ inline void uninitialized_default_fill_n(IterT first, DiffT count,
       first, count, alloc, const_bool < std::is_pointer<IterT>::value &&
                                std::is_scalar<T>::value &&
                                !std::is_volatile<T>::value &&
-                               !std::is_member_pointer<T>::value > ());
+                               !std::is_member_pointer<T>::value &&
+                               detail::_is_plain_allocator<AllocT>::value > ());
 }
 
 template <class IterT, class DiffT, class AllocT, class ValT>
 inline void uninitialized_default_fill_n(IterT first, DiffT count,
                                          AllocT &alloc, const ValT &val) {
+  using traits_t = std::allocator_traits<AllocT>;
   IterT next = first;
   wheels_try {
     for (; 0 < count; --count, (void)++first)
-      alloc.construct(first, val);
+      traits_t::construct(alloc, first, val);
   }
   wheels_catch_all {
     for (; next != first; ++next)
-      alloc.destroy(next);
+      traits_t::destroy(alloc, next);
     wheels_rethrow;
   }
 }
 
+// uninitialized_default_init_n
+// - leaves trivial elements indeterminate, constructs the others
+namespace detail {
+template <class IterT, class DiffT, class AllocT>
+inline void _uninitialized_default_init_n(IterT first, DiffT count,
+                                          AllocT &alloc, no) {
+  _uninitialized_default_fill_n(first, count, alloc, no());
+}
+template <class IterT, class DiffT, class AllocT>
+inline void _uninitialized_default_init_n(IterT, DiffT, AllocT &, yes) {}
+}
+template <class IterT, class DiffT, class AllocT>
+inline void uninitialized_default_init_n(IterT first, DiffT count,
+                                         AllocT &alloc) {
+  typedef typename std::iterator_traits<IterT>::value_type T;
+  detail::_uninitialized_default_init_n(
+      first, count, alloc,
+      const_bool < std::is_pointer<IterT>::value &&
+                       std::is_trivially_default_constructible<T>::value &&
+                       std::is_trivially_destructible<T>::value &&
+                       detail::_is_plain_allocator<AllocT>::value > ());
+}
+
 // uninitialized_default_fill_args
 template <class IterT, class AllocT>
 inline void uninitialized_default_fill_args(IterT first, AllocT &alloc) {}
 template <class IterT, class AllocT, class EleT, class... EleTs>
 inline void uninitialized_default_fill_args(IterT first, AllocT &alloc,
                                             EleT &&ele, EleTs &&... eles) {
-  alloc.construct(first, std::forward<EleT>(ele));
+  std::allocator_traits<AllocT>::construct(alloc, first,
+                                           std::forward<EleT>(ele));
   uninitialized_default_fill_args(++first, alloc, std::forward<EleTs>(eles)...);
 }
 
 // static shaped storage
-template <class T, class ShapeT> class storage<T, ShapeT, true> {
+template <class T, class ShapeT, class AllocT>
+class storage<T, ShapeT, true, AllocT> {
   static_assert(is_tensor_shape<ShapeT>::value,
                 "ShapeT must be a tensor_shape");
 
@@ -120,6 +231,7 @@ public:
       : _data(init_std_array<T, shape_type::static_magnitude>(value_type())) {}
   constexpr storage(const shape_type &, const value_type &e)
       : _data(init_std_array<T, shape_type::static_magnitude>(e)) {}
+  storage(const shape_type &, const _with_uninitialized &) {}
   template <class... EleTs>
   constexpr storage(const shape_type &, const _with_elements &,
                     EleTs &&... eles)
@@ -144,6 +256,9 @@ public:
   value_type *data() { return _data.data(); }
 
   void reshape(const shape_type &nshape) { assert(nshape == shape()); }
+  void resize_uninitialized(const shape_type &nshape) {
+    assert(nshape == shape());
+  }
 
 private:
   std::array<value_type, shape_type::static_magnitude> _data;
@@ -178,34 +293,108 @@ private:
   value_type *_ptr;
 };
 
+// storage_inline_capacity
+template <class T>
+struct storage_inline_capacity
+    : const_size<(std::is_trivially_copyable<T>::value &&
+                  std::is_trivially_destructible<T>::value &&
+                  alignof(T) <= alignof(std::max_align_t))
+                     ? wheels_storage_inline_bytes / sizeof(T)
+                     : 0> {};
+
+namespace detail {
+// inline capacity of a dynamic storage, whole multiples of the padding
+template <class T, class AllocT>
+constexpr size_t _storage_inline_capacity() {
+  return storage_inline_capacity<T>::value / _storage_padding<AllocT>::value *
+         _storage_padding<AllocT>::value;
+}
+// alignment of the elements of a dynamic storage
+template <class AllocT> struct _storage_alignment {
+  static constexpr size_t value = alignof(typename AllocT::value_type);
+};
+template <class T, size_t Align, bool PadToSimd>
+struct _storage_alignment<aligned_allocator<T, Align, PadToSimd>> {
+  static constexpr size_t value =
+      aligned_allocator<T, Align, PadToSimd>::alignment;
+};
+// the elements start at the first Align-byte boundary inside bytes, so that
+// the alignment holds wherever the storage itself lives (operator new does
+// not honor over-aligned types before c++17)
+template <class T, size_t N, size_t Align> struct _storage_inline_buffer {
+  T *data() {
+    return reinterpret_cast<T *>(
+        (reinterpret_cast<uintptr_t>(bytes) + Align - 1) / Align * Align);
+  }
+  const T *data() const {
+    return const_cast<_storage_inline_buffer *>(this)->data();
+  }
+  alignas(T) unsigned char bytes[N * sizeof(T) + Align - alignof(T)];
+};
+template <class T, size_t Align> struct _storage_inline_buffer<T, 0, Align> {
+  T *data() { return nullptr; }
+  const T *data() const { return nullptr; }
+};
+}
+
 // dynamic shaped storage
-template <class T, class ShapeT> class storage<T, ShapeT, false> {
+// - elements live in memory obtained from AllocT (64-byte aligned by default)
+//   or, while capacity() fits in storage_inline_capacity<T>, in an inline
+//   buffer with the same alignment so that small and default-constructed
+//   storages never touch the allocator
+// - capacity() is rounded up by AllocT's padding, all capacity() elements are
+//   constructed
+// - growing by reshape() or resize_uninitialized() reserves at least 1.5 times
+//   the old capacity, copy assignment keeps the capacity if it suffices,
+//   shrink_to_fit() gives the surplus back
+template <class T, class ShapeT, class AllocT>
+class storage<T, ShapeT, false, AllocT> {
   static_assert(is_tensor_shape<ShapeT>::value,
                 "ShapeT must be a tensor_shape");
+  using _traits_t = std::allocator_traits<AllocT>;
+  // whether elements are copied and relocated by memcpy
+  using _bitwise_t = const_bool<std::is_trivially_copyable<T>::value &&
+                                detail::_is_plain_allocator<AllocT>::value>;
 
 public:
   using value_type = T;
   using shape_type = ShapeT;
+  using allocator_type = AllocT;
 
   static constexpr size_t _initial_cap = 1;
-  storage() : _shape(), _capacity(_initial_cap) {
-    _data = _alloc.allocate(_capacity);
-    uninitialized_default_fill_n(_data, _capacity, _alloc);
+  static constexpr size_t _inline_cap =
+      detail::_storage_inline_capacity<T, AllocT>();
+
+  storage() : _shape(), _capacity(0), _data(nullptr) {
+    if (_inline_cap > 0) {
+      _capacity = detail::_padded_capacity<AllocT>(_initial_cap);
+      _data = _buffer.data();
+      uninitialized_default_fill_n(_data, _capacity, _alloc);
+    }
   }
   explicit storage(const shape_type &s) : _shape(s) {
-    _capacity = _shape.magnitude();
-    _data = _alloc.allocate(_capacity);
+    _capacity = detail::_padded_capacity<AllocT>(_shape.magnitude());
+    _data = _acquire(_capacity);
     uninitialized_default_fill_n(_data, _capacity, _alloc);
   }
+  // elements are left indeterminate if they are trivial, to be overwritten
+  storage(const shape_type &s, _with_uninitialized) : _shape(s) {
+    const auto mag = _shape.magnitude();
+    _capacity = detail::_padded_capacity<AllocT>(mag);
+    _data = _acquire(_capacity);
+    _construct_tail(_data, 0, _capacity, mag);
+  }
   storage(const shape_type &s, const value_type &e) : _shape(s) {
-    _capacity = _shape.magnitude();
-    _data = _alloc.allocate(_capacity);
-    uninitialized_default_fill_n(_data, _capacity, _alloc, e);
+    const auto mag = _shape.magnitude();
+    _capacity = detail::_padded_capacity<AllocT>(mag);
+    _data = _acquire(_capacity);
+    uninitialized_default_fill_n(_data, mag, _alloc, e);
+    uninitialized_default_fill_n(_data + mag, _capacity - mag, _alloc);
   }
   template <class... EleTs>
   storage(const shape_type &s, _with_elements, EleTs &&... eles) : _shape(s) {
-    _capacity = _shape.magnitude();
-    _data = _alloc.allocate(_capacity);
+    _capacity = detail::_padded_capacity<AllocT>(_shape.magnitude());
+    _data = _acquire(_capacity);
     uninitialized_default_fill_args(_data, _alloc,
                                     std::forward<EleTs>(eles)...);
     if (sizeof...(EleTs) < _capacity) {
@@ -216,63 +405,48 @@ public:
   template <class IterT>
   storage(const shape_type &s, _with_iterators, IterT begin, IterT end)
       : _shape(s) {
-    _capacity = _shape.magnitude();
-    _data = _alloc.allocate(_capacity);
+    const auto mag = _shape.magnitude();
+    _capacity = detail::_padded_capacity<AllocT>(mag);
+    _data = _acquire(_capacity);
     size_t i = 0;
-    for (; i < _capacity && begin != end; i++) {
-      _alloc.construct(_data + i, *begin);
+    for (; i < mag && begin != end; i++) {
+      _traits_t::construct(_alloc, _data + i, *begin);
       ++begin;
     }
     for (; i < _capacity; i++) {
-      _alloc.construct(_data + i);
+      _traits_t::construct(_alloc, _data + i);
     }
   }
 
   storage(const storage &st) : _shape(st._shape) {
-    _capacity = _shape.magnitude();
-    _data = _alloc.allocate(_capacity);
-    for (size_t i = 0; i < _capacity; i++) {
-      _alloc.construct(_data + i, st._data[i]);
-    }
+    const auto mag = _shape.magnitude();
+    _capacity = detail::_padded_capacity<AllocT>(mag);
+    _data = _acquire(_capacity);
+    _copy_construct(_data, st._data, mag, _bitwise_t());
+    uninitialized_default_fill_n(_data + mag, _capacity - mag, _alloc);
   }
-  storage(storage &&st)
-      : _shape(st._shape), _capacity(st._capacity), _data(st._data),
-        _alloc(st._alloc) {
-    st._shape = shape_type();
-    st._data = nullptr;
-    st._capacity = 0;
+  storage(storage &&st) : _shape(), _capacity(0), _data(nullptr) {
+    _take(st);
   }
 
   ~storage() {
-    if (_data) {
-      for (size_t i = 0; i < _capacity; i++) {
-        _alloc.destroy(_data + i);
-      }
-      _alloc.deallocate(_data, _capacity);
-      _capacity = 0;
-      _data = nullptr;
-    }
+    _release();
+    _capacity = 0;
+    _data = nullptr;
   }
 
   storage &operator=(const storage &st) {
-    _shape = st._shape;
-    const auto nmag = _shape.magnitude();
-    if (_capacity < nmag) {
-      value_type *ndata = _alloc.allocate(nmag);
-      for (size_t i = 0; i < nmag; i++) {
-        _alloc.construct(ndata + i, st._data[i]);
-      }
-      for (size_t i = 0; i < _capacity; i++) {
-        _alloc.destroy(_data + i);
-      }
-      _alloc.deallocate(_data, _capacity);
-      _capacity = nmag;
-      _data = ndata;
-    } else {
-      for (size_t i = 0; i < nmag; i++) {
-        _data[i] = st._data[i];
-      }
+    if (this == &st) {
+      return *this;
+    }
+    const auto nmag = st._shape.magnitude();
+    if (_capacity < nmag) { // a copy fitting exactly
+      storage(st).swap(*this);
+      return *this;
     }
+    _copy_assign(_data, st._data, nmag, _bitwise_t());
+    _shape = st._shape;
+    _reset_padding(nmag);
     return *this;
   }
   storage &operator=(storage &&st) {
@@ -284,46 +458,188 @@ public:
   constexpr const value_type *data() const { return _data; }
   value_type *data() { return _data; }
   constexpr size_t capacity() const { return _capacity; }
+  allocator_type get_allocator() const { return _alloc; }
 
   void swap(storage &st) {
-    std::swap(_shape, st._shape);
-    std::swap(_capacity, st._capacity);
-    std::swap(_data, st._data);
-    std::swap(_alloc, st._alloc);
+    if (!_is_inline() && !st._is_inline()) {
+      std::swap(_shape, st._shape);
+      std::swap(_capacity, st._capacity);
+      std::swap(_data, st._data);
+      std::swap(_alloc, st._alloc);
+      return;
+    }
+    // inline elements have to be moved between the buffers
+    storage tmp(std::move(st));
+    st._clear();
+    st._take(*this);
+    _clear();
+    _take(tmp);
   }
 
+  // elements beyond the old magnitude are reset to value_type()
   void reshape(const shape_type &nshape) {
     const auto mag = _shape.magnitude();
     const auto nmag = nshape.magnitude();
-    if (_capacity < nmag) { // allocate new
-      value_type *ndata = _alloc.allocate(nmag);
-      for (size_t i = 0; i < _capacity; i++) {
-        _alloc.construct(ndata + i, std::move(_data[i]));
-      }
-      for (size_t i = _capacity; i < nmag; i++) {
-        _alloc.construct(ndata + i);
-      }
-      for (size_t i = 0; i < _capacity; i++) {
-        _alloc.destroy(_data + i);
-      }
-      _alloc.deallocate(_data, _capacity);
-      _capacity = nmag;
-      _data = ndata;
-    }
+    resize_uninitialized(nshape);
     if (mag < nmag) {
-      for (size_t i = mag; i < nmag; i++) {
-        _data[i] = value_type();
-      }
+      std::fill(_data + mag, _data + nmag, value_type());
+    }
+  }
+  // elements beyond the old magnitude are left as they are (indeterminate if
+  // they are trivial), to be overwritten
+  void resize_uninitialized(const shape_type &nshape) {
+    const auto nmag = nshape.magnitude();
+    if (_capacity < (size_t)nmag) {
+      _reallocate(_grown_capacity(nmag), nmag);
+    } else {
+      _reset_padding(nmag);
     }
     _shape = nshape;
   }
+  // new capacity is value-initialized
+  void reserve(size_t cap) {
+    if (_capacity < cap) {
+      _reallocate(detail::_padded_capacity<AllocT>(cap), 0);
+    }
+  }
+  void shrink_to_fit() {
+    const auto mag = _shape.magnitude();
+    const auto ncap = detail::_padded_capacity<AllocT>(mag);
+    if (ncap < _capacity && !_is_inline()) {
+      _reallocate(ncap, mag);
+    }
+  }
+
+private:
+  bool _is_inline() const {
+    return _inline_cap > 0 && _data == _buffer.data();
+  }
+  // memory for cap elements, the inline buffer must not be in use
+  value_type *_acquire(size_t cap) {
+    return cap <= _inline_cap ? _buffer.data() : _alloc.allocate(cap);
+  }
+  void _release() {
+    if (!_data) {
+      return;
+    }
+    for (size_t i = 0; i < _capacity; i++) {
+      _traits_t::destroy(_alloc, _data + i);
+    }
+    if (!_is_inline()) {
+      _alloc.deallocate(_data, _capacity);
+    }
+  }
+  void _clear() {
+    _release();
+    _shape = shape_type();
+    _capacity = 0;
+    _data = nullptr;
+  }
+  // adopts the elements of st, *this must hold none
+  void _take(storage &st) {
+    _shape = st._shape;
+    _alloc = st._alloc;
+    if (st._is_inline()) {
+      _data = _buffer.data();
+      _relocate(_data, st._data, st._capacity, _bitwise_t());
+      _capacity = st._capacity;
+    } else {
+      _data = st._data;
+      _capacity = st._capacity;
+      st._data = nullptr;
+      st._capacity = 0;
+    }
+    st._shape = shape_type();
+  }
+
+  // capacity for nmag elements when growing
+  size_t _grown_capacity(size_t nmag) const {
+    const auto ncap = detail::_padded_capacity<AllocT>(
+        std::max(nmag, _capacity + _capacity / 2));
+    // stay inline as long as nmag fits
+    return ncap > _inline_cap &&
+                   detail::_padded_capacity<AllocT>(nmag) <= _inline_cap
+               ? _inline_cap
+               : ncap;
+  }
+  // moves the first min(capacity(), ncap) elements to memory for ncap
+  // elements, see _construct_tail for the new ones, an inline buffer in use
+  // only ever grows
+  void _reallocate(size_t ncap, size_t mag) {
+    if (_is_inline() && ncap <= _inline_cap) { // grow in place
+      _construct_tail(_data, _capacity, ncap, mag);
+      _capacity = ncap;
+      return;
+    }
+    const auto keep = std::min(_capacity, ncap);
+    value_type *ndata = _acquire(ncap);
+    _relocate(ndata, _data, keep, _bitwise_t());
+    _construct_tail(ndata, keep, ncap, mag);
+    _release();
+    _capacity = ncap;
+    _data = ndata;
+  }
+  // value-initializes the padding after mag elements when AllocT pads, a
+  // kept capacity may hold stale elements there
+  void _reset_padding(size_t mag) {
+    if (detail::_storage_padding<AllocT>::value > 1) {
+      const auto pcap = std::min(_capacity,
+                                 detail::_padded_capacity<AllocT>(mag));
+      std::fill(_data + mag, _data + pcap, value_type());
+    }
+  }
+  // constructs [first, last) of p, elements before mag are to be overwritten
+  // and left indeterminate if they are trivial, the padding from mag on is
+  // value-initialized
+  void _construct_tail(value_type *p, size_t first, size_t last, size_t mag) {
+    const auto m = std::max(first, std::min(mag, last));
+    uninitialized_default_init_n(p + first, m - first, _alloc);
+    uninitialized_default_fill_n(p + m, last - m, _alloc);
+  }
+
+  void _copy_construct(value_type *to, const value_type *from, size_t n, yes) {
+    if (n > 0) {
+      std::memcpy(to, from, n * sizeof(value_type));
+    }
+  }
+  void _copy_construct(value_type *to, const value_type *from, size_t n, no) {
+    for (size_t i = 0; i < n; i++) {
+      _traits_t::construct(_alloc, to + i, from[i]);
+    }
+  }
+  void _copy_assign(value_type *to, const value_type *from, size_t n, yes) {
+    if (n > 0) {
+      std::memcpy(to, from, n * sizeof(value_type));
+    }
+  }
+  void _copy_assign(value_type *to, const value_type *from, size_t n, no) {
+    for (size_t i = 0; i < n; i++) {
+      to[i] = from[i];
+    }
+  }
+  // the sources are left to be destroyed by _release
+  void _relocate(value_type *to, value_type *from, size_t n, yes) {
+    if (n > 0) {
+      std::memcpy(to, from, n * sizeof(value_type));
+    }
+  }
+  void _relocate(value_type *to, value_type *from, size_t n, no) {
+    for (size_t i = 0; i < n; i++) {
+      _traits_t::construct(_alloc, to + i, std::move(from[i]));
+    }
+  }
 
 private:
   shape_type _shape;
   size_t _capacity;
   value_type *_data;
-  std::allocator<value_type> _alloc;
+  allocator_type _alloc;
+  detail::_storage_inline_buffer<T, _inline_cap,
+                                 detail::_storage_alignment<AllocT>::value>
+      _buffer;
 };
+template <class T, class ShapeT, class AllocT>
+constexpr size_t storage<T, ShapeT, false, AllocT>::_inline_cap;
 
 template <class T, class ShapeT> class map_storage<T, ShapeT, false> {
   static_assert(is_tensor_shape<ShapeT>::value,
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <vector>
+
 #include "storage.hpp"
 
 using namespace wheels;
@@ -11,4 +13,213 @@ TEST(tensor, storage) {
   ASSERT_EQ(st1.capacity(), 5);
   st1.reshape(make_shape(10));
   ASSERT_EQ(st1.capacity(), 10);
-}
\ No newline at end of file
+}
+TEST(tensor, storage_alignment) {
+  using shape_t = tensor_shape<size_t, size_t>;
+  for (size_t n : {1, 3, 17, 1000}) {
+    storage<float, shape_t> st(make_shape(n), 1.0f);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(st.data()) % 64, 0);
+    ASSERT_EQ(st.capacity(), n);
+  }
+  // an inline buffer on the heap
+  std::vector<storage<float, shape_t>> sts(5, storage<float, shape_t>(
+                                                  make_shape(3), 1.0f));
+  for (auto &st : sts) {
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(st.data()) % 64, 0);
+  }
+
+  using padded_t =
+      storage<float, shape_t, false, aligned_allocator<float, 64, true>>;
+  constexpr size_t w = wheels_simd_bytes / sizeof(float);
+  padded_t st(make_shape(5), 2.0f);
+  ASSERT_EQ(st.capacity() % w, 0);
+  ASSERT_GE(st.capacity(), 5);
+  for (size_t i = 0; i < st.capacity(); i++) {
+    ASSERT_EQ(st.data()[i], i < 5 ? 2.0f : 0.0f);
+  }
+  st.reshape(make_shape(w * 31 + 1)); // past the inline buffer
+  ASSERT_EQ(st.capacity(), w * 32);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(st.data()) % 64, 0);
+  padded_t st2 = st;
+  ASSERT_EQ(st2.capacity(), w * 32);
+  ASSERT_EQ(st2.data()[0], 2.0f);
+}
+
+TEST(tensor, storage_uninitialized) {
+  using shape_t = tensor_shape<size_t, size_t>;
+  storage<std::string, shape_t> st1(make_shape(4), with_uninitialized);
+  ASSERT_EQ(st1.capacity(), 4);
+  for (size_t i = 0; i < 4; i++) {
+    ASSERT_TRUE(st1.data()[i].empty());
+  }
+  storage<double, shape_t> st2(make_shape(1000), with_uninitialized);
+  std::fill(st2.data(), st2.data() + 1000, 1.0);
+  st2.reshape(make_shape(3000));
+  ASSERT_EQ(st2.data()[999], 1.0);
+  ASSERT_EQ(st2.data()[1000], 0.0);
+  ASSERT_EQ(st2.data()[2999], 0.0);
+}
+TEST(tensor, storage_inline) {
+  using shape_t = tensor_shape<size_t, size_t>;
+  using st_t = storage<double, shape_t>;
+  ASSERT_EQ(st_t::_inline_cap, 8);
+  auto inside = [](const st_t &st) {
+    auto p = reinterpret_cast<const char *>(st.data());
+    auto o = reinterpret_cast<const char *>(&st);
+    return p >= o && p < o + sizeof(st_t);
+  };
+  st_t empty;
+  ASSERT_TRUE(inside(empty));
+  st_t a(make_shape(3), 1.0), b(make_shape(100), 2.0);
+  ASSERT_TRUE(inside(a));
+  ASSERT_FALSE(inside(b));
+
+  a.swap(b);
+  ASSERT_FALSE(inside(a));
+  ASSERT_TRUE(inside(b));
+  ASSERT_EQ(a.shape().magnitude(), 100);
+  ASSERT_EQ(a.data()[99], 2.0);
+  ASSERT_EQ(b.shape().magnitude(), 3);
+  ASSERT_EQ(b.data()[2], 1.0);
+
+  st_t c(std::move(b));
+  ASSERT_TRUE(inside(c));
+  ASSERT_EQ(c.data()[2], 1.0);
+  c.reshape(make_shape(6)); // grows in place
+  ASSERT_TRUE(inside(c));
+  ASSERT_EQ(c.data()[2], 1.0);
+  ASSERT_EQ(c.data()[5], 0.0);
+  c.reshape(make_shape(9)); // moves to the heap
+  ASSERT_FALSE(inside(c));
+  ASSERT_EQ(c.data()[2], 1.0);
+  ASSERT_EQ(c.data()[8], 0.0);
+  c = st_t(make_shape(2), 5.0);
+  ASSERT_TRUE(inside(c));
+  ASSERT_EQ(c.data()[1], 5.0);
+  st_t d;
+  d = c;
+  ASSERT_TRUE(inside(d));
+  ASSERT_EQ(d.data()[1], 5.0);
+
+  // non trivial elements are never inline
+  storage<std::string, shape_t> s;
+  ASSERT_EQ(s.capacity(), 0);
+  s.reshape(make_shape(2));
+  ASSERT_TRUE(s.data()[1].empty());
+}
+TEST(tensor, storage_capacity) {
+  using shape_t = tensor_shape<size_t, size_t>;
+  using st_t = storage<double, shape_t>;
+
+  // amortized growth
+  st_t st;
+  size_t regrows = 0;
+  for (size_t n = 1; n <= 1000; n++) {
+    const double *old = st.data();
+    st.reshape(make_shape(n));
+    st.data()[n - 1] = double(n);
+    regrows += st.data() != old;
+  }
+  ASSERT_LE(regrows, 20);
+  for (size_t i = 0; i < 1000; i++) {
+    ASSERT_EQ(st.data()[i], double(i + 1));
+  }
+  st.reshape(make_shape(10));
+  st.reshape(make_shape(20)); // reset beyond the old magnitude
+  ASSERT_EQ(st.data()[9], 10.0);
+  ASSERT_EQ(st.data()[10], 0.0);
+
+  // copy assignment keeps a sufficient capacity
+  const size_t cap = st.capacity();
+  st = st_t(make_shape(100), 3.0);
+  ASSERT_EQ(st.capacity(), 100);
+  st_t big(make_shape(500), 4.0);
+  st = big;
+  ASSERT_EQ(st.capacity(), 500);
+  st.reshape(make_shape(50));
+  st_t small(make_shape(50), 6.0);
+  st = small;
+  ASSERT_EQ(st.capacity(), 500);
+  ASSERT_EQ(st.data()[49], 6.0);
+  ASSERT_GE(cap, 1000);
+
+  st.shrink_to_fit();
+  ASSERT_EQ(st.capacity(), 50);
+  ASSERT_EQ(st.data()[49], 6.0);
+  st.reserve(300);
+  ASSERT_EQ(st.capacity(), 300);
+  ASSERT_EQ(st.data()[49], 6.0);
+  ASSERT_EQ(st.data()[299], 0.0);
+  st.resize_uninitialized(make_shape(200));
+  ASSERT_EQ(st.capacity(), 300);
+  ASSERT_EQ(st.data()[49], 6.0);
+  st.reshape(make_shape(4));
+  st.shrink_to_fit(); // back to the inline buffer
+  ASSERT_EQ(st.capacity(), 4);
+  ASSERT_EQ(st.data()[3], 6.0);
+
+  // padding stays value-initialized when the capacity is kept
+  using padded_t =
+      storage<float, shape_t, false, aligned_allocator<float, 64, true>>;
+  constexpr size_t w = wheels_simd_bytes / sizeof(float);
+  padded_t pst(make_shape(w * 40), 4.0f);
+  padded_t pst2(make_shape(w + 1), 5.0f);
+  pst = pst2;
+  ASSERT_EQ(pst.capacity(), w * 40);
+  for (size_t i = w + 1; i < w * 2; i++) {
+    ASSERT_EQ(pst.data()[i], 0.0f);
+  }
+  pst.reshape(make_shape(1));
+  for (size_t i = 1; i < w; i++) {
+    ASSERT_EQ(pst.data()[i], 0.0f);
+  }
+
+  // non trivial elements
+  storage<std::string, shape_t> ss(make_shape(3), "x");
+  ss.reserve(10);
+  ss.resize_uninitialized(make_shape(5));
+  ASSERT_EQ(ss.data()[2], "x");
+  ASSERT_TRUE(ss.data()[4].empty());
+  ss.reshape(make_shape(2));
+  ss.shrink_to_fit();
+  ASSERT_EQ(ss.capacity(), 2);
+  ASSERT_EQ(ss.data()[1], "x");
+  storage<std::string, shape_t> ss2;
+  ss2 = ss;
+  ASSERT_EQ(ss2.data()[1], "x");
+}
+TEST(tensor, scoped_arena) {
+  using shape_t = tensor_shape<size_t, size_t>;
+  ASSERT_EQ(scoped_arena::current(), nullptr);
+  storage<double, shape_t> escaped;
+  {
+    scoped_arena arena(1024);
+    ASSERT_EQ(scoped_arena::current(), &arena);
+    const double *first = nullptr;
+    for (int k = 0; k < 3; k++) {
+      // temporaries of each iteration reuse the same memory
+      storage<double, shape_t> st(make_shape(10), double(k));
+      ASSERT_EQ(reinterpret_cast<uintptr_t>(st.data()) % 64, 0);
+      if (first == nullptr) {
+        first = st.data();
+      }
+      ASSERT_EQ(st.data(), first);
+    }
+    {
+      scoped_arena inner;
+      ASSERT_EQ(scoped_arena::current(), &inner);
+    }
+    ASSERT_EQ(scoped_arena::current(), &arena);
+    storage<double, shape_t> big(make_shape(1000), 2.0); // from the heap
+    escaped = storage<double, shape_t>(make_shape(20), 3.0);
+    for (int k = 0; k < 100; k++) {
+      storage<float, shape_t> st(make_shape(size_t(k + 1)), 1.0f);
+      ASSERT_EQ(st.data()[k], 1.0f);
+    }
+    ASSERT_EQ(big.data()[999], 2.0);
+  }
+  ASSERT_EQ(scoped_arena::current(), nullptr);
+  for (size_t i = 0; i < 20; i++) {
+    ASSERT_EQ(escaped.data()[i], 3.0);
+  }
+}
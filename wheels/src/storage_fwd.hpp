@@ -24,6 +24,17 @@
 
 #pragma once
 
+#include <cstddef>
+
+#ifndef wheels_storage_pad_to_simd
+#define wheels_storage_pad_to_simd false
+#endif
+
+// bytes of elements dynamic storages keep inline before allocating
+#ifndef wheels_storage_inline_bytes
+#define wheels_storage_inline_bytes 64
+#endif
+
 namespace wheels {
 struct _with_elements {
   constexpr _with_elements() {}
@@ -33,10 +44,25 @@ struct _with_iterators {
   constexpr _with_iterators() {}
 };
 constexpr _with_iterators with_iterators = {};
+struct _with_uninitialized {
+  constexpr _with_uninitialized() {}
+};
+constexpr _with_uninitialized with_uninitialized = {};
 
-template <class T, class ShapeT, bool ShapeIsStatic = ShapeT::is_static>
+template <class T, size_t Align = 64,
+          bool PadToSimd = wheels_storage_pad_to_simd>
+class aligned_allocator;
+
+template <class T, class ShapeT, bool ShapeIsStatic = ShapeT::is_static,
+          class AllocT = aligned_allocator<T>>
 class storage;
 
 template <class T, class ShapeT, bool ShapeIsStatic = ShapeT::is_static>
 class map_storage;
+
+// storage_inline_capacity<T>
+// - how many elements of T a dynamic storage keeps inline, specialize it to
+//   tune an element type (0 disables the inline buffer), defaults to
+//   wheels_storage_inline_bytes of trivially copyable elements
+template <class T> struct storage_inline_capacity;
 }
@@ -0,0 +1,71 @@
+#include <benchmark/benchmark.h>
+
+#include "ewise.hpp"
+#include "tensor.hpp"
+
+using namespace wheels;
+
+static void linear_sizes(benchmark::internal::Benchmark *b) {
+  b->RangeMultiplier(10)->Range(16, 100000000);
+}
+
+// assign_elements
+static void tensor_assign_dynamic(benchmark::State &state) {
+  const size_t n = state.range(0);
+  vecx_<float> a(make_shape(n), 1.0f), b(make_shape(n));
+  for (auto _ : state) {
+    assign_elements(b, a);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * n * sizeof(float) * 2);
+}
+BENCHMARK(tensor_assign_dynamic)->Apply(linear_sizes);
+
+template <size_t N> static void tensor_assign_static(benchmark::State &state) {
+  vec_<float, N> a, b;
+  std::fill(a.ptr(), a.ptr() + N, 1.0f);
+  for (auto _ : state) {
+    assign_elements(b, a);
+    benchmark::DoNotOptimize(b.ptr());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * N * sizeof(float) * 2);
+}
+BENCHMARK_TEMPLATE(tensor_assign_static, 4);
+BENCHMARK_TEMPLATE(tensor_assign_static, 16);
+BENCHMARK_TEMPLATE(tensor_assign_static, 64);
+
+// reduce
+static void tensor_sum(benchmark::State &state) {
+  const size_t n = state.range(0);
+  vecx_<double> a(make_shape(n), 1.0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sum_of(a));
+  }
+  state.SetBytesProcessed(state.iterations() * n * sizeof(double));
+}
+BENCHMARK(tensor_sum)->Apply(linear_sizes);
+
+template <summation_method_enum SM>
+static void tensor_sum_method(benchmark::State &state) {
+  const size_t n = state.range(0);
+  vecx_<float> a(make_shape(n), 0.1f);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sum_of(a, summation_method<SM>()));
+  }
+  state.SetBytesProcessed(state.iterations() * n * sizeof(float));
+}
+BENCHMARK_TEMPLATE(tensor_sum_method, plain_summation)->Apply(linear_sizes);
+BENCHMARK_TEMPLATE(tensor_sum_method, pairwise_summation)
+    ->Apply(linear_sizes);
+BENCHMARK_TEMPLATE(tensor_sum_method, kahan_summation)->Apply(linear_sizes);
+
+static void tensor_norm_squared(benchmark::State &state) {
+  const size_t n = state.range(0);
+  vecx_<double> a(make_shape(n), 1.0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(norm_squared(a));
+  }
+  state.SetBytesProcessed(state.iterations() * n * sizeof(double));
+}
+BENCHMARK(tensor_norm_squared)->Apply(linear_sizes);
@@ -65,6 +65,10 @@ public:
   // tensor(shape)
   constexpr explicit tensor(const ShapeT &shape) : _storage(shape) {}
 
+  // tensor(shape, with_uninitialized)
+  // - trivial elements are left indeterminate
+  tensor(const ShapeT &shape, _with_uninitialized wu) : _storage(shape, wu) {}
+
   // tensor(shape, e)
   constexpr tensor(const ShapeT &shape, const value_type &v)
       : _storage(shape, v) {}
@@ -116,7 +120,7 @@ public:
   template <class AnotherShapeT, class AnotherT,
             class = std::enable_if_t<AnotherShapeT::rank == ShapeT::rank>>
   constexpr tensor(const tensor_base<ET, AnotherShapeT, AnotherT> &another)
-      : _storage(another.shape()) {
+      : _storage(another.shape(), with_uninitialized) {
     assign_elements(*this, another.derived());
   }
   template <class AnotherET, class AnotherShapeT, class AnotherT,
@@ -124,7 +128,7 @@ public:
                                      AnotherShapeT::rank == ShapeT::rank>>
   constexpr explicit tensor(
       const tensor_base<AnotherET, AnotherShapeT, AnotherT> &another)
-      : _storage(another.shape()) {
+      : _storage(another.shape(), with_uninitialized) {
     assign_elements_forced(*this, another.derived());
   }
 
@@ -132,6 +136,10 @@ public:
   ET *ptr() { return _storage.data(); }
   constexpr decltype(auto) shape() const { return _storage.shape(); }
   void reshape(const shape_type &s) { _storage.reshape(s); }
+  // elements beyond the old magnitude are left indeterminate if trivial
+  void resize_uninitialized(const shape_type &s) {
+    _storage.resize_uninitialized(s);
+  }
 
   using _base_t::operator=;
   using _base_t::operator+=;
@@ -159,10 +167,11 @@ template <class ET, class ShapeT> ET *ptr_of(tensor<ET, ShapeT> &t) {
 }
 
 // reserve_shape
+// - all elements are to be overwritten, so none are reset
 template <class ET, class ShapeT, class ST, class... SizeTs>
 void reserve_shape(tensor<ET, ShapeT> &t,
                    const tensor_shape<ST, SizeTs...> &shape) {
-  t.reshape(shape);
+  t.resize_uninitialized(shape);
 }
 
 // randomize
@@ -77,6 +77,115 @@ TEST(tensor, element) {
       ASSERT_TRUE(m1(last - i, last - j) == 8);
     }
   }
+
+  // iterating a view walks its subscripts incrementally
+  matx m2(make_shape(3, 4), {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
+  auto m2t = m2.t();
+  size_t k = 0;
+  for (double e : m2t) {
+    ASSERT_EQ(e, m2(k % 3, k / 3));
+    k++;
+  }
+  ASSERT_EQ(k, 12);
+  // continuous tensors step the linear index only
+  static_assert(sizeof(tensor_iterator<matx>) ==
+                    sizeof(matx *) + sizeof(ptrdiff_t),
+                "continuous iterators should not hold a cursor");
+  k = 0;
+  for (double e : m2) {
+    ASSERT_EQ(e, double(k));
+    k++;
+  }
+  ASSERT_EQ(k, 12);
+}
+
+TEST(tensor, parallel_assign) {
+  std::default_random_engine rng;
+  auto a = rand(make_shape(103, 37), rng);
+  auto b = (a * 2.0 + 1.0).eval();
+  auto at = a.t().eval();
+
+  set_parallel_threshold(64);
+  matx c = a * 2.0 + 1.0;
+  matx ct = a.t();
+  matx d(make_shape(103, 37));
+  d = 5.0;
+  d += a;
+  vecx e = zeros(make_shape(200));
+  e.block(range(0, 2, 199)) = ones(make_shape(100));
+  set_parallel_threshold(0);
+
+  ASSERT_TRUE(c == b);
+  ASSERT_TRUE(ct == at);
+  ASSERT_TRUE(d == (a + 5.0).eval());
+  for (size_t i = 0; i < 200; i++) {
+    ASSERT_EQ(e[i], i % 2 == 0 ? 1.0 : 0.0);
+  }
+}
+
+TEST(tensor, reduce) {
+  vecx a(make_shape(10000));
+  for (size_t i = 0; i < a.numel(); i++) {
+    a[i] = (double)(i % 7);
+  }
+  ASSERT_EQ(a.sum(), 29994.0);
+  ASSERT_EQ(norm_squared(a), 129962.0);
+  ASSERT_EQ(nonzero_elements_count(a), 8571);
+  ASSERT_EQ(reduce_elements(a, 100.0,
+                            [](double x, double y) { return std::max(x, y); }),
+            100.0);
+  ASSERT_EQ(reduce_elements(a, -1.0,
+                            [](double x, double y) { return std::max(x, y); }),
+            6.0);
+
+  // accumulator type differs from the element type
+  vecx b(make_shape(100000));
+  for (size_t i = 0; i < b.numel(); i++) {
+    b[i] = i % 3 == 0 ? 1.0 : -1.0;
+  }
+  ASSERT_EQ(reduce_elements(b, (size_t)0,
+                            [](size_t n, double e) { return n + (e > 0); }),
+            33334);
+  ASSERT_EQ(parallel_reduce_elements(
+                b, (size_t)0, [](size_t n, double e) { return n + (e > 0); },
+                [](size_t x, size_t y) { return x + y; }),
+            33334);
+  ASSERT_EQ(sum_of(a.reshaped(make_shape(100, 100)).t()), a.sum());
+  ASSERT_EQ(vecx().sum(), 0.0);
+}
+
+TEST(tensor, reduce_dense) {
+  // all tail lengths
+  for (size_t n = 0; n < 70; n++) {
+    vecx_<float> a(make_shape(n));
+    double s = 0, s2 = 0;
+    for (size_t i = 0; i < n; i++) {
+      a[i] = float(i % 5) - 1.5f;
+      s += a[i];
+      s2 += a[i] * a[i];
+    }
+    ASSERT_EQ(a.sum(), s);
+    ASSERT_EQ(sum_of(a, summation_method<pairwise_summation>()), s);
+    ASSERT_EQ(sum_of(a, summation_method<kahan_summation>()), s);
+    ASSERT_EQ(norm_squared(a), s2);
+    ASSERT_EQ(norm_squared(a, summation_method<kahan_summation>()), s2);
+  }
+  vecx_<int> ai(make_shape(1001), 3);
+  ASSERT_EQ(ai.sum(), 3003);
+  ASSERT_EQ(norm_squared(ai), 9009);
+
+  // accuracy
+  vecx_<float> a(make_shape(1 << 22), 0.1f);
+  const double exact = double(0.1f) * a.numel();
+  auto err = [exact](float s) { return std::abs(s - exact) / exact; };
+  ASSERT_LT(err(sum_of(a, summation_method<kahan_summation>())), 1e-7);
+  ASSERT_LT(err(sum_of(a, summation_method<pairwise_summation>())), 1e-6);
+  ASSERT_LT(err(a.sum()), 1e-3);
+  ASSERT_EQ(sum_of(a), sum_of(a)); // deterministic
+  // views honour the method too
+  auto at = a.reshaped(make_shape(1 << 11, 1 << 11)).t();
+  ASSERT_LT(err(sum_of(at, summation_method<kahan_summation>())), 1e-7);
+  ASSERT_LT(err(sum_of(at, summation_method<pairwise_summation>())), 1e-5);
 }
 
 TEST(tensor, demo) {
@@ -30,6 +30,7 @@
 
 #include "aligned_fwd.hpp"
 #include "block_fwd.hpp"
+#include "cache_fwd.hpp"
 #include "cartesian_fwd.hpp"
 #include "cat_fwd.hpp"
 #include "constants_fwd.hpp"
@@ -39,6 +40,7 @@
 #include "index_fwd.hpp"
 #include "iota_fwd.hpp"
 #include "permute_fwd.hpp"
+#include "reduce_fwd.hpp"
 #include "remap_fwd.hpp"
 #include "reshape_fwd.hpp"
 #include "tensor_fwd.hpp"
@@ -49,6 +51,7 @@
 #include "const_ints.hpp"
 #include "iterators.hpp"
 #include "parallel.hpp"
+#include "simd.hpp"
 #include "types.hpp"
 #include "what.hpp"
 
@@ -204,6 +207,69 @@ template <class T> struct tensor_core : object_base<T> {
     return scalarize(std::move(this->derived()));
   }
 
+  // cached
+  constexpr auto cached() const & { return ::wheels::cached(this->derived()); }
+  auto cached() & { return ::wheels::cached(this->derived()); }
+  auto cached() && { return ::wheels::cached(std::move(this->derived())); }
+
+  // reduce_along(axis, op), sum_along(axis), ...
+  template <class K, K Axis, class OpT>
+  constexpr auto reduce_along(const const_ints<K, Axis> &axis, OpT op) const & {
+    return ::wheels::reduce_along(this->derived(), axis, op);
+  }
+  template <class K, K Axis, class OpT>
+  auto reduce_along(const const_ints<K, Axis> &axis, OpT op) && {
+    return ::wheels::reduce_along(std::move(this->derived()), axis, op);
+  }
+  template <class K, K Axis>
+  constexpr auto sum_along(const const_ints<K, Axis> &axis) const & {
+    return ::wheels::sum_along(this->derived(), axis);
+  }
+  template <class K, K Axis>
+  auto sum_along(const const_ints<K, Axis> &axis) && {
+    return ::wheels::sum_along(std::move(this->derived()), axis);
+  }
+  template <class K, K Axis>
+  constexpr auto mean_along(const const_ints<K, Axis> &axis) const & {
+    return ::wheels::mean_along(this->derived(), axis);
+  }
+  template <class K, K Axis>
+  auto mean_along(const const_ints<K, Axis> &axis) && {
+    return ::wheels::mean_along(std::move(this->derived()), axis);
+  }
+  template <class K, K Axis>
+  constexpr auto min_along(const const_ints<K, Axis> &axis) const & {
+    return ::wheels::min_along(this->derived(), axis);
+  }
+  template <class K, K Axis>
+  auto min_along(const const_ints<K, Axis> &axis) && {
+    return ::wheels::min_along(std::move(this->derived()), axis);
+  }
+  template <class K, K Axis>
+  constexpr auto max_along(const const_ints<K, Axis> &axis) const & {
+    return ::wheels::max_along(this->derived(), axis);
+  }
+  template <class K, K Axis>
+  auto max_along(const const_ints<K, Axis> &axis) && {
+    return ::wheels::max_along(std::move(this->derived()), axis);
+  }
+  template <class K, K Axis>
+  constexpr auto argmin_along(const const_ints<K, Axis> &axis) const & {
+    return ::wheels::argmin_along(this->derived(), axis);
+  }
+  template <class K, K Axis>
+  auto argmin_along(const const_ints<K, Axis> &axis) && {
+    return ::wheels::argmin_along(std::move(this->derived()), axis);
+  }
+  template <class K, K Axis>
+  constexpr auto argmax_along(const const_ints<K, Axis> &axis) const & {
+    return ::wheels::argmax_along(this->derived(), axis);
+  }
+  template <class K, K Axis>
+  auto argmax_along(const const_ints<K, Axis> &axis) && {
+    return ::wheels::argmax_along(std::move(this->derived()), axis);
+  }
+
   // block
   template <class... TensorOrIndexTs>
   constexpr auto block(TensorOrIndexTs &&... tois) const & {
@@ -225,13 +291,13 @@ template <class T> struct tensor_core : object_base<T> {
 
   // for_each
   template <class FunT> void for_each(FunT fun) const & {
-    for_each_element(behavior_flag<unordered>(), fun, this->derived());
+    for_each_element(behavior_flag<index_ascending>(), fun, this->derived());
   }
   template <class FunT> void for_each(FunT fun) & {
-    for_each_element(behavior_flag<unordered>(), fun, this->derived());
+    for_each_element(behavior_flag<index_ascending>(), fun, this->derived());
   }
   template <class FunT> void for_each(FunT fun) && {
-    for_each_element(behavior_flag<unordered>(), fun,
+    for_each_element(behavior_flag<index_ascending>(), fun,
                      std::move(this->derived()));
   }
 
@@ -330,10 +396,10 @@ template <class T> struct tensor_core : object_base<T> {
   constexpr bool none() const { return !any_of(this->derived()); }
 
   // begin/end
-  constexpr tensor_iterator<const T> begin() const {
+  tensor_iterator<const T> begin() const {
     return tensor_iterator<const T>(this->derived(), 0);
   }
-  constexpr tensor_iterator<const T> end() const {
+  tensor_iterator<const T> end() const {
     return tensor_iterator<const T>(this->derived(), this->numel());
   }
   tensor_iterator<T> begin() { return tensor_iterator<T>(this->derived(), 0); }
@@ -396,32 +462,67 @@ constexpr bool operator!=(const tensor_core<T1> &a, const tensor_core<T2> &b) {
 }
 
 // tensor_iterator
-template <class T> struct tensor_iterator {
+// - tensors with continuous data are dereferenced by the linear index, others
+//   keep a subscript_cursor next to it, so that stepping through them does
+//   not decode every index
+namespace detail {
+template <class T> constexpr no _is_continuous_data(const tensor_core<T> &);
+template <class ET, class ShapeT, class T>
+constexpr yes
+_is_continuous_data(const tensor_continuous_data_base<ET, ShapeT, T> &);
+
+template <class T, bool Continuous> struct _tensor_iterator_base {
   T &self;
   ptrdiff_t ind;
-  constexpr tensor_iterator(T &s, ptrdiff_t i) : self(s), ind(i) {}
-  constexpr decltype(auto) operator*() const {
+  constexpr _tensor_iterator_base(T &s, ptrdiff_t i) : self(s), ind(i) {}
+  constexpr decltype(auto) _deref() const {
     return element_at_index(self, ind);
   }
-  constexpr decltype(auto) operator-> () const {
-    return element_at_index(self, ind);
+  void _step() { ++ind; }
+};
+template <class T> struct _tensor_iterator_base<T, false> {
+  using shape_type = std::decay_t<decltype(shape_of(std::declval<T &>()))>;
+  T &self;
+  ptrdiff_t ind;
+  subscript_cursor<shape_type> cursor;
+  _tensor_iterator_base(T &s, ptrdiff_t i)
+      : self(s), ind(i), cursor(shape_of(s), i) {}
+  decltype(auto) _deref() const {
+    return cursor.invoke([this](auto... subs) -> decltype(auto) {
+      return element_at(self, subs...);
+    });
   }
-  tensor_iterator &operator++() {
+  void _step() {
     ++ind;
+    ++cursor;
+  }
+};
+}
+template <class T>
+struct tensor_iterator
+    : detail::_tensor_iterator_base<
+          T, decltype(detail::_is_continuous_data(std::declval<T &>()))::value> {
+  using base_t = detail::_tensor_iterator_base<
+      T, decltype(detail::_is_continuous_data(std::declval<T &>()))::value>;
+  constexpr tensor_iterator(T &s, ptrdiff_t i) : base_t(s, i) {}
+  constexpr decltype(auto) operator*() const { return this->_deref(); }
+  constexpr decltype(auto) operator-> () const { return this->_deref(); }
+  tensor_iterator &operator++() {
+    this->_step();
     return *this;
   }
   tensor_iterator operator++(int) {
     auto i = *this;
-    ++ind;
+    this->_step();
     return i;
   }
   constexpr bool operator==(const tensor_iterator &i) const {
-    assert(&self == &(i.self));
-    return ind == i.ind;
+    assert(&this->self == &(i.self));
+    return this->ind == i.ind;
   }
   constexpr bool operator!=(const tensor_iterator &i) const {
-    assert(&self == &(i.self));
-    return ind != i.ind;
+    assert(&this->self == &(i.self));
+    return this->ind != i.ind;
   }
 };
 
@@ -563,27 +664,70 @@ void _for_each_element_unordered_default(yes staticShape, FunT fun, T &&t,
                    std::forward<Ts>(ts)...);
 }
 
-static constexpr size_t _numel_parallel_thres = (size_t)4e4;
+// whether elements are laid out linearly in memory
+template <class T> constexpr no _is_continuous_data(const tensor_core<T> &) {
+  return no();
+}
+template <class ET, class ShapeT, class T>
+constexpr yes
+_is_continuous_data(const tensor_continuous_data_base<ET, ShapeT, T> &) {
+  return yes();
+}
+
+// visit elements of [first, last)
+template <class FunT, class T, class... Ts>
+void _for_each_element_in_range(yes, size_t first, size_t last,
+                                FunT &fun, T &t, Ts &... ts) {
+  for (size_t i = first; i < last; i++) {
+    fun(element_at_index(t, i), element_at_index(ts, i)...);
+  }
+}
+template <class FunT, class T, class... Ts>
+void _for_each_element_in_range(no, size_t first, size_t last,
+                                FunT &fun, T &t, Ts &... ts) {
+  for_each_subscript_in_range(t.shape(), first, last, [&](auto... subs) {
+    fun(element_at(t, subs...), element_at(ts, subs...)...);
+  });
+}
+
 template <class FunT, class T, class... Ts>
-void _for_each_element_unordered_parallel(FunT &&fun, T &&t, Ts &&... ts) {
-  parallel_for_each((size_t)(numel_of(t)),
-                    [&fun, &t, &ts...](size_t i) {
-                      fun(element_at_index(t.derived(), i),
-                          element_at_index(ts.derived(), i)...);
-                    },
-                    _numel_parallel_thres / 2);
+void _for_each_element_unordered_parallel(FunT &fun, T &t, Ts &... ts) {
+  auto &pool = default_thread_pool();
+  const size_t n = numel_of(t);
+  const size_t chunk_size =
+      std::max(parallel_threshold() / 2,
+               (n + (pool.worker_num() + 1) * 4 - 1) /
+                   ((pool.worker_num() + 1) * 4));
+  using all_continuous_t = decltype(
+      const_ints<bool, decltype(_is_continuous_data(t))::value,
+                 decltype(_is_continuous_data(ts))::value...>::all());
+  pool.run((n + chunk_size - 1) / chunk_size,
+           [&fun, &t, &ts..., n, chunk_size](size_t c) {
+             _for_each_element_in_range(all_continuous_t(), c * chunk_size,
+                                        std::min(n, (c + 1) * chunk_size),
+                                        fun, t, ts...);
+           });
+}
+
+// only the written tensor decides whether splitting is safe: it must be
+// mutable (a const traversal usually accumulates into shared state) and its
+// elements must not alias each other, which is guaranteed by continuous data
+// but not by views such as block_view or index_view
+template <class T> constexpr bool _can_split_unordered_traversal() {
+  return !std::is_const<std::remove_reference_t<T>>::value &&
+         decltype(_is_continuous_data(std::declval<T &>()))::value;
 }
 
 template <class FunT, class T, class... Ts>
 void _for_each_element_unordered_default(no staticShape, FunT fun, T &&t,
                                          Ts &&... ts) {
   assert(all_same(t.shape(), ts.shape()...));
-  if (true) { // if (t.numel() < _numel_parallel_thres) { // FIXME
+  if (!_can_split_unordered_traversal<T>() ||
+      (size_t)numel_of(t) < parallel_threshold()) {
     for_each_element(behavior_flag<index_ascending>(), fun, std::forward<T>(t),
                      std::forward<Ts>(ts)...);
   } else {
-    _for_each_element_unordered_parallel(fun, std::forward<T>(t),
-                                         std::forward<Ts>(ts)...);
+    _for_each_element_unordered_parallel(fun, t, ts...);
   }
 }
 }
@@ -700,30 +844,265 @@ void fill_elements_with(tensor_core<T> &t, const E &e) {
                    t.derived());
 }
 
+// reduce elements of t by chunks on parallel_reduce_chunks
+// - acc(partial, e) folds an element into a chunk partial starting from
+//   identity, combine(a, b) merges partials, see parallel_reduce_chunks for
+//   the ordering guarantees
+namespace detail {
+template <class E, class T, class AccT, class CombineT>
+E _reduce_elements_by_chunks(const tensor_core<T> &t, const E &identity,
+                             AccT &&acc, CombineT &&combine) {
+  decltype(auto) td = t.derived();
+  using all_continuous_t = decltype(_is_continuous_data(td));
+  return parallel_reduce_chunks(
+      (size_t)numel_of(td), identity,
+      [&td, &identity, &acc](size_t first, size_t last) {
+        E partial = identity;
+        auto fold = [&partial, &acc](auto &&e) { acc(partial, e); };
+        _for_each_element_in_range(all_continuous_t(), first, last, fold, td);
+        return partial;
+      },
+      combine);
+}
+}
+
 // size_t nonzero_elements_count(t)
-template <class T> size_t nonzero_elements_count(const tensor_core<T> &t) {
+// - continuous tensors are counted by chunks in parallel, others through the
+//   nonzero_only traversal so that sparse generators skip their zeros
+namespace detail {
+template <class T>
+size_t _nonzero_elements_count(yes, const tensor_core<T> &t) {
+  return _reduce_elements_by_chunks(
+      t, (size_t)0, [](size_t &nzc, auto &&e) { nzc += !is_zero(e); },
+      [](size_t a, size_t b) { return a + b; });
+}
+template <class T>
+size_t _nonzero_elements_count(no, const tensor_core<T> &t) {
   size_t nzc = 0;
-  for_each_element(behavior_flag<nonzero_only>(), [&nzc](auto &&e) { nzc++; },
+  for_each_element(behavior_flag<nonzero_only>(), [&nzc](auto &&) { nzc++; },
                    t.derived());
   return nzc;
 }
+}
+template <class T> size_t nonzero_elements_count(const tensor_core<T> &t) {
+  return detail::_nonzero_elements_count(
+      decltype(detail::_is_continuous_data(t.derived()))(), t);
+}
 
 // Scalar reduce_elements(ts, initial, functor);
+// - folds sequentially, initial = red(initial, e) for each element
 template <class T, class E, class ReduceT>
 E reduce_elements(const tensor_core<T> &t, E initial, ReduceT &&red) {
-  for_each_element(behavior_flag<unordered>(),
-                   [&initial, &red](auto &&e) { initial = red(initial, e); },
-                   t.derived());
+  decltype(auto) td = t.derived();
+  using all_continuous_t = decltype(detail::_is_continuous_data(td));
+  auto fold = [&initial, &red](auto &&e) { initial = red(initial, e); };
+  detail::_for_each_element_in_range(all_continuous_t(), 0,
+                                     (size_t)numel_of(td), fold, td);
   return initial;
 }
 
+// Scalar parallel_reduce_elements(ts, identity, functor, combiner);
+// - each chunk folds partial = red(partial, e) starting from identity, the
+//   chunk results are merged by combine in a fixed order, see
+//   parallel_reduce_chunks
+template <class T, class E, class ReduceT, class CombineT>
+E parallel_reduce_elements(const tensor_core<T> &t, const E &identity,
+                           ReduceT &&red, CombineT &&combine) {
+  return detail::_reduce_elements_by_chunks(
+      t, identity, [&red](E &partial, auto &&e) { partial = red(partial, e); },
+      combine);
+}
+
+// dense reductions
+// - continuous tensors of arithmetic elements are summed chunk by chunk on
+//   parallel_reduce_chunks straight from ptr(), with simd packs and the
+//   given summation_method inside each chunk, the chunk sums are merged
+//   plainly
+// - other tensors fold their nonzero elements in order through the
+//   nonzero_only traversal, with the method applied to the running sum
+namespace detail {
+// terms of sum_of
+struct _dense_sum_term {
+  template <class PackT>
+  static typename PackT::type term(const typename PackT::type &x) {
+    return x;
+  }
+  template <class PackT>
+  static typename PackT::type fold(const typename PackT::type &acc,
+                                   const typename PackT::type &x) {
+    return PackT::add(acc, x);
+  }
+  template <class E> static const E &term1(const E &x) { return x; }
+};
+// terms of norm_squared
+struct _dense_square_term {
+  template <class PackT>
+  static typename PackT::type term(const typename PackT::type &x) {
+    return PackT::mul(x, x);
+  }
+  template <class PackT>
+  static typename PackT::type fold(const typename PackT::type &acc,
+                                   const typename PackT::type &x) {
+    return PackT::fma(x, x, acc);
+  }
+  template <class E> static auto term1(const E &x) { return x * x; }
+};
+
+template <class TermT, class E>
+E _dense_sum(summation_method<plain_summation>, const E *p, size_t n) {
+  using pack = simd_pack<E>;
+  constexpr size_t w = pack::size;
+  typename pack::type acc[4] = {pack::zero(), pack::zero(), pack::zero(),
+                                pack::zero()};
+  size_t i = 0;
+  for (; i + 4 * w <= n; i += 4 * w) {
+    for (size_t j = 0; j < 4; j++) {
+      acc[j] = TermT::template fold<pack>(acc[j], pack::load(p + i + j * w));
+    }
+  }
+  for (; i + w <= n; i += w) {
+    acc[0] = TermT::template fold<pack>(acc[0], pack::load(p + i));
+  }
+  E s = pack::sum(pack::add(pack::add(acc[0], acc[1]),
+                            pack::add(acc[2], acc[3])));
+  for (; i < n; i++) {
+    s += TermT::term1(p[i]);
+  }
+  return s;
+}
+
+static constexpr size_t _pairwise_block = 256;
+template <class TermT, class E>
+E _dense_sum(summation_method<pairwise_summation>, const E *p, size_t n) {
+  if (n <= _pairwise_block) {
+    return _dense_sum<TermT>(summation_method<plain_summation>(), p, n);
+  }
+  const size_t h = n / 2;
+  return _dense_sum<TermT>(summation_method<pairwise_summation>(), p, h) +
+         _dense_sum<TermT>(summation_method<pairwise_summation>(), p + h,
+                           n - h);
+}
+
+template <class TermT, class E>
+E _dense_sum(summation_method<kahan_summation>, const E *p, size_t n) {
+  using pack = simd_pack<E>;
+  constexpr size_t w = pack::size;
+  // every lane keeps its own compensation
+  typename pack::type s = pack::zero(), c = pack::zero();
+  size_t i = 0;
+  for (; i + w <= n; i += w) {
+    const auto y = pack::sub(TermT::template term<pack>(pack::load(p + i)), c);
+    const auto t = pack::add(s, y);
+    c = pack::sub(pack::sub(t, s), y);
+    s = t;
+  }
+  E ls[w], lc[w];
+  pack::store(ls, s);
+  pack::store(lc, c);
+  E sum = E(0), comp = E(0);
+  auto add = [&sum, &comp](const E &x) {
+    const E y = x - comp;
+    const E t = sum + y;
+    comp = (t - sum) - y;
+    sum = t;
+  };
+  for (size_t j = 0; j < w; j++) {
+    add(ls[j]);
+    add(-lc[j]);
+  }
+  for (; i < n; i++) {
+    add(TermT::term1(p[i]));
+  }
+  return sum;
+}
+
+template <class ET, class T>
+constexpr auto _is_dense_reducible(const tensor_core<T> &t) {
+  return const_bool<decltype(_is_continuous_data(t.derived()))::value &&
+                    std::is_arithmetic<ET>::value &&
+                    !std::is_same<ET, bool>::value>();
+}
+
+template <class TermT, class ET, class T, summation_method_enum SM>
+ET _dense_reduce(yes, const tensor_core<T> &t, summation_method<SM> sm) {
+  const ET *p = t.derived().ptr();
+  return parallel_reduce_chunks(
+      (size_t)numel_of(t.derived()), types<ET>::zero(),
+      [p, sm](size_t first, size_t last) {
+        return _dense_sum<TermT>(sm, p + first, last - first);
+      },
+      [](const ET &a, const ET &b) { return a + b; });
+}
+
+// running sums of a stream of terms
+template <class E, summation_method_enum SM> struct _running_sum;
+template <class E> struct _running_sum<E, plain_summation> {
+  E sum = types<E>::zero();
+  void add(const E &x) { sum += x; }
+  E result() const { return sum; }
+};
+// blocks of _pairwise_block terms are summed plainly and merged like a
+// binary counter, so that only sums of equal length are added
+template <class E> struct _running_sum<E, pairwise_summation> {
+  E block = types<E>::zero();
+  size_t block_size = 0;
+  E levels[64];
+  size_t occupied = 0; // bit l is set if levels[l] holds a sum
+  void add(const E &x) {
+    block += x;
+    if (++block_size == _pairwise_block) {
+      E b = block;
+      size_t l = 0;
+      for (; occupied & (size_t(1) << l); l++) {
+        b = levels[l] + b;
+        occupied &= ~(size_t(1) << l);
+      }
+      levels[l] = b;
+      occupied |= size_t(1) << l;
+      block = types<E>::zero();
+      block_size = 0;
+    }
+  }
+  E result() const {
+    E r = block;
+    for (size_t l = 0; l < 64; l++) {
+      if (occupied & (size_t(1) << l)) {
+        r = levels[l] + r;
+      }
+    }
+    return r;
+  }
+};
+template <class E> struct _running_sum<E, kahan_summation> {
+  E sum = types<E>::zero(), comp = types<E>::zero();
+  void add(const E &x) {
+    const E y = x - comp;
+    const E t = sum + y;
+    comp = (t - sum) - y;
+    sum = t;
+  }
+  E result() const { return sum; }
+};
+
+template <class TermT, class ET, class T, summation_method_enum SM>
+ET _dense_reduce(no, const tensor_core<T> &t, summation_method<SM>) {
+  _running_sum<ET, SM> s;
+  for_each_element(behavior_flag<nonzero_only>(),
+                   [&s](auto &&e) { s.add(TermT::term1(e)); }, t.derived());
+  return s.result();
+}
+}
+
 // Scalar norm_squared(ts)
 template <class ET, class ShapeT, class T>
 ET norm_squared(const tensor_base<ET, ShapeT, T> &t) {
-  auto result = types<ET>::zero();
-  for_each_element(behavior_flag<nonzero_only>(),
-                   [&result](auto &&e) { result += e * e; }, t.derived());
-  return result;
+  return norm_squared(t, summation_method<plain_summation>());
+}
+template <class ET, class ShapeT, class T, summation_method_enum SM>
+ET norm_squared(const tensor_base<ET, ShapeT, T> &t,
+                const summation_method<SM> &sm) {
+  return detail::_dense_reduce<detail::_dense_square_term, ET>(
+      detail::_is_dense_reducible<ET>(t.derived()), t.derived(), sm);
 }
 
 // Scalar norm_of(ts)
@@ -761,10 +1140,13 @@ constexpr bool not_equals_result_of(const tensor_base<ET, ShapeT, T> &t) {
 // Scalar sum(s)
 template <class ET, class ShapeT, class T>
 ET sum_of(const tensor_base<ET, ShapeT, T> &t) {
-  auto s = types<ET>::zero();
-  for_each_element(behavior_flag<nonzero_only>(), [&s](auto &&e) { s += e; },
-                   t.derived());
-  return s;
+  return sum_of(t, summation_method<plain_summation>());
+}
+template <class ET, class ShapeT, class T, summation_method_enum SM>
+ET sum_of(const tensor_base<ET, ShapeT, T> &t,
+          const summation_method<SM> &sm) {
+  return detail::_dense_reduce<detail::_dense_sum_term, ET>(
+      detail::_is_dense_reducible<ET>(t.derived()), t.derived(), sm);
 }
 
 // ostream
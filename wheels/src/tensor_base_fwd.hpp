@@ -129,9 +129,29 @@ template <class T> size_t nonzero_elements_count(const tensor_core<T> &t);
 template <class T, class E, class ReduceT>
 E reduce_elements(const tensor_core<T> &t, E initial, ReduceT &&red);
 
+// Scalar parallel_reduce_elements(ts, identity, functor, combiner);
+template <class T, class E, class ReduceT, class CombineT>
+E parallel_reduce_elements(const tensor_core<T> &t, const E &identity,
+                           ReduceT &&red, CombineT &&combine);
+
+// summation_method used in sum_of and norm_squared
+// - plain_summation: several independent accumulators
+// - pairwise_summation: halves recursively down to blocks summed plainly
+// - kahan_summation: compensated summation
+enum summation_method_enum {
+  plain_summation,
+  pairwise_summation,
+  kahan_summation
+};
+template <summation_method_enum SM>
+using summation_method = const_ints<summation_method_enum, SM>;
+
 // Scalar norm_squared(ts)
 template <class ET, class ShapeT, class T>
 ET norm_squared(const tensor_base<ET, ShapeT, T> &t);
+template <class ET, class ShapeT, class T, summation_method_enum SM>
+ET norm_squared(const tensor_base<ET, ShapeT, T> &t,
+                const summation_method<SM> &);
 
 // Scalar norm_of(ts)
 template <class ET, class ShapeT, class T>
@@ -147,6 +167,8 @@ constexpr bool any_of(const tensor_base<ET, ShapeT, T> &t);
 // Scalar sum(s)
 template <class ET, class ShapeT, class T>
 ET sum_of(const tensor_base<ET, ShapeT, T> &t);
+template <class ET, class ShapeT, class T, summation_method_enum SM>
+ET sum_of(const tensor_base<ET, ShapeT, T> &t, const summation_method<SM> &);
 
 // ostream
 template <class ET, class ShapeT, class T>
@@ -1,8 +1,16 @@
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <fstream>
+
+#include "constants.hpp"
 #include "diagonal.hpp"
 #include "ewise.hpp"
 #include "iota.hpp"
+#include "mapped_file.hpp"
+#include "matrix.hpp"
+#include "permute.hpp"
+#include "reshape.hpp"
 #include "tensor_map.hpp"
 #include "tensor.hpp"
 
@@ -21,4 +29,41 @@ TEST(tensor, map) {
 
   int data[2][2] = {{1, 0}, {0, 1}};
   ASSERT_TRUE(map(data) == eye<int>(2, 2));
-}
\ No newline at end of file
+}
+TEST(tensor, map_file) {
+  const char *path = "wheels_map_file.test.bin";
+  matx_<float> data(reshape(iota<float>(6 * 8), make_shape(6, 8)));
+  {
+    std::ofstream os(path, std::ios::binary);
+    os.write("head", 4);
+    os.write(reinterpret_cast<const char *>(data.ptr()),
+             data.numel() * sizeof(float));
+  }
+
+  auto ro = map_file<const float>(path, make_shape(6, 8),
+                                  file_map_mode::read_only,
+                                  file_map_advice::sequential, false, 4);
+  ASSERT_TRUE(ro == data);
+  ASSERT_TRUE(ro.t() == data.t());
+  ASSERT_EQ(ro.sum(), data.sum());
+
+  {
+    auto cow = map_file<float>(path, make_shape(6, 8),
+                               file_map_mode::copy_on_write,
+                               file_map_advice::random, true, 4);
+    cow += 1.0f;
+    ASSERT_TRUE(cow == data + 1.0f);
+  }
+  ASSERT_TRUE(ro == data);
+
+  {
+    auto rw = map_file<float>(path, make_shape(const_size<48>()),
+                              file_map_mode::read_write,
+                              file_map_advice::willneed, false, 4);
+    rw = 0.0f;
+    rw.file().flush();
+  }
+  ASSERT_TRUE(ro == zeros<float>(6, 8));
+
+  std::remove(path);
+}
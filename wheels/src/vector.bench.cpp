@@ -0,0 +1,70 @@
+#include <benchmark/benchmark.h>
+
+#include "matrix.hpp"
+#include "tensor.hpp"
+#include "vector.hpp"
+
+using namespace wheels;
+
+static void linear_sizes(benchmark::internal::Benchmark *b) {
+  b->RangeMultiplier(8)->Range(8, 1 << 21);
+}
+
+static void row_nums(benchmark::internal::Benchmark *b) {
+  b->RangeMultiplier(8)->Range(8, 1 << 18);
+}
+
+// dot
+static void vector_dot(benchmark::State &state) {
+  const size_t n = state.range(0);
+  vecx_<float> a(make_shape(n), 1.0f), b(make_shape(n), 2.0f);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(dot(a, b));
+  }
+  state.SetBytesProcessed(state.iterations() * n * 2 * sizeof(float));
+}
+BENCHMARK(vector_dot)->Apply(linear_sizes);
+
+// distance
+static void vector_distance(benchmark::State &state) {
+  const size_t n = state.range(0);
+  vecx_<float> a(make_shape(n), 1.0f), b(make_shape(n), 2.0f);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(distance(a, b));
+  }
+  state.SetBytesProcessed(state.iterations() * n * 2 * sizeof(float));
+}
+BENCHMARK(vector_distance)->Apply(linear_sizes);
+
+// dot_rows of n x 3 points
+static void vector_dot_rows(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx_<float> a(make_shape(n, 3), 1.0f), b(make_shape(n, 3), 2.0f);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(dot_rows(a, b));
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(vector_dot_rows)->Apply(row_nums);
+
+// distance_rows of n x 3 points
+static void vector_distance_rows(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx_<float> a(make_shape(n, 3), 1.0f), b(make_shape(n, 3), 2.0f);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(distance_rows(a, b));
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(vector_distance_rows)->Apply(row_nums);
+
+// cross_rows of n x 3 points
+static void vector_cross_rows(benchmark::State &state) {
+  const size_t n = state.range(0);
+  matx_<float> a(make_shape(n, 3), 1.0f), b(make_shape(n, 3), 2.0f);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cross_rows(a, b));
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(vector_cross_rows)->Apply(row_nums);
@@ -32,12 +32,126 @@
 
 namespace wheels {
 
+// dense dot and distance
+// - continuous operands sharing an arithmetic element type (floating point
+//   for distance) are folded straight from ptr() with several simd
+//   accumulators and fma, long ones are split deterministically across the
+//   thread pool
+// - other operands go through for_each_element
+namespace detail {
+// terms of dot
+struct _dense_dot_term {
+  template <class PackT>
+  static typename PackT::type fold(const typename PackT::type &acc,
+                                   const typename PackT::type &x,
+                                   const typename PackT::type &y) {
+    return PackT::fma(x, y, acc);
+  }
+  template <class E> static E term1(const E &x, const E &y) { return x * y; }
+};
+// terms of squared distance
+struct _dense_squared_distance_term {
+  template <class PackT>
+  static typename PackT::type fold(const typename PackT::type &acc,
+                                   const typename PackT::type &x,
+                                   const typename PackT::type &y) {
+    const auto d = PackT::sub(x, y);
+    return PackT::fma(d, d, acc);
+  }
+  template <class E> static E term1(const E &x, const E &y) {
+    const E d = x - y;
+    return d * d;
+  }
+};
+
+template <class TermT, class E>
+E _dense_pair_sum(const E *a, const E *b, size_t n) {
+  using pack = simd_pack<E>;
+  constexpr size_t w = pack::size;
+  typename pack::type acc[4] = {pack::zero(), pack::zero(), pack::zero(),
+                                pack::zero()};
+  size_t i = 0;
+  for (; i + 4 * w <= n; i += 4 * w) {
+    for (size_t j = 0; j < 4; j++) {
+      acc[j] = TermT::template fold<pack>(acc[j], pack::load(a + i + j * w),
+                                          pack::load(b + i + j * w));
+    }
+  }
+  for (; i + w <= n; i += w) {
+    acc[0] = TermT::template fold<pack>(acc[0], pack::load(a + i),
+                                        pack::load(b + i));
+  }
+  E s = pack::sum(pack::add(pack::add(acc[0], acc[1]),
+                            pack::add(acc[2], acc[3])));
+  for (; i < n; i++) {
+    s += TermT::term1(a[i], b[i]);
+  }
+  return s;
+}
+
+static constexpr size_t _dense_pair_grain = 1 << 10;
+template <class TermT, class E>
+E _dense_pair_reduce(const E *a, const E *b, size_t n) {
+  if (n <= _dense_pair_grain) {
+    return _dense_pair_sum<TermT>(a, b, n);
+  }
+  return parallel_reduce_chunks(
+      n, types<E>::zero(),
+      [a, b](size_t first, size_t last) {
+        return _dense_pair_sum<TermT>(a + first, b + first, last - first);
+      },
+      [](const E &x, const E &y) { return x + y; }, _dense_pair_grain);
+}
+
+template <class ET1, class ET2, class T1, class T2>
+constexpr auto _is_dense_pair(const tensor_core<T1> &t1,
+                              const tensor_core<T2> &t2) {
+  return const_bool<decltype(_is_continuous_data(t1.derived()))::value &&
+                    decltype(_is_continuous_data(t2.derived()))::value &&
+                    std::is_same<ET1, ET2>::value &&
+                    std::is_arithmetic<ET1>::value &&
+                    !std::is_same<ET1, bool>::value>();
+}
+
+template <class T1, class T2>
+auto _dot(yes, const tensor_core<T1> &t1, const tensor_core<T2> &t2) {
+  return _dense_pair_reduce<_dense_dot_term>(
+      t1.derived().ptr(), t2.derived().ptr(), (size_t)numel_of(t1.derived()));
+}
+template <class T1, class T2>
+auto _dot(no, const tensor_core<T1> &t1, const tensor_core<T2> &t2) {
+  using result_t = std::common_type_t<typename T1::value_type,
+                                      typename T2::value_type>;
+  result_t result = 0.0;
+  for_each_element(behavior_flag<unordered>(),
+                   [&result](auto &&e1, auto &&e2) { result += e1 * e2; },
+                   t1.derived(), t2.derived());
+  return result;
+}
+
+template <class T1, class T2>
+auto _distance(yes, const tensor_core<T1> &t1, const tensor_core<T2> &t2) {
+  return std::sqrt(_dense_pair_reduce<_dense_squared_distance_term>(
+      t1.derived().ptr(), t2.derived().ptr(), (size_t)numel_of(t1.derived())));
+}
+template <class T1, class T2>
+constexpr auto _distance(no, const tensor_core<T1> &t1,
+                         const tensor_core<T2> &t2) {
+  return norm_of(t1.derived() - t2.derived());
+}
+}
+
 // distance
 template <class ET1, class ShapeT1, class T1, class ET2, class ShapeT2,
           class T2>
 constexpr auto distance(const tensor_base<ET1, ShapeT1, T1> &t1,
                         const tensor_base<ET2, ShapeT2, T2> &t2) {
-  return norm_of(t1.derived() - t2.derived());
+  assert(shape_of(t1.derived()) == shape_of(t2.derived()));
+  return detail::_distance(
+      const_bool<decltype(detail::_is_dense_pair<ET1, ET2>(
+                     t1.derived(), t2.derived()))::value &&
+                 std::is_floating_point<ET1>::value>(),
+      t1.derived(), t2.derived());
 }
 
 // dot(ts1, ts2);
@@ -45,13 +159,10 @@ template <class ET1, class ShapeT1, class T1, class ET2, class ShapeT2,
           class T2>
 auto dot(const tensor_base<ET1, ShapeT1, T1> &t1,
          const tensor_base<ET2, ShapeT2, T2> &t2) {
-  using result_t = std::common_type_t<ET1, ET2>;
   assert(shape_of(t1.derived()) == shape_of(t2.derived()));
-  result_t result = 0.0;
-  for_each_element(behavior_flag<unordered>(),
-                   [&result](auto &&e1, auto &&e2) { result += e1 * e2; },
-                   t1.derived(), t2.derived());
-  return result;
+  return detail::_dot(
+      detail::_is_dense_pair<ET1, ET2>(t1.derived(), t2.derived()),
+      t1.derived(), t2.derived());
 }
 
 // auto cross(ts1, ts2);
@@ -65,6 +176,290 @@ constexpr auto cross(const tensor_base<E1, tensor_shape<ST1, NT1>, T1> &a,
                            a.x() * b.y() - a.y() * b.x());
 }
 
+// batched dot_rows, distance_rows and cross_rows
+// - a and b are [n, d] matrices holding one vector per row
+// - continuous operands are processed in blocks of _soa_rows rows, a block
+//   is transposed on the stack so that each simd lane carries one row (SoA),
+//   the block is large enough for the transposed stores to retire before
+//   they are loaded back as packs
+// - rows longer than _soa_max_cols use the dense kernels above
+// - the rows are split across the thread pool
+namespace detail {
+static constexpr size_t _soa_rows = 64;
+static constexpr size_t _soa_max_cols = 8;
+
+// D != 0 fixes the row length at compile time
+template <size_t D, class TermT, class E>
+void _pair_sum_rows(E *out, const E *a, const E *b, size_t first,
+                    size_t last, size_t d) {
+  using pack = simd_pack<E>;
+  constexpr size_t w = pack::size;
+  static_assert(_soa_rows % w == 0, "_soa_rows must be a multiple of w");
+  if (D != 0) {
+    d = D;
+  }
+  size_t i = first;
+  if (w > 1 && d <= _soa_max_cols) {
+    E ta[_soa_max_cols * _soa_rows], tb[_soa_max_cols * _soa_rows];
+    while (true) {
+      const size_t m = std::min(_soa_rows, last - i) / w * w;
+      if (m == 0) {
+        break;
+      }
+      for (size_t l = 0; l < m; l++) {
+        for (size_t k = 0; k < d; k++) {
+          ta[k * _soa_rows + l] = a[(i + l) * d + k];
+          tb[k * _soa_rows + l] = b[(i + l) * d + k];
+        }
+      }
+      for (size_t l = 0; l < m; l += w) {
+        auto acc = pack::zero();
+        for (size_t k = 0; k < d; k++) {
+          acc = TermT::template fold<pack>(
+              acc, pack::load(ta + k * _soa_rows + l),
+              pack::load(tb + k * _soa_rows + l));
+        }
+        pack::store(out + i + l, acc);
+      }
+      i += m;
+    }
+  }
+  for (; i < last; i++) {
+    out[i] = _dense_pair_sum<TermT>(a + i * d, b + i * d, d);
+  }
+}
+template <class TermT, class E>
+void _pair_sum_rows(E *out, const E *a, const E *b, size_t first,
+                    size_t last, size_t d) {
+  switch (d) {
+  case 2:
+    return _pair_sum_rows<2, TermT>(out, a, b, first, last, d);
+  case 3:
+    return _pair_sum_rows<3, TermT>(out, a, b, first, last, d);
+  case 4:
+    return _pair_sum_rows<4, TermT>(out, a, b, first, last, d);
+  default:
+    return _pair_sum_rows<0, TermT>(out, a, b, first, last, d);
+  }
+}
+
+template <class E>
+void _cross_rows(E *out, const E *a, const E *b, size_t first, size_t last) {
+  using pack = simd_pack<E>;
+  constexpr size_t w = pack::size;
+  constexpr size_t r = _soa_rows;
+  size_t i = first;
+  if (w > 1) {
+    E t[6 * r];
+    while (true) {
+      const size_t m = std::min(r, last - i) / w * w;
+      if (m == 0) {
+        break;
+      }
+      for (size_t l = 0; l < m; l++) {
+        for (size_t k = 0; k < 3; k++) {
+          t[k * r + l] = a[(i + l) * 3 + k];
+          t[(k + 3) * r + l] = b[(i + l) * 3 + k];
+        }
+      }
+      for (size_t l = 0; l < m; l += w) {
+        const auto ax = pack::load(t + l), ay = pack::load(t + r + l),
+                   az = pack::load(t + 2 * r + l),
+                   bx = pack::load(t + 3 * r + l),
+                   by = pack::load(t + 4 * r + l),
+                   bz = pack::load(t + 5 * r + l);
+        pack::store(t + l, pack::sub(pack::mul(ay, bz), pack::mul(az, by)));
+        pack::store(t + r + l,
+                    pack::sub(pack::mul(az, bx), pack::mul(ax, bz)));
+        pack::store(t + 2 * r + l,
+                    pack::sub(pack::mul(ax, by), pack::mul(ay, bx)));
+      }
+      for (size_t l = 0; l < m; l++) {
+        for (size_t k = 0; k < 3; k++) {
+          out[(i + l) * 3 + k] = t[k * r + l];
+        }
+      }
+      i += m;
+    }
+  }
+  for (; i < last; i++) {
+    const E *x = a + i * 3, *y = b + i * 3;
+    E *z = out + i * 3;
+    z[0] = x[1] * y[2] - x[2] * y[1];
+    z[1] = x[2] * y[0] - x[0] * y[2];
+    z[2] = x[0] * y[1] - x[1] * y[0];
+  }
+}
+
+// calls fun(first, last) on chunks of [0, n) rows of d elements each
+template <class E, class FunT>
+void _for_each_row_chunk(size_t n, size_t d, FunT fun) {
+  if (n == 0) {
+    return;
+  }
+  auto &pool = default_thread_pool();
+  const bool parallel = n > 1 && n * d >= parallel_threshold();
+  if (!parallel) {
+    fun((size_t)0, n);
+    return;
+  }
+  constexpr size_t w = simd_pack<E>::size;
+  const size_t chunk_num = (pool.worker_num() + 1) * 4;
+  const size_t chunk_size = ((n + chunk_num - 1) / chunk_num + w - 1) / w * w;
+  pool.run((n + chunk_size - 1) / chunk_size,
+           [n, chunk_size, &fun](size_t c) {
+             fun(c * chunk_size, std::min(n, (c + 1) * chunk_size));
+           });
+}
+
+template <class T>
+constexpr auto _rows_of(const tensor_core<T> &t) {
+  return make_shape(t.derived().shape().at(const_index<0>()));
+}
+
+template <class T1, class T2>
+auto _dot_rows(yes, const tensor_core<T1> &a, const tensor_core<T2> &b) {
+  using E = typename T1::value_type;
+  const size_t n = a.derived().size(const_index<0>());
+  const size_t d = a.derived().size(const_index<1>());
+  tensor<E, decltype(_rows_of(a))> out(_rows_of(a), with_uninitialized);
+  E *o = out.ptr();
+  const E *pa = a.derived().ptr(), *pb = b.derived().ptr();
+  _for_each_row_chunk<E>(n, d, [o, pa, pb, d](size_t first, size_t last) {
+    _pair_sum_rows<_dense_dot_term>(o, pa, pb, first, last, d);
+  });
+  return out;
+}
+template <class T1, class T2>
+auto _dot_rows(no, const tensor_core<T1> &a, const tensor_core<T2> &b) {
+  using result_t = std::common_type_t<typename T1::value_type,
+                                      typename T2::value_type>;
+  const size_t n = a.derived().size(const_index<0>());
+  const size_t d = a.derived().size(const_index<1>());
+  tensor<result_t, decltype(_rows_of(a))> out(_rows_of(a));
+  for (size_t i = 0; i < n; i++) {
+    result_t s = 0;
+    for (size_t k = 0; k < d; k++) {
+      s += element_at(a.derived(), i, k) * element_at(b.derived(), i, k);
+    }
+    out[i] = s;
+  }
+  return out;
+}
+
+template <class T1, class T2>
+auto _distance_rows(yes, const tensor_core<T1> &a, const tensor_core<T2> &b) {
+  using E = typename T1::value_type;
+  const size_t n = a.derived().size(const_index<0>());
+  const size_t d = a.derived().size(const_index<1>());
+  tensor<E, decltype(_rows_of(a))> out(_rows_of(a), with_uninitialized);
+  E *o = out.ptr();
+  const E *pa = a.derived().ptr(), *pb = b.derived().ptr();
+  _for_each_row_chunk<E>(n, d, [o, pa, pb, d](size_t first, size_t last) {
+    _pair_sum_rows<_dense_squared_distance_term>(o, pa, pb, first, last, d);
+    using pack = simd_pack<E>;
+    size_t i = first;
+    for (; i + pack::size <= last; i += pack::size) {
+      pack::store(o + i, pack::sqrt(pack::load(o + i)));
+    }
+    for (; i < last; i++) {
+      o[i] = std::sqrt(o[i]);
+    }
+  });
+  return out;
+}
+template <class T1, class T2>
+auto _distance_rows(no, const tensor_core<T1> &a, const tensor_core<T2> &b) {
+  using result_t = decltype(std::sqrt(std::declval<std::common_type_t<
+                                          typename T1::value_type,
+                                          typename T2::value_type>>()));
+  const size_t n = a.derived().size(const_index<0>());
+  const size_t d = a.derived().size(const_index<1>());
+  tensor<result_t, decltype(_rows_of(a))> out(_rows_of(a));
+  for (size_t i = 0; i < n; i++) {
+    result_t s = 0;
+    for (size_t k = 0; k < d; k++) {
+      const result_t e = element_at(a.derived(), i, k) -
+                         element_at(b.derived(), i, k);
+      s += e * e;
+    }
+    out[i] = std::sqrt(s);
+  }
+  return out;
+}
+
+template <class T1, class T2>
+auto _cross_rows(yes, const tensor_core<T1> &a, const tensor_core<T2> &b) {
+  using E = typename T1::value_type;
+  const size_t n = a.derived().size(const_index<0>());
+  tensor<E, typename T1::shape_type> out(a.derived().shape(),
+                                         with_uninitialized);
+  E *o = out.ptr();
+  const E *pa = a.derived().ptr(), *pb = b.derived().ptr();
+  _for_each_row_chunk<E>(n, 3, [o, pa, pb](size_t first, size_t last) {
+    _cross_rows(o, pa, pb, first, last);
+  });
+  return out;
+}
+template <class T1, class T2>
+auto _cross_rows(no, const tensor_core<T1> &a, const tensor_core<T2> &b) {
+  using result_t = std::common_type_t<typename T1::value_type,
+                                      typename T2::value_type>;
+  const size_t n = a.derived().size(const_index<0>());
+  tensor<result_t, typename T1::shape_type> out(a.derived().shape());
+  for (size_t i = 0; i < n; i++) {
+    for (size_t k = 0; k < 3; k++) {
+      const size_t k1 = (k + 1) % 3, k2 = (k + 2) % 3;
+      element_at(out, i, k) =
+          element_at(a.derived(), i, k1) * element_at(b.derived(), i, k2) -
+          element_at(a.derived(), i, k2) * element_at(b.derived(), i, k1);
+    }
+  }
+  return out;
+}
+}
+
+// dot_rows(a, b)
+template <class ET1, class ShapeT1, class T1, class ET2, class ShapeT2,
+          class T2>
+auto dot_rows(const tensor_base<ET1, ShapeT1, T1> &a,
+              const tensor_base<ET2, ShapeT2, T2> &b) {
+  static_assert(ShapeT1::rank == 2 && ShapeT2::rank == 2,
+                "dot_rows requires matrices");
+  assert(a.shape() == b.shape());
+  return detail::_dot_rows(
+      detail::_is_dense_pair<ET1, ET2>(a.derived(), b.derived()), a.derived(),
+      b.derived());
+}
+
+// distance_rows(a, b)
+template <class ET1, class ShapeT1, class T1, class ET2, class ShapeT2,
+          class T2>
+auto distance_rows(const tensor_base<ET1, ShapeT1, T1> &a,
+                   const tensor_base<ET2, ShapeT2, T2> &b) {
+  static_assert(ShapeT1::rank == 2 && ShapeT2::rank == 2,
+                "distance_rows requires matrices");
+  assert(a.shape() == b.shape());
+  return detail::_distance_rows(
+      const_bool<decltype(detail::_is_dense_pair<ET1, ET2>(
+                     a.derived(), b.derived()))::value &&
+                 std::is_floating_point<ET1>::value>(),
+      a.derived(), b.derived());
+}
+
+// cross_rows(a, b)
+template <class ET1, class ShapeT1, class T1, class ET2, class ShapeT2,
+          class T2>
+auto cross_rows(const tensor_base<ET1, ShapeT1, T1> &a,
+                const tensor_base<ET2, ShapeT2, T2> &b) {
+  static_assert(ShapeT1::rank == 2 && ShapeT2::rank == 2,
+                "cross_rows requires matrices");
+  assert(a.shape() == b.shape() && a.size(const_index<1>()) == 3);
+  return detail::_cross_rows(
+      detail::_is_dense_pair<ET1, ET2>(a.derived(), b.derived()), a.derived(),
+      b.derived());
+}
+
 // 1 dimensional tensor (vector)
 template <class ET, class ST, class NT, class T>
 class tensor_base<ET, tensor_shape<ST, NT>, T> : public tensor_core<T> {
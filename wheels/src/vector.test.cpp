@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include "matrix.hpp"
+#include "tensor.hpp"
+#include "vector.hpp"
+
+using namespace wheels;
+
+TEST(vector, dot_distance) {
+  std::default_random_engine rng;
+  for (size_t n : {0, 1, 3, 7, 16, 33, 100, 5000}) {
+    vecx_<double> a(rand(make_shape(n), rng)), b(rand(make_shape(n), rng));
+    double d = 0, d2 = 0;
+    for (size_t i = 0; i < n; i++) {
+      d += a[i] * b[i];
+      d2 += (a[i] - b[i]) * (a[i] - b[i]);
+    }
+    ASSERT_NEAR(dot(a, b), d, 1e-9);
+    ASSERT_NEAR(a.dot(b), d, 1e-9);
+    ASSERT_NEAR(distance(a, b), std::sqrt(d2), 1e-9);
+    // non continuous operands
+    ASSERT_NEAR(dot(a * 2.0, b), 2 * d, 1e-9);
+    ASSERT_NEAR(distance(a * 1.0, b), std::sqrt(d2), 1e-9);
+  }
+
+  vecx_<int> ia(make_shape(10), 2), ib(make_shape(10), 3);
+  ASSERT_EQ(dot(ia, ib), 60);
+  ASSERT_EQ(distance(vec3(1, 2, 3), vec3(1, 2, 5)), 2.0);
+}
+
+TEST(vector, rows) {
+  std::default_random_engine rng;
+  for (size_t n : {0, 1, 5, 8, 17, 1000}) {
+    for (size_t d : {1, 3, 4, 16, 40}) {
+      matx_<float> a(rand(make_shape(n, d), rng)),
+          b(rand(make_shape(n, d), rng));
+      auto dots = dot_rows(a, b);
+      auto dists = distance_rows(a, b);
+      auto dots2 = dot_rows(a * 1.0f, b);
+      ASSERT_EQ(dots.numel(), n);
+      ASSERT_EQ(dists.numel(), n);
+      for (size_t i = 0; i < n; i++) {
+        float s = 0, s2 = 0;
+        for (size_t k = 0; k < d; k++) {
+          s += a(i, k) * b(i, k);
+          s2 += (a(i, k) - b(i, k)) * (a(i, k) - b(i, k));
+        }
+        ASSERT_NEAR(dots[i], s, 1e-4);
+        ASSERT_NEAR(dots2[i], s, 1e-4);
+        ASSERT_NEAR(dists[i], std::sqrt(s2), 1e-4);
+      }
+    }
+
+    matx_<float> a(rand(make_shape(n, 3), rng)), b(rand(make_shape(n, 3), rng));
+    auto c = cross_rows(a, b);
+    auto c2 = cross_rows(a * 1.0f, b);
+    ASSERT_TRUE(c.shape() == a.shape());
+    for (size_t i = 0; i < n; i++) {
+      vec_<float, 3> x(a(i, 0), a(i, 1), a(i, 2)), y(b(i, 0), b(i, 1), b(i, 2));
+      auto z = cross(x, y);
+      for (size_t k = 0; k < 3; k++) {
+        ASSERT_NEAR(c(i, k), z[k], 1e-6);
+        ASSERT_NEAR(c2(i, k), z[k], 1e-6);
+      }
+    }
+  }
+}
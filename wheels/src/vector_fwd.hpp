@@ -42,4 +42,19 @@ template <class E1, class ST1, class NT1, class T1, class E2, class ST2,
           class NT2, class T2>
 constexpr auto cross(const tensor_base<E1, tensor_shape<ST1, NT1>, T1> &a,
                      const tensor_base<E2, tensor_shape<ST2, NT2>, T2> &b);
+
+template <class ET1, class ShapeT1, class T1, class ET2, class ShapeT2,
+          class T2>
+auto dot_rows(const tensor_base<ET1, ShapeT1, T1> &a,
+              const tensor_base<ET2, ShapeT2, T2> &b);
+
+template <class ET1, class ShapeT1, class T1, class ET2, class ShapeT2,
+          class T2>
+auto distance_rows(const tensor_base<ET1, ShapeT1, T1> &a,
+                   const tensor_base<ET2, ShapeT2, T2> &b);
+
+template <class ET1, class ShapeT1, class T1, class ET2, class ShapeT2,
+          class T2>
+auto cross_rows(const tensor_base<ET1, ShapeT1, T1> &a,
+                const tensor_base<ET2, ShapeT2, T2> &b);
 }
\ No newline at end of file
@@ -0,0 +1,422 @@
+/* * *
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Hao Yang (yangh2007@gmail.com)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * */
+
+#pragma once
+
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "tensor.hpp"
+#include "types.hpp"
+
+#include "wht_fwd.hpp"
+
+namespace wheels {
+
+// wht_element_kind
+enum class wht_element_kind : uint8_t {
+  boolean = 1,
+  signed_int = 2,
+  unsigned_int = 3,
+  floating = 4,
+  complex = 5
+};
+
+// wht_byte_order
+enum class wht_byte_order : uint8_t { little = 1, big = 2 };
+
+namespace detail {
+template <class T>
+constexpr wht_element_kind _wht_element_kind(const types<T> &) {
+  static_assert(std::is_arithmetic<T>::value,
+                "only arithmetic and complex elements can be stored in wht");
+  return std::is_same<T, bool>::value
+             ? wht_element_kind::boolean
+             : std::is_floating_point<T>::value
+                   ? wht_element_kind::floating
+                   : std::is_signed<T>::value ? wht_element_kind::signed_int
+                                              : wht_element_kind::unsigned_int;
+}
+template <class T>
+constexpr wht_element_kind _wht_element_kind(const types<std::complex<T>> &) {
+  return wht_element_kind::complex;
+}
+
+inline wht_byte_order _wht_native_byte_order() {
+  const uint16_t one = 1;
+  unsigned char first;
+  std::memcpy(&first, &one, 1);
+  return first ? wht_byte_order::little : wht_byte_order::big;
+}
+
+// reverses the bytes of each width-byte word in [p, p + bytes)
+inline void _wht_swap_bytes(void *p, size_t bytes, size_t width) {
+  if (width <= 1) {
+    return;
+  }
+  auto *b = static_cast<unsigned char *>(p);
+  for (size_t i = 0; i + width <= bytes; i += width) {
+    std::reverse(b + i, b + i + width);
+  }
+}
+
+template <class T>
+inline void _wht_put(char *buf, size_t off, const T &v) {
+  std::memcpy(buf + off, &v, sizeof(T));
+}
+template <class T>
+inline T _wht_get(const char *buf, size_t off, bool swap) {
+  T v;
+  std::memcpy(&v, buf + off, sizeof(T));
+  if (swap) {
+    _wht_swap_bytes(&v, sizeof(T), sizeof(T));
+  }
+  return v;
+}
+
+template <class ShapeT, size_t... Is>
+std::vector<uint64_t> _wht_sizes(const ShapeT &shape,
+                                 const const_ints<size_t, Is...> &) {
+  return {static_cast<uint64_t>(shape.at(const_index<Is>()))...};
+}
+
+template <class SizeT> constexpr bool _wht_size_fits(const SizeT &, uint64_t) {
+  return true;
+}
+template <class K, K S>
+constexpr bool _wht_size_fits(const const_ints<K, S> &, uint64_t s) {
+  return s == static_cast<uint64_t>(S);
+}
+
+// builds a ShapeT from the sizes read from a file, static sizes must agree
+template <class ShapeT, size_t... Is>
+ShapeT _wht_make_shape(const std::vector<uint64_t> &sizes,
+                       const const_ints<size_t, Is...> &,
+                       const std::string &path) {
+  ShapeT shape;
+  const bool fits[] = {
+      true, _wht_size_fits(shape.at(const_index<Is>()), sizes[Is])...};
+  if (std::find(std::begin(fits), std::end(fits), false) != std::end(fits)) {
+    wheels_throw(std::runtime_error(path + " holds a tensor of another shape"));
+  }
+  (void)std::initializer_list<int>{
+      (shape.resize(const_index<Is>(),
+                    static_cast<typename ShapeT::value_type>(sizes[Is])),
+       0)...};
+  return shape;
+}
+}
+
+// wht_header
+// - the .wht file starts with a 32-byte fixed part, then one uint64 per axis,
+//   all in the file's byte order:
+//     [0] magic "WHT\0"    [4] version u16      [6] byte order u8
+//     [7] element kind u8  [8] element size u16 [10] rank u16
+//     [12] alignment u32   [16] payload offset u64
+//     [24] payload bytes u64                    [32] sizes u64 x rank
+// - the payload holds the elements in row-major order, it starts at a
+//   multiple of alignment so that the file can be mapped and used in place
+struct wht_header {
+  static constexpr uint16_t current_version = 1;
+  static constexpr size_t fixed_size = 32;
+
+  uint16_t version;
+  wht_byte_order byte_order;
+  wht_element_kind element_kind;
+  uint16_t element_size;
+  uint32_t alignment;
+  uint64_t payload_offset;
+  uint64_t payload_bytes;
+  std::vector<uint64_t> shape;
+
+  size_t rank() const { return shape.size(); }
+  uint64_t numel() const {
+    uint64_t n = 1;
+    for (auto s : shape) {
+      n *= s;
+    }
+    return n;
+  }
+  template <class ET> bool holds() const {
+    return element_kind == detail::_wht_element_kind(types<ET>()) &&
+           element_size == sizeof(ET);
+  }
+
+  // make
+  template <class ET>
+  static wht_header make(std::vector<uint64_t> shape, uint32_t alignment = 64) {
+    wht_header h;
+    h.version = current_version;
+    h.byte_order = detail::_wht_native_byte_order();
+    h.element_kind = detail::_wht_element_kind(types<ET>());
+    h.element_size = sizeof(ET);
+    h.alignment = alignment;
+    const uint64_t head = fixed_size + 8 * shape.size();
+    h.payload_offset = (head + alignment - 1) / alignment * alignment;
+    h.shape = std::move(shape);
+    h.payload_bytes = h.numel() * sizeof(ET);
+    return h;
+  }
+
+  // write_to
+  // - writes the header and pads it up to payload_offset
+  void write_to(std::ostream &os) const {
+    assert(byte_order == detail::_wht_native_byte_order());
+    std::vector<char> buf(payload_offset, 0);
+    std::memcpy(buf.data(), "WHT", 4);
+    detail::_wht_put(buf.data(), 4, version);
+    detail::_wht_put(buf.data(), 6, byte_order);
+    detail::_wht_put(buf.data(), 7, element_kind);
+    detail::_wht_put(buf.data(), 8, element_size);
+    detail::_wht_put(buf.data(), 10, static_cast<uint16_t>(rank()));
+    detail::_wht_put(buf.data(), 12, alignment);
+    detail::_wht_put(buf.data(), 16, payload_offset);
+    detail::_wht_put(buf.data(), 24, payload_bytes);
+    for (size_t i = 0; i < rank(); i++) {
+      detail::_wht_put(buf.data(), fixed_size + 8 * i, shape[i]);
+    }
+    os.write(buf.data(), buf.size());
+  }
+
+  // read_from
+  // - reads and checks the header, leaves is at the payload
+  static wht_header read_from(std::istream &is, const std::string &path) {
+    char buf[fixed_size];
+    if (!is.read(buf, fixed_size) || std::memcmp(buf, "WHT", 4) != 0) {
+      wheels_throw(std::runtime_error(path + " is not a wht file"));
+    }
+    wht_header h;
+    h.byte_order = static_cast<wht_byte_order>(buf[6]);
+    if (h.byte_order != wht_byte_order::little &&
+        h.byte_order != wht_byte_order::big) {
+      wheels_throw(std::runtime_error(path + " has a bad byte order"));
+    }
+    const bool swap = h.byte_order != detail::_wht_native_byte_order();
+    h.version = detail::_wht_get<uint16_t>(buf, 4, swap);
+    if (h.version > current_version) {
+      wheels_throw(std::runtime_error(path + " has an unsupported version"));
+    }
+    h.element_kind = static_cast<wht_element_kind>(buf[7]);
+    h.element_size = detail::_wht_get<uint16_t>(buf, 8, swap);
+    const auto rank = detail::_wht_get<uint16_t>(buf, 10, swap);
+    h.alignment = detail::_wht_get<uint32_t>(buf, 12, swap);
+    h.payload_offset = detail::_wht_get<uint64_t>(buf, 16, swap);
+    h.payload_bytes = detail::_wht_get<uint64_t>(buf, 24, swap);
+    std::vector<char> sizes(8 * size_t(rank));
+    if (!sizes.empty() && !is.read(sizes.data(), sizes.size())) {
+      wheels_throw(std::runtime_error(path + " is truncated"));
+    }
+    h.shape.resize(rank);
+    for (size_t i = 0; i < rank; i++) {
+      h.shape[i] = detail::_wht_get<uint64_t>(sizes.data(), 8 * i, swap);
+    }
+    if (h.payload_offset < fixed_size + sizes.size() ||
+        h.payload_bytes != h.numel() * h.element_size) {
+      wheels_throw(std::runtime_error(path + " has an inconsistent header"));
+    }
+    is.seekg(std::streamoff(h.payload_offset));
+    return h;
+  }
+};
+
+// wht_writer
+// - writes a tensor of a known shape chunk by chunk, so that tensors larger
+//   than memory can be produced piecewise
+template <class ET> class wht_writer {
+  static_assert(std::is_trivially_copyable<ET>::value,
+                "only trivially copyable elements can be written");
+
+public:
+  template <class ST, class... SizeTs>
+  wht_writer(const std::string &path, const tensor_shape<ST, SizeTs...> &shape)
+      : _path(path), _os(path, std::ios::binary | std::ios::trunc),
+        _header(wht_header::make<ET>(detail::_wht_sizes(
+            shape, make_const_sequence(const_size<sizeof...(SizeTs)>())))),
+        _written(0) {
+    if (!_os) {
+      wheels_throw(std::runtime_error("cannot open " + path));
+    }
+    _header.write_to(_os);
+  }
+
+  wht_writer(wht_writer &&) = default;
+  wht_writer &operator=(wht_writer &&) = default;
+
+  const wht_header &header() const { return _header; }
+  uint64_t written() const { return _written; }
+  uint64_t remaining() const { return _header.numel() - _written; }
+
+  // write
+  // - appends the next n elements
+  void write(const ET *data, size_t n) {
+    assert(n <= remaining());
+    if (n != 0 &&
+        !_os.write(reinterpret_cast<const char *>(data), n * sizeof(ET))) {
+      wheels_throw(std::runtime_error("cannot write " + _path));
+    }
+    _written += n;
+  }
+
+  // close
+  // - every element must have been written
+  void close() {
+    if (!_os.is_open()) {
+      return;
+    }
+    const bool complete = remaining() == 0;
+    _os.close();
+    if (!complete || _os.fail()) {
+      wheels_throw(std::runtime_error("incomplete " + _path));
+    }
+  }
+
+private:
+  std::string _path;
+  std::ofstream _os;
+  wht_header _header;
+  uint64_t _written;
+};
+
+// wht_reader
+// - reads the elements of a wht file chunk by chunk, converting them to the
+//   native byte order
+template <class ET> class wht_reader {
+  static_assert(std::is_trivially_copyable<ET>::value,
+                "only trivially copyable elements can be read");
+
+public:
+  explicit wht_reader(const std::string &path)
+      : _path(path), _is(path, std::ios::binary), _read(0) {
+    if (!_is) {
+      wheels_throw(std::runtime_error("cannot open " + path));
+    }
+    _header = wht_header::read_from(_is, path);
+    if (!_header.holds<ET>()) {
+      wheels_throw(std::runtime_error(path + " holds another element type"));
+    }
+  }
+
+  wht_reader(wht_reader &&) = default;
+  wht_reader &operator=(wht_reader &&) = default;
+
+  const wht_header &header() const { return _header; }
+  uint64_t remaining() const { return _header.numel() - _read; }
+
+  // read
+  // - reads up to n of the next elements, returns how many were read
+  size_t read(ET *data, size_t n) {
+    n = size_t(std::min<uint64_t>(n, remaining()));
+    if (n != 0 && !_is.read(reinterpret_cast<char *>(data), n * sizeof(ET))) {
+      wheels_throw(std::runtime_error(_path + " is truncated"));
+    }
+    if (_header.byte_order != detail::_wht_native_byte_order()) {
+      detail::_wht_swap_bytes(data, n * sizeof(ET),
+                              _header.element_kind == wht_element_kind::complex
+                                  ? sizeof(ET) / 2
+                                  : sizeof(ET));
+    }
+    _read += n;
+    return n;
+  }
+
+private:
+  std::string _path;
+  std::ifstream _is;
+  wht_header _header;
+  uint64_t _read;
+};
+
+// save
+// - continuous tensors are written straight from ptr(), others are evaluated
+//   in chunks
+namespace detail {
+constexpr size_t _wht_chunk_size = size_t(1) << 16;
+template <class ET, class T>
+void _save_elements(yes, wht_writer<ET> &w, const T &t) {
+  w.write(t.ptr(), numel_of(t));
+}
+template <class ET, class T>
+void _save_elements(no, wht_writer<ET> &w, const T &t) {
+  const size_t n = numel_of(t);
+  std::unique_ptr<ET[]> buf(new ET[std::min(n, _wht_chunk_size)]);
+  for (size_t begin = 0; begin < n; begin += _wht_chunk_size) {
+    const size_t end = std::min(n, begin + _wht_chunk_size);
+    for (size_t i = begin; i < end; i++) {
+      buf[i - begin] = element_at_index(t, i);
+    }
+    w.write(buf.get(), end - begin);
+  }
+}
+}
+template <class ET, class ShapeT, class T>
+void save(const std::string &path, const tensor_base<ET, ShapeT, T> &t) {
+  wht_writer<ET> w(path, t.shape());
+  detail::_save_elements(decltype(detail::_is_continuous_data(t.derived()))(),
+                         w, t.derived());
+  w.close();
+}
+
+// load
+// - reads the payload straight into ptr()
+template <class ET, class ShapeT>
+void load(const std::string &path, tensor<ET, ShapeT> &t) {
+  wht_reader<ET> r(path);
+  reserve_shape(t, detail::_wht_make_shape<ShapeT>(
+                       r.header().shape,
+                       make_const_sequence(const_size<ShapeT::rank>()), path));
+  r.read(t.ptr(), numel_of(t));
+}
+
+// map_wht
+// - maps the payload in place, the file must be in the native byte order
+template <class ET, size_t Rank>
+auto map_wht(const std::string &path, file_map_mode mode,
+             file_map_advice advice, bool huge_pages) {
+  using shape_t = decltype(repeat_shape(size_t(), const_size<Rank>()));
+  std::ifstream is(path, std::ios::binary);
+  if (!is) {
+    wheels_throw(std::runtime_error("cannot open " + path));
+  }
+  const auto h = wht_header::read_from(is, path);
+  is.close();
+  if (!h.holds<std::decay_t<ET>>()) {
+    wheels_throw(std::runtime_error(path + " holds another element type"));
+  }
+  if (h.byte_order != detail::_wht_native_byte_order() ||
+      h.payload_offset % alignof(ET) != 0) {
+    wheels_throw(std::runtime_error(path + " can not be mapped in place"));
+  }
+  return map_file<ET>(
+      path, detail::_wht_make_shape<shape_t>(
+                h.shape, make_const_sequence(const_size<Rank>()), path),
+      mode, advice, huge_pages, size_t(h.payload_offset));
+}
+}
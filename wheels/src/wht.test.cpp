@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include "ewise.hpp"
+#include "iota.hpp"
+#include "matrix.hpp"
+#include "reshape.hpp"
+#include "tensor.hpp"
+#include "wht.hpp"
+
+using namespace wheels;
+
+TEST(tensor, wht_save_load) {
+  const char *path = "wheels_wht.test.wht";
+  matx_<double> m(reshape(iota<double>(5 * 7), make_shape(5, 7)));
+  save(path, m);
+  matx_<double> m2;
+  load(path, m2);
+  ASSERT_TRUE(m2.shape() == m.shape());
+  ASSERT_TRUE(m2 == m);
+
+  // expressions are evaluated chunk by chunk
+  auto big = iota<int>(100000).ewised() * 3;
+  save(path, big);
+  vecx_<int> v;
+  load(path, v);
+  ASSERT_TRUE(v == big);
+
+  // static sizes and element types are checked
+  save(path, m);
+  tensor<double, tensor_shape<size_t, const_size<4>, size_t>> s;
+  ASSERT_THROW(load(path, s), std::runtime_error);
+  matx_<float> mf;
+  ASSERT_THROW(load(path, mf), std::runtime_error);
+
+  // chunked writer and reader
+  {
+    wht_writer<float> w(path, make_shape(3, 4));
+    for (int i = 0; i < 3; i++) {
+      const float row[4] = {i + 0.f, i + 1.f, i + 2.f, i + 3.f};
+      w.write(row, 4);
+    }
+    w.close();
+  }
+  {
+    wht_reader<float> r(path);
+    ASSERT_EQ(r.header().rank(), 2);
+    ASSERT_EQ(r.header().payload_offset % 64, 0);
+    float row[5];
+    ASSERT_EQ(r.read(row, 5), 5);
+    ASSERT_EQ(row[4], 1.f);
+    ASSERT_EQ(r.read(row, 5), 5);
+    ASSERT_EQ(r.read(row, 5), 2);
+    ASSERT_EQ(row[1], 5.f);
+  }
+
+  // zero-copy
+  save(path, m);
+  {
+    auto mapped = map_wht<const double, 2>(path);
+    ASSERT_TRUE(mapped.shape() == m.shape());
+    ASSERT_TRUE(mapped == m);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(mapped.ptr()) % 64, 0);
+  }
+
+  // foreign byte order
+  {
+    std::ifstream is(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(is)),
+                            std::istreambuf_iterator<char>());
+    is.close();
+    auto flip = [&bytes](size_t off, size_t width) {
+      std::reverse(bytes.begin() + off, bytes.begin() + off + width);
+    };
+    bytes[6] = bytes[6] == 1 ? 2 : 1;
+    flip(4, 2), flip(8, 2), flip(10, 2), flip(12, 4), flip(16, 8);
+    flip(24, 8), flip(32, 8), flip(40, 8);
+    for (size_t off = 64; off < bytes.size(); off += 8) {
+      flip(off, 8);
+    }
+    std::ofstream os(path, std::ios::binary);
+    os.write(bytes.data(), bytes.size());
+  }
+  matx_<double> m3;
+  load(path, m3);
+  ASSERT_TRUE(m3 == m);
+  ASSERT_THROW((map_wht<const double, 2>(path)), std::runtime_error);
+
+  std::remove(path);
+}
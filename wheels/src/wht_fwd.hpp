@@ -0,0 +1,55 @@
+/* * *
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Hao Yang (yangh2007@gmail.com)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * * */
+
+#pragma once
+
+#include <string>
+
+#include "mapped_file_fwd.hpp"
+#include "tensor_base_fwd.hpp"
+#include "tensor_fwd.hpp"
+
+namespace wheels {
+struct wht_header;
+
+template <class ET> class wht_writer;
+template <class ET> class wht_reader;
+
+// save
+template <class ET, class ShapeT, class T>
+void save(const std::string &path, const tensor_base<ET, ShapeT, T> &t);
+
+// load
+template <class ET, class ShapeT>
+void load(const std::string &path, tensor<ET, ShapeT> &t);
+
+// map_wht
+template <class ET, size_t Rank>
+auto map_wht(const std::string &path,
+             file_map_mode mode = std::is_const<ET>::value
+                                      ? file_map_mode::read_only
+                                      : file_map_mode::copy_on_write,
+             file_map_advice advice = file_map_advice::normal,
+             bool huge_pages = false);
+}
@@ -118,11 +118,11 @@ auto inverse(const tensor_base<ET, tensor_shape<ST, MT, NT>, T> &A,
   blas_int lda = n;
   auto Adata = A.t().eval();
 
-  std::vector<blas_int> ipiv(n);
+  vecx_<blas_int> ipiv(make_shape(n));
   blas_int info = 0;
 
   // lu factorization
-  lapack::getrf(&n, &n, Adata.ptr(), &lda, ipiv.data(), &info);
+  lapack::getrf(&n, &n, Adata.ptr(), &lda, ipiv.ptr(), &info);
   if (succeed) {
     *succeed = info == 0;
   }
@@ -132,7 +132,7 @@ auto inverse(const tensor_base<ET, tensor_shape<ST, MT, NT>, T> &A,
     vecx_<ET> work(make_shape(lwork));
 
     // inverse
-    lapack::getri(&n, Adata.ptr(), &lda, ipiv.data(), work.ptr(), &lwork,
+    lapack::getri(&n, Adata.ptr(), &lda, ipiv.ptr(), work.ptr(), &lwork,
                   &info);
     if (succeed) {
       *succeed = info == 0;
@@ -141,5 +141,31 @@ auto inverse(const tensor_base<ET, tensor_shape<ST, MT, NT>, T> &A,
 
   return std::move(Adata).t();
 }
+
+// small static square matrices (up to 4 x 4) are solved and inverted in
+// closed form, see matrix.hpp
+template <class ET, class ST, ST N, class T, class ST2, class MT2, class NT2,
+          class T2, class = std::enable_if_t<(N <= 4)>>
+auto solve(const tensor_base<ET, tensor_shape<ST, const_ints<ST, N>,
+                                              const_ints<ST, N>>, T> &A,
+           const tensor_base<ET, tensor_shape<ST2, MT2, NT2>, T2> &B,
+           bool *succeed = nullptr) {
+  return ::wheels::solve(A, B, succeed);
+}
+template <class ET, class ST, ST N, class T, class ST2, class MT2, class T2,
+          class = std::enable_if_t<(N <= 4)>>
+auto solve(const tensor_base<ET, tensor_shape<ST, const_ints<ST, N>,
+                                              const_ints<ST, N>>, T> &A,
+           const tensor_base<ET, tensor_shape<ST2, MT2>, T2> &B,
+           bool *succeed = nullptr) {
+  return ::wheels::solve(A, B, succeed);
+}
+template <class ET, class ST, ST N, class T,
+          class = std::enable_if_t<(N <= 4)>>
+auto inverse(const tensor_base<ET, tensor_shape<ST, const_ints<ST, N>,
+                                                const_ints<ST, N>>, T> &A,
+             bool *succeed = nullptr) {
+  return ::wheels::inverse(A, succeed);
+}
 }
 }
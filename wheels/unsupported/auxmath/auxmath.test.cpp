@@ -39,4 +39,19 @@ TEST(auxmath, inverse) {
     ASSERT_TRUE((A * X - eye(i)).norm() < 1e-3);
     ASSERT_TRUE(b);
   }
-}
\ No newline at end of file
+}
+
+TEST(auxmath, inverse_small_static) {
+  std::default_random_engine rng;
+  for (int i = 0; i < 100; i++) {
+    mat4 A = rand(make_shape(const_size<4>(), const_size<4>()), rng) +
+             eye(make_shape(const_size<4>(), const_size<4>())) * 4.0;
+    bool b = false;
+    mat4 X = auxmath::inverse(A, &b);
+    ASSERT_TRUE((A * X - eye(4)).norm() < 1e-9);
+    ASSERT_TRUE(b);
+    vec4 y = auxmath::solve(A, vec4(1, 2, 3, 4), &b);
+    ASSERT_TRUE((A * y - vec4(1, 2, 3, 4)).norm() < 1e-9);
+    ASSERT_TRUE(b);
+  }
+}
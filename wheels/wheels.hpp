@@ -2,12 +2,18 @@
 
 #include "./src/aligned.hpp"
 #include "./src/aligned_fwd.hpp"
+#include "./src/arena.hpp"
+#include "./src/arena_fwd.hpp"
 #include "./src/block.hpp"
 #include "./src/block_fwd.hpp"
+#include "./src/cache.hpp"
+#include "./src/cache_fwd.hpp"
 #include "./src/cartesian.hpp"
 #include "./src/cartesian_fwd.hpp"
 #include "./src/cat.hpp"
 #include "./src/cat_fwd.hpp"
+#include "./src/compact.hpp"
+#include "./src/compact_fwd.hpp"
 #include "./src/constants.hpp"
 #include "./src/constants_fwd.hpp"
 #include "./src/const_expr.hpp"
@@ -28,6 +34,8 @@
 #include "./src/iota_fwd.hpp"
 #include "./src/iterators.hpp"
 #include "./src/macros.hpp"
+#include "./src/mapped_file.hpp"
+#include "./src/mapped_file_fwd.hpp"
 #include "./src/map.hpp"
 #include "./src/map_fwd.hpp"
 #include "./src/matrix.hpp"
@@ -40,6 +48,8 @@
 #include "./src/parallel_fwd.hpp"
 #include "./src/permute.hpp"
 #include "./src/permute_fwd.hpp"
+#include "./src/reduce.hpp"
+#include "./src/reduce_fwd.hpp"
 #include "./src/reformulate.hpp"
 #include "./src/reformulate_fwd.hpp"
 #include "./src/remap.hpp"
@@ -62,4 +72,6 @@
 #include "./src/utility.hpp"
 #include "./src/utility_fwd.hpp"
 #include "./src/vector.hpp"
-#include "./src/vector_fwd.hpp"
\ No newline at end of file
+#include "./src/vector_fwd.hpp"
+#include "./src/wht.hpp"
+#include "./src/wht_fwd.hpp"
\ No newline at end of file